@@ -26,6 +26,7 @@ dist_man1_MANS += \
     man/fixpremiumgff.1 \
     man/desmall.1 \
     man/gff2xml.1 \
+    man/gffquery.1 \
     man/nbfs2tga.1 \
     man/ncgr2tga.1 \
     man/tlk2xml.1 \
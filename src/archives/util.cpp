@@ -34,11 +34,13 @@
 #include "src/common/filepath.h"
 #include "src/common/readstream.h"
 #include "src/common/writefile.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/util.h"
 #include "src/aurora/archive.h"
 #include "src/aurora/keyfile.h"
 #include "src/aurora/nsbtxfile.h"
+#include "src/aurora/indexcache.h"
 
 #include "src/archives/util.h"
 #include "src/archives/files_dragonage.h"
@@ -46,6 +48,29 @@
 
 namespace Archives {
 
+Aurora::Archive *openArchive(const Common::UString &file, Aurora::FileType type,
+                             const Common::UString &indexCacheFile, const std::vector<byte> &password) {
+
+	if (indexCacheFile.empty())
+		return Aurora::IndexCache::openArchiveFile(file, type, password);
+
+	Aurora::IndexCache indexCache;
+	indexCache.load(indexCacheFile);
+
+	Common::ScopedPtr<Aurora::Archive> archive(indexCache.openArchive(file, type, password));
+
+	if (indexCache.isModified()) {
+		try {
+			indexCache.save(indexCacheFile);
+		} catch (...) {
+			Common::exceptionDispatcherWarnAndIgnore(Common::UString::format("Failed writing index cache \"%s\"",
+			                                                                 indexCacheFile.c_str()));
+		}
+	}
+
+	return archive.release();
+}
+
 static Common::UString findPath(const Common::UString &name, Aurora::FileType type,
                                 uint64 hash, Common::HashAlgo algo) {
 
@@ -193,14 +218,28 @@ static void dumpStream(Common::SeekableReadStream &stream, const Common::UString
 	file.close();
 }
 
+struct ExtractEntry {
+	uint32 index;  ///< The index of the resource within the archive.
+	size_t number; ///< The number of the resource, for display.
+
+	Common::UString name;
+	Common::UString dirName;
+
+	ExtractEntry(uint32 i, size_t n, const Common::UString &na, const Common::UString &d) :
+		index(i), number(n), name(na), dirName(d) { }
+};
+
 void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool directories,
-                  const std::set<Common::UString> &files) {
+                  const std::set<Common::UString> &files, size_t threadCount) {
 
 	const Aurora::Archive::ResourceList &resources = archive.getResources();
 	const size_t fileCount = resources.size();
 
 	std::printf("Number of files: %s\n\n", Common::composeString(fileCount).c_str());
 
+	std::vector<ExtractEntry> entries;
+	entries.reserve(fileCount);
+
 	size_t i = 1;
 	for (Aurora::Archive::ResourceList::const_iterator r = resources.begin(); r != resources.end(); ++r, ++i) {
 		const Aurora::FileType type = TypeMan.aliasFileType(r->type, game);
@@ -213,24 +252,56 @@ void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool dire
 		if (!files.empty() && (files.find(name) == files.end()))
 			continue;
 
-		if (directories && !dirName.empty())
-			Common::FilePath::createDirectories(dirName);
+		entries.push_back(ExtractEntry(r->index, i, name, directories ? dirName : ""));
+	}
+
+	/* The workers read, decrypt and decompress the resources. Writing them and
+	 * printing the progress happens here, in order.
+	 *
+	 * Archives that can't be read concurrently are read on this thread only.
+	 * The others return substreams that don't share the archive stream's
+	 * position, so those are safe to ask for on any thread.
+	 *
+	 * With only one thread, large compressed resources are inflated while
+	 * they're being written, to keep the memory use low. With several, they're
+	 * fully inflated by the workers, so that the inflating does happen there. */
+	if (!archive.canReadConcurrently())
+		threadCount = 1;
 
-		std::printf("Extracting %s/%s: %s ... ", Common::composeString(i).c_str(),
+	const bool streamed = Common::getThreadCount(threadCount) == 1;
+
+	std::function<Common::SeekableReadStream *(size_t)> produce = [&](size_t n) {
+		if (streamed)
+			return archive.getResourceStreamed(entries[n].index);
+
+		return archive.getResource(entries[n].index, true);
+	};
+
+	std::function<void(size_t, Common::ParallelResult<Common::SeekableReadStream> &)> consume =
+		[&](size_t n, Common::ParallelResult<Common::SeekableReadStream> &result) {
+
+		const ExtractEntry &entry = entries[n];
+
+		if (!entry.dirName.empty())
+			Common::FilePath::createDirectories(entry.dirName);
+
+		std::printf("Extracting %s/%s: %s ... ", Common::composeString(entry.number).c_str(),
 		                                         Common::composeString(fileCount).c_str(),
-		                                         name.c_str());
+		                                         entry.name.c_str());
 		std::fflush(stdout);
 
 		try {
-			Common::ScopedPtr<Common::SeekableReadStream> stream(archive.getResource(r->index));
+			Common::ScopedPtr<Common::SeekableReadStream> stream(result.release());
 
-			dumpStream(*stream, name);
+			dumpStream(*stream, entry.name);
 
 			std::printf("Done\n");
 		} catch (Common::Exception &e) {
 			Common::printException(e, "");
 		}
-	}
+	};
+
+	Common::parallelOrdered(threadCount, entries.size(), produce, consume);
 }
 
 void extractFiles(const Aurora::NSBTXFile &nsbtx, const std::set<Common::UString> &files,
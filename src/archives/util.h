@@ -26,7 +26,9 @@
 #define ARCHIVES_UTIL_H
 
 #include <set>
+#include <vector>
 
+#include "src/common/types.h"
 #include "src/common/ustring.h"
 
 #include "src/aurora/types.h"
@@ -40,6 +42,22 @@ namespace Aurora {
 
 namespace Archives {
 
+/** Open an archive, optionally through an index cache file.
+ *
+ *  Without an index cache file, the archive is simply opened and parsed.
+ *  Otherwise, if the cache file holds the current index of the archive,
+ *  the archive is read through that instead of parsing it again (see
+ *  Aurora::IndexCache::openArchive()). The cache file is updated as needed.
+ *
+ *  @param file The archive file to open.
+ *  @param type The type of the archive.
+ *  @param indexCacheFile The index cache file to use, or an empty string.
+ *  @param password The password to decrypt an ERF with.
+ */
+Aurora::Archive *openArchive(const Common::UString &file, Aurora::FileType type,
+                             const Common::UString &indexCacheFile,
+                             const std::vector<byte> &password = std::vector<byte>());
+
 /** List all files found in this archive on stdout.
  *
  *  @param archive The archive to list the contents of.
@@ -61,9 +79,14 @@ void listFiles(const Aurora::NSBTXFile &nsbtx);
  *         will be written directly into the current directory.
  *  @param files A list of files to extract. If empty, all files from the archive will be
  *         extracted.
+ *  @param threadCount The number of threads to read, decrypt and decompress resources with.
+ *         The files are still written, and the progress printed, in order. Archives that
+ *         can't be read concurrently (see Aurora::Archive::canReadConcurrently()) are
+ *         always read on a single thread. On a single thread, large compressed resources
+ *         are inflated while they're written, instead of all at once into memory.
  */
 void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool directories,
-                  const std::set<Common::UString> &files);
+                  const std::set<Common::UString> &files, size_t threadCount = 1);
 
 /** Extract files from an NSBTX. */
 void extractFiles(const Aurora::NSBTXFile &nsbtx, const std::set<Common::UString> &files,
@@ -22,15 +22,61 @@
  *  Handling various archive files.
  */
 
+#include <utility>
+
+#include <boost/unordered/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+
 #include "src/common/system.h"
+#include "src/common/error.h"
+#include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
+#include "src/common/deflate.h"
+#include "src/common/lzma.h"
 
 #include "src/aurora/archive.h"
 
 namespace Aurora {
 
+struct Archive::ResourceIndex {
+	typedef std::pair<Common::UString, FileType> NameType;
+
+	struct hashNameType {
+		size_t operator()(const NameType &nameType) const {
+			size_t seed = Common::hashUStringCaseSensitive()(nameType.first);
+			boost::hash_combine<int>(seed, nameType.second);
+
+			return seed;
+		}
+	};
+
+	typedef boost::unordered_map<uint64, uint32> HashMap;
+	typedef boost::unordered_map<NameType, uint32, hashNameType> NameMap;
+
+	HashMap hashes;
+	NameMap names;
+
+	ResourceIndex(const ResourceList &resources);
+};
+
+Archive::ResourceIndex::ResourceIndex(const ResourceList &resources) {
+	hashes.reserve(resources.size());
+	names.reserve(resources.size());
+
+	// insert() doesn't overwrite, so the first of several equal resources wins
+	for (ResourceList::const_iterator r = resources.begin(); r != resources.end(); ++r) {
+		hashes.insert(std::make_pair(r->hash, r->index));
+		names.insert(std::make_pair(NameType(r->name, r->type), r->index));
+	}
+}
+
 Archive::Resource::Resource() : hash(0), type(kFileTypeNone), index(0xFFFFFFFF) {
 }
 
+
+Archive::Location::Location() : offset(0), packedSize(0), size(0), packing(kPackingNone) {
+}
+
 Archive::Archive() {
 }
 
@@ -41,27 +87,116 @@ uint32 Archive::getResourceSize(uint32 UNUSED(index)) const {
 	return 0xFFFFFFFF;
 }
 
+Common::SeekableReadStream *Archive::getResourceStreamed(uint32 index) const {
+	return getResource(index, true);
+}
+
+bool Archive::getResourceLocation(uint32 UNUSED(index), Location &UNUSED(location)) const {
+	return false;
+}
+
+Common::SeekableReadStream *Archive::readResource(Common::SeekableReadStream &archive,
+                                                  const Location &location, bool tryNoCopy) {
+
+	if (location.offset > archive.size())
+		throw Common::Exception(Common::kReadError);
+
+	const size_t offset = location.offset;
+
+	if (location.packing == kPackingNone) {
+		if (tryNoCopy)
+			return archive.getSubStream(offset, offset + location.packedSize);
+
+		return archive.readStreamAt(offset, location.packedSize);
+	}
+
+	// If the archive is in memory, we can unpack straight out of it
+	Common::ScopedPtr<Common::SeekableReadStream> packedStream;
+	if (archive.getData())
+		packedStream.reset(archive.getSubStream(offset, offset + location.packedSize));
+	else
+		packedStream.reset(archive.readStreamAt(offset, location.packedSize));
+
+	const byte  *packed     = packedStream->getData();
+	const size_t packedSize = location.packedSize;
+
+	const byte *data = 0;
+
+	switch (location.packing) {
+		case kPackingZlib:
+			data = Common::decompressDeflate(packed, packedSize, location.size, Common::kWindowBitsMax);
+			break;
+
+		case kPackingZlibHeaderless:
+			data = Common::decompressDeflate(packed, packedSize, location.size, -Common::kWindowBitsMax);
+			break;
+
+		case kPackingZlibBioWare:
+			if (packedSize == 0)
+				throw Common::Exception(Common::kReadError);
+
+			data = Common::decompressDeflate(packed + 1, packedSize - 1, location.size, -(packed[0] >> 4));
+			break;
+
+		case kPackingLZMA1:
+			data = Common::decompressLZMA1(packed, packedSize, location.size, true);
+			break;
+
+		default:
+			throw Common::Exception("Invalid resource packing %u", (uint) location.packing);
+	}
+
+	return new Common::MemoryReadStream(data, location.size, true);
+}
+
+bool Archive::canReadConcurrently() const {
+	return false;
+}
+
 Common::HashAlgo Archive::getNameHashAlgo() const {
 	return Common::kHashNone;
 }
 
+const Archive::ResourceIndex &Archive::getResourceIndex() const {
+	const ResourceList &resources = getResources();
+
+	if (!_resourceIndex)
+		_resourceIndex.reset(new ResourceIndex(resources));
+
+	return *_resourceIndex;
+}
+
+void Archive::invalidateResourceIndex() {
+	std::lock_guard<std::mutex> lock(_resourceIndexMutex);
+
+	_resourceIndex.reset();
+}
+
 uint32 Archive::findResource(uint64 hash) const {
 	if (getNameHashAlgo() == Common::kHashNone)
 		return 0xFFFFFFFF;
 
-	for (ResourceList::const_iterator r = getResources().begin(); r != getResources().end(); ++r)
-		if (r->hash == hash)
-			return r->index;
+	std::lock_guard<std::mutex> lock(_resourceIndexMutex);
 
-	return 0xFFFFFFFF;
+	const ResourceIndex &index = getResourceIndex();
+
+	ResourceIndex::HashMap::const_iterator r = index.hashes.find(hash);
+	if (r == index.hashes.end())
+		return 0xFFFFFFFF;
+
+	return r->second;
 }
 
 uint32 Archive::findResource(const Common::UString &name, FileType type) const {
-	for (ResourceList::const_iterator r = getResources().begin(); r != getResources().end(); ++r)
-		if ((r->type == type) && (r->name == name))
-			return r->index;
+	std::lock_guard<std::mutex> lock(_resourceIndexMutex);
 
-	return 0xFFFFFFFF;
+	const ResourceIndex &index = getResourceIndex();
+
+	ResourceIndex::NameMap::const_iterator r = index.names.find(ResourceIndex::NameType(name, type));
+	if (r == index.names.end())
+		return 0xFFFFFFFF;
+
+	return r->second;
 }
 
 } // End of namespace Aurora
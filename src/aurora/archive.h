@@ -25,13 +25,15 @@
 #ifndef AURORA_ARCHIVE_H
 #define AURORA_ARCHIVE_H
 
-#include <list>
+#include <vector>
+#include <mutex>
 
 #include <boost/noncopyable.hpp>
 
 #include "src/common/types.h"
 #include "src/common/ustring.h"
 #include "src/common/hash.h"
+#include "src/common/scopedptr.h"
 
 #include "src/aurora/types.h"
 
@@ -54,7 +56,28 @@ public:
 		Resource();
 	};
 
-	typedef std::list<Resource> ResourceList;
+	typedef std::vector<Resource> ResourceList;
+
+	/** How a resource is stored within the archive file. */
+	enum Packing {
+		kPackingNone           = 0, ///< Stored as is.
+		kPackingZlib           = 1, ///< DEFLATE, with a standard zlib header.
+		kPackingZlibHeaderless = 2, ///< Raw DEFLATE.
+		kPackingZlibBioWare    = 3, ///< Raw DEFLATE, with an extra byte specifying the window size.
+		kPackingLZMA1          = 4, ///< LZMA1, without an end marker.
+
+		kPackingMAX
+	};
+
+	/** Where and how a resource is stored within the archive file. */
+	struct Location {
+		uint64  offset;     ///< The offset of the packed data within the archive file.
+		uint32  packedSize; ///< The size of the packed data.
+		uint32  size;       ///< The size of the resource's contents.
+		Packing packing;    ///< How the resource's contents are packed.
+
+		Location();
+	};
 
 	Archive();
 	virtual ~Archive();
@@ -66,13 +89,72 @@ public:
 	virtual uint32 getResourceSize(uint32 index) const;
 
 	/** Return a stream of the resource's contents.
+	 *
+	 *  When tryNoCopy is set and the resource is stored plainly within the archive,
+	 *  a substream of the archive is returned instead of a copy. If the archive
+	 *  itself is backed by memory (like a MemoryReadStream or a MappedReadFile),
+	 *  this substream directly aliases that memory. In either case, the returned
+	 *  stream must not outlive the archive.
+	 *
+	 *  Without tryNoCopy, and for compressed or encrypted resources in any case,
+	 *  the returned stream is an independent copy of the resource's contents,
+	 *  that is fully read (and decompressed) by the time this returns.
+	 *
+	 *  See canReadConcurrently() for whether this can be called from several
+	 *  threads at once.
 	 *
 	 *  @param  index The index of the resource we want.
-	 *  @param  tryNoCopy Try to return a SeekableSubReadStream of the archive instead of copying.
+	 *  @param  tryNoCopy Try to return a substream of the archive instead of copying.
 	 *  @return A (sub)stream of the resource's contents.
 	 */
 	virtual Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy = false) const = 0;
 
+	/** Return a stream of the resource's contents that is read on demand.
+	 *
+	 *  Like getResource() with tryNoCopy, but large compressed resources are
+	 *  additionally decompressed while the returned stream is read, instead of
+	 *  all at once into memory. This keeps the memory use of huge resources
+	 *  low, but the work of decompressing then happens in whichever thread
+	 *  reads the stream.
+	 *
+	 *  The returned stream references the archive, so it must not outlive it.
+	 *  Reading it reads from the archive's stream as well, so see
+	 *  canReadConcurrently() for whether several of them can be read at once.
+	 *
+	 *  The default implementation returns getResource(index, true).
+	 */
+	virtual Common::SeekableReadStream *getResourceStreamed(uint32 index) const;
+
+	/** Find out where and how a resource is stored within the archive file.
+	 *
+	 *  With this, the resource can be read straight out of the archive file
+	 *  with readResource(), without opening the archive again. This is not
+	 *  possible for all archives and resources, like encrypted ones.
+	 *
+	 *  @return true if the location of the resource is known, false otherwise.
+	 */
+	virtual bool getResourceLocation(uint32 index, Location &location) const;
+
+	/** Read a resource out of an archive file, by its location.
+	 *
+	 *  tryNoCopy works like it does for getResource().
+	 *
+	 *  This only uses positional reads (see Common::SeekableReadStream::readAt()),
+	 *  so it leaves the position of the archive stream alone.
+	 */
+	static Common::SeekableReadStream *readResource(Common::SeekableReadStream &archive,
+	                                                const Location &location, bool tryNoCopy = false);
+
+	/** Can getResource() be called from several threads at once?
+	 *
+	 *  Archives that read their resources with positional reads (see
+	 *  Common::SeekableReadStream::readAt()) don't modify the position of
+	 *  their stream in getResource(). If the archive stream also supports
+	 *  concurrent positional reads, resources can be read from several
+	 *  threads at once, and so can the streams returned with tryNoCopy.
+	 */
+	virtual bool canReadConcurrently() const;
+
 	/** Return with which algorithm the name is hashed. */
 	virtual Common::HashAlgo getNameHashAlgo() const;
 
@@ -80,6 +162,24 @@ public:
 	uint32 findResource(uint64 hash) const;
 	/** Return the index of the resource matching the name and type, or 0xFFFFFFFF if not found. */
 	uint32 findResource(const Common::UString &name, FileType type) const;
+
+protected:
+	/** Drop the hash maps over the resource list.
+	 *
+	 *  Needs to be called whenever the resource list is changed, for example
+	 *  after a BIF got merged with its KEY. The maps are then rebuilt by the
+	 *  next findResource() call.
+	 */
+	void invalidateResourceIndex();
+
+private:
+	struct ResourceIndex;
+
+	/** Hash maps over the resource list, built on the first findResource() call. */
+	mutable Common::ScopedPtr<ResourceIndex> _resourceIndex;
+	mutable std::mutex _resourceIndexMutex;
+
+	const ResourceIndex &getResourceIndex() const;
 };
 
 } // End of namespace Aurora
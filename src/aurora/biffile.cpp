@@ -98,10 +98,12 @@ void BIFFile::readVarResTable(Common::SeekableReadStream &bif, uint32 offset) {
 
 void BIFFile::mergeKEY(const KEYFile &key, uint32 dataFileIndex) {
 	const KEYFile::ResourceList &keyResList = key.getResources();
+	const KEYFile::ResourceIndexList &keyBIFResList = key.getBIFResources(dataFileIndex);
 
-	for (KEYFile::ResourceList::const_iterator keyRes = keyResList.begin(); keyRes != keyResList.end(); ++keyRes) {
-		if (keyRes->bifIndex != dataFileIndex)
-			continue;
+	_resources.reserve(_resources.size() + keyBIFResList.size());
+
+	for (KEYFile::ResourceIndexList::const_iterator i = keyBIFResList.begin(); i != keyBIFResList.end(); ++i) {
+		const KEYFile::Resource *keyRes = &keyResList[*i];
 
 		if (keyRes->resIndex >= _iResources.size()) {
 			warning("Resource index out of range (%d/%d)", keyRes->resIndex, (int) _iResources.size());
@@ -121,6 +123,7 @@ void BIFFile::mergeKEY(const KEYFile &key, uint32 dataFileIndex) {
 		_resources.push_back(res);
 	}
 
+	invalidateResourceIndex();
 }
 
 uint32 BIFFile::getInternalResourceCount() const {
@@ -146,11 +149,24 @@ Common::SeekableReadStream *BIFFile::getResource(uint32 index, bool tryNoCopy) c
 	const IResource &res = getIResource(index);
 
 	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_bif.get(), res.offset, res.offset + res.size);
+		return _bif->getSubStream(res.offset, res.offset + res.size);
+
+	return _bif->readStreamAt(res.offset, res.size);
+}
 
-	_bif->seek(res.offset);
+bool BIFFile::getResourceLocation(uint32 index, Location &location) const {
+	const IResource &res = getIResource(index);
+
+	location.offset     = res.offset;
+	location.packedSize = res.size;
+	location.size       = res.size;
+	location.packing    = kPackingNone;
+
+	return true;
+}
 
-	return _bif->readStream(res.size);
+bool BIFFile::canReadConcurrently() const {
+	return _bif->canReadAtConcurrently();
 }
 
 } // End of namespace Aurora
@@ -100,10 +100,12 @@ void BZFFile::readVarResTable(Common::SeekableReadStream &bzf, uint32 offset) {
 
 void BZFFile::mergeKEY(const KEYFile &key, uint32 dataFileIndex) {
 	const KEYFile::ResourceList &keyResList = key.getResources();
+	const KEYFile::ResourceIndexList &keyBIFResList = key.getBIFResources(dataFileIndex);
 
-	for (KEYFile::ResourceList::const_iterator keyRes = keyResList.begin(); keyRes != keyResList.end(); ++keyRes) {
-		if (keyRes->bifIndex != dataFileIndex)
-			continue;
+	_resources.reserve(_resources.size() + keyBIFResList.size());
+
+	for (KEYFile::ResourceIndexList::const_iterator i = keyBIFResList.begin(); i != keyBIFResList.end(); ++i) {
+		const KEYFile::Resource *keyRes = &keyResList[*i];
 
 		if (keyRes->resIndex >= _iResources.size()) {
 			warning("Resource index out of range (%d/%d)", keyRes->resIndex, (int) _iResources.size());
@@ -123,6 +125,7 @@ void BZFFile::mergeKEY(const KEYFile &key, uint32 dataFileIndex) {
 		_resources.push_back(res);
 	}
 
+	invalidateResourceIndex();
 }
 
 uint32 BZFFile::getInternalResourceCount() const {
@@ -147,9 +150,24 @@ uint32 BZFFile::getResourceSize(uint32 index) const {
 Common::SeekableReadStream *BZFFile::getResource(uint32 index, bool UNUSED(tryNoCopy)) const {
 	const IResource &res = getIResource(index);
 
-	_bzf->seek(res.offset);
+	Common::ScopedPtr<Common::MemoryReadStream> packed(_bzf->readStreamAt(res.offset, res.packedSize));
+
+	return Common::decompressLZMA1(*packed, res.packedSize, res.size, true);
+}
+
+bool BZFFile::getResourceLocation(uint32 index, Location &location) const {
+	const IResource &res = getIResource(index);
+
+	location.offset     = res.offset;
+	location.packedSize = res.packedSize;
+	location.size       = res.size;
+	location.packing    = kPackingLZMA1;
+
+	return true;
+}
 
-	return Common::decompressLZMA1(*_bzf, res.packedSize, res.size, true);
+bool BZFFile::canReadConcurrently() const {
+	return _bzf->canReadAtConcurrently();
 }
 
 } // End of namespace Aurora
@@ -70,6 +70,12 @@ public:
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy = false) const;
 
+	/** Find out where and how a resource is stored within the BZF. */
+	bool getResourceLocation(uint32 index, Location &location) const;
+
+	/** Can getResource() be called from several threads at once? */
+	bool canReadConcurrently() const;
+
 	/** Merge information from the KEY into the data file.
 	 *
 	 *  Without this step, this data file archive does not contain any
@@ -0,0 +1,98 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  An archive read through the resource locations of an index cache.
+ */
+
+#include "src/common/error.h"
+#include "src/common/readstream.h"
+#include "src/common/mappedreadfile.h"
+
+#include "src/aurora/cachedarchive.h"
+
+namespace Aurora {
+
+CachedArchive::CachedArchive(const Common::UString &file, const ResourceList &resources,
+                             const std::vector<Location> &locations, Common::HashAlgo hashAlgo) :
+	_file(file), _resources(resources), _locations(locations), _hashAlgo(hashAlgo) {
+
+}
+
+CachedArchive::~CachedArchive() {
+}
+
+const Archive::ResourceList &CachedArchive::getResources() const {
+	return _resources;
+}
+
+const Archive::Location &CachedArchive::getLocation(uint32 index) const {
+	if (index >= _locations.size())
+		throw Common::Exception("Resource index out of range (%u/%u)", index, (uint)_locations.size());
+
+	return _locations[index];
+}
+
+uint32 CachedArchive::getResourceSize(uint32 index) const {
+	return getLocation(index).size;
+}
+
+Common::SeekableReadStream *CachedArchive::getResource(uint32 index, bool tryNoCopy) const {
+	const Location &location = getLocation(index);
+
+	Common::SeekableReadStream &archive = getArchive();
+
+	try {
+		if (archive.canReadAtConcurrently())
+			return readResource(archive, location, tryNoCopy);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		return readResource(archive, location, tryNoCopy);
+
+	} catch (Common::Exception &e) {
+		e.add("Failed reading resource %u from \"%s\"", index, _file.c_str());
+		throw;
+	}
+}
+
+bool CachedArchive::getResourceLocation(uint32 index, Location &location) const {
+	location = getLocation(index);
+
+	return true;
+}
+
+bool CachedArchive::canReadConcurrently() const {
+	return getArchive().canReadAtConcurrently();
+}
+
+Common::HashAlgo CachedArchive::getNameHashAlgo() const {
+	return _hashAlgo;
+}
+
+Common::SeekableReadStream &CachedArchive::getArchive() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if (!_archive)
+		_archive.reset(Common::mapOrReadFile(_file));
+
+	return *_archive;
+}
+
+} // End of namespace Aurora
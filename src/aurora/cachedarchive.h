@@ -0,0 +1,101 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  An archive read through the resource locations of an index cache.
+ */
+
+#ifndef AURORA_CACHEDARCHIVE_H
+#define AURORA_CACHEDARCHIVE_H
+
+#include <vector>
+#include <mutex>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/scopedptr.h"
+
+#include "src/aurora/archive.h"
+
+namespace Common {
+	class SeekableReadStream;
+}
+
+namespace Aurora {
+
+/** An archive read through the resource locations of an index cache.
+ *
+ *  The resource list and the locations of the resources within the archive
+ *  file are given from the outside, usually from an IndexCache. The archive
+ *  file itself is not parsed; it's only opened, memory-mapped if possible,
+ *  the first time a resource is read.
+ */
+class CachedArchive : public Archive {
+public:
+	/** Read an archive file, with these resources at these locations.
+	 *
+	 *  @param file The archive file.
+	 *  @param resources The resources within the archive.
+	 *  @param locations The locations of the resources, by their index.
+	 *  @param hashAlgo The algorithm the resource names are hashed with.
+	 */
+	CachedArchive(const Common::UString &file, const ResourceList &resources,
+	              const std::vector<Location> &locations, Common::HashAlgo hashAlgo = Common::kHashNone);
+	~CachedArchive();
+
+	/** Return the list of resources. */
+	const ResourceList &getResources() const;
+
+	/** Return the size of a resource. */
+	uint32 getResourceSize(uint32 index) const;
+
+	/** Return a stream of the resource's contents. */
+	Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy = false) const;
+
+	/** Find out where and how a resource is stored within the archive file. */
+	bool getResourceLocation(uint32 index, Location &location) const;
+
+	/** Can getResource() be called from several threads at once? */
+	bool canReadConcurrently() const;
+
+	/** Return with which algorithm the name is hashed. */
+	Common::HashAlgo getNameHashAlgo() const;
+
+private:
+	Common::UString _file;
+
+	ResourceList _resources;
+	std::vector<Location> _locations;
+
+	Common::HashAlgo _hashAlgo;
+
+	/** The archive file, once it has been opened. */
+	mutable Common::ScopedPtr<Common::SeekableReadStream> _archive;
+	/** Guards the opening of the archive file, and reading from it if it can't be read concurrently. */
+	mutable std::mutex _mutex;
+
+	const Location &getLocation(uint32 index) const;
+
+	Common::SeekableReadStream &getArchive() const;
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_CACHEDARCHIVE_H
@@ -297,6 +297,7 @@ void ERFFile::load() {
 		throw;
 	}
 
+	invalidateResourceIndex();
 }
 
 void ERFFile::decryptNWNPremium() {
@@ -710,22 +711,93 @@ uint32 ERFFile::getResourceSize(uint32 index) const {
 }
 
 Common::SeekableReadStream *ERFFile::getResource(uint32 index, bool tryNoCopy) const {
+	return readResource(index, tryNoCopy, false);
+}
+
+Common::SeekableReadStream *ERFFile::getResourceStreamed(uint32 index) const {
+	return readResource(index, true, true);
+}
+
+Common::SeekableReadStream *ERFFile::readResource(uint32 index, bool tryNoCopy, bool streamed) const {
 	const IResource &res = getIResource(index);
 
-	if (tryNoCopy && (_header.encryption == kEncryptionNone) && (_header.compression == kCompressionNone))
-		return new Common::SeekableSubReadStream(_erf.get(), res.offset, res.offset + res.packedSize);
+	const bool compressed = _header.compression != kCompressionNone;
+
+	if (tryNoCopy && (_header.encryption == kEncryptionNone) && !compressed)
+		return _erf->getSubStream(res.offset, res.offset + res.packedSize);
+
+	/* When asked to, large compressed resources are inflated on demand, while
+	 * they're being read, instead of all at once into memory. */
+	const bool inflateStreamed = streamed && compressed && (res.unpackedSize >= Common::kInflateStreamThreshold);
 
-	_erf->seek(res.offset);
+	if (inflateStreamed && (_header.encryption == kEncryptionNone))
+		return decompressStreamed(_erf->getSubStream(res.offset, res.offset + res.packedSize), res.unpackedSize);
+
+	/* If the ERF is backed by memory (like a memory-mapped file), unencrypted
+	 * compressed data can be inflated straight out of it, without a copy. */
+	if ((_header.encryption == kEncryptionNone) && compressed && _erf->getData()) {
+		Common::ScopedPtr<Common::SeekableReadStream>
+			packedStream(_erf->getSubStream(res.offset, res.offset + res.packedSize));
+
+		return decompress(packedStream->getData(), res.packedSize, res.unpackedSize);
+	}
 
 	// Read
-	Common::MemoryReadStream *stream = _erf->readStream(res.packedSize);
+	Common::ScopedArray<byte> packedData(new byte[res.packedSize]);
+	if (_erf->readAt(res.offset, packedData.get(), res.packedSize) != res.packedSize)
+		throw Common::Exception(Common::kReadError);
 
-	// Decrypt
+	// Decrypt, in-place
 	if (_header.encryption != kEncryptionNone)
-		stream = decrypt(stream, _header.encryption, _password);
+		decrypt(packedData.get(), res.packedSize, _header.encryption, _password);
 
 	// Decompress
-	return decompress(stream, res.unpackedSize);
+	if (inflateStreamed)
+		return decompressStreamed(new Common::MemoryReadStream(packedData.release(), res.packedSize, true),
+		                          res.unpackedSize);
+
+	return decompress(new Common::MemoryReadStream(packedData.release(), res.packedSize, true), res.unpackedSize);
+}
+
+bool ERFFile::getResourceLocation(uint32 index, Location &location) const {
+	// Encrypted resources can only be read by us
+	if (_header.encryption != kEncryptionNone)
+		return false;
+
+	const IResource &res = getIResource(index);
+
+	location.offset     = res.offset;
+	location.packedSize = res.packedSize;
+	location.size       = res.unpackedSize;
+
+	switch (_header.compression) {
+		case kCompressionNone:
+			// We only ever return as much as the unpacked size says
+			location.packedSize = location.size = MIN(res.packedSize, res.unpackedSize);
+			location.packing    = kPackingNone;
+			break;
+
+		case kCompressionBioWareZlib:
+			location.packing = kPackingZlibBioWare;
+			break;
+
+		case kCompressionHeaderlessZlib:
+			location.packing = kPackingZlibHeaderless;
+			break;
+
+		case kCompressionStandardZlib:
+			location.packing = kPackingZlib;
+			break;
+
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+bool ERFFile::canReadConcurrently() const {
+	return _erf->canReadAtConcurrently();
 }
 
 Common::MemoryReadStream *ERFFile::decrypt(Common::SeekableReadStream &cryptStream,
@@ -763,26 +835,46 @@ Common::SeekableReadStream *ERFFile::decrypt(Common::SeekableReadStream &erf, si
 	return decrypt(erf, erf.pos(), size, encryption, password);
 }
 
+void ERFFile::decrypt(byte *data, size_t size, Encryption encryption, const std::vector<byte> &password) {
+	switch (encryption) {
+		case kEncryptionBlowfishDAO:
+		case kEncryptionBlowfishDA2:
+		case kEncryptionBlowfishNWN:
+			Common::decryptBlowfishEBC(data, size, password);
+			break;
+
+		default:
+			throw Common::Exception("Invalid ERF encryption %u", (uint) encryption);
+	}
+}
+
 Common::SeekableReadStream *ERFFile::decompress(Common::MemoryReadStream *packedStream,
                                                 uint32 unpackedSize) const {
 
 	Common::ScopedPtr<Common::MemoryReadStream> stream(packedStream);
 
-	switch (_header.compression) {
-		case kCompressionNone:
-			if (stream->size() == unpackedSize)
-				return stream.release();
+	if (_header.compression == kCompressionNone) {
+		if (stream->size() == unpackedSize)
+			return stream.release();
+
+		return new Common::SeekableSubReadStream(stream.release(), 0, unpackedSize, true);
+	}
+
+	return decompress(stream->getData(), stream->size(), unpackedSize);
+}
 
-			return new Common::SeekableSubReadStream(stream.release(), 0, unpackedSize, true);
+Common::SeekableReadStream *ERFFile::decompress(const byte *packedData, uint32 packedSize,
+                                                uint32 unpackedSize) const {
 
+	switch (_header.compression) {
 		case kCompressionBioWareZlib:
-			return decompressBiowareZlib(stream.release(), unpackedSize);
+			return decompressBiowareZlib(packedData, packedSize, unpackedSize);
 
 		case kCompressionHeaderlessZlib:
-			return decompressHeaderlessZlib(stream.release(), unpackedSize);
+			return decompressHeaderlessZlib(packedData, packedSize, unpackedSize);
 
 		case kCompressionStandardZlib:
-			return decompressStandardZlib(stream.release(), unpackedSize);
+			return decompressStandardZlib(packedData, packedSize, unpackedSize);
 
 		default:
 			break;
@@ -791,49 +883,66 @@ Common::SeekableReadStream *ERFFile::decompress(Common::MemoryReadStream *packed
 	throw Common::Exception("Invalid ERF compression %u", (uint) _header.compression);
 }
 
-Common::SeekableReadStream *ERFFile::decompressBiowareZlib(Common::MemoryReadStream *packedStream,
-                                                           uint32 unpackedSize) const {
+Common::SeekableReadStream *ERFFile::decompressStreamed(Common::SeekableReadStream *packedStream,
+                                                        uint32 unpackedSize) const {
 
-	/* Decompress using raw inflate. An extra one byte header specifies the window size. */
+	Common::ScopedPtr<Common::SeekableReadStream> stream(packedStream);
 
-	assert(packedStream);
+	int windowBits = 0;
 
-	Common::ScopedPtr<Common::MemoryReadStream> stream(packedStream);
+	switch (_header.compression) {
+		case kCompressionBioWareZlib: {
+				// Raw inflate, with an extra one byte header specifying the window size
+				const size_t size = stream->size();
+				if (size == 0)
+					throw Common::Exception(Common::kReadError);
 
-	const byte * const compressedData = stream->getData();
-	const uint32 packedSize = stream->size();
+				windowBits = -(stream->readByte() >> 4);
 
-	return decompressZlib(compressedData + 1, packedSize - 1, unpackedSize, *compressedData >> 4);
-}
+				stream.reset(new Common::SeekableSubReadStream(stream.release(), 1, size, true));
+			}
+			break;
 
-Common::SeekableReadStream *ERFFile::decompressHeaderlessZlib(Common::MemoryReadStream *packedStream,
-                                                              uint32 unpackedSize) const {
+		case kCompressionHeaderlessZlib:
+			windowBits = -Common::kWindowBitsMax;
+			break;
 
-	/* Decompress using raw inflate. Use the default maximum window size (15). */
+		case kCompressionStandardZlib:
+			windowBits = Common::kWindowBitsMax;
+			break;
 
-	assert(packedStream);
+		default:
+			throw Common::Exception("Invalid ERF compression %u", (uint) _header.compression);
+	}
 
-	Common::ScopedPtr<Common::MemoryReadStream> stream(packedStream);
+	return new Common::InflateReadStream(stream.release(), true, unpackedSize, windowBits);
+}
 
-	const byte * const compressedData = stream->getData();
-	const uint32 packedSize = stream->size();
+Common::SeekableReadStream *ERFFile::decompressBiowareZlib(const byte *packedData, uint32 packedSize,
+                                                           uint32 unpackedSize) const {
+
+	/* Decompress using raw inflate. An extra one byte header specifies the window size. */
 
-	return decompressZlib(compressedData, packedSize, unpackedSize, Common::kWindowBitsMax);
+	if (packedSize == 0)
+		throw Common::Exception(Common::kReadError);
+
+	return decompressZlib(packedData + 1, packedSize - 1, unpackedSize, *packedData >> 4);
 }
 
-Common::SeekableReadStream *ERFFile::decompressStandardZlib(Common::MemoryReadStream *packedStream,
-                                                            uint32 unpackedSize) const {
+Common::SeekableReadStream *ERFFile::decompressHeaderlessZlib(const byte *packedData, uint32 packedSize,
+                                                              uint32 unpackedSize) const {
 
-	/* Decompress using raw inflate. Use the default maximum window size (15), and with zlib header. */
+	/* Decompress using raw inflate. Use the default maximum window size (15). */
 
-	assert(packedStream);
+	return decompressZlib(packedData, packedSize, unpackedSize, Common::kWindowBitsMax);
+}
 
-	Common::ScopedPtr<Common::MemoryReadStream> stream(packedStream);
+Common::SeekableReadStream *ERFFile::decompressStandardZlib(const byte *packedData, uint32 packedSize,
+                                                            uint32 unpackedSize) const {
 
-	const byte * const compressedData = stream->getData();
-	const uint32 packedSize = stream->size();
+	/* Decompress using raw inflate. Use the default maximum window size (15), and with zlib header. */
 
-	return decompressZlib(compressedData, packedSize, unpackedSize, -Common::kWindowBitsMax);
+	return decompressZlib(packedData, packedSize, unpackedSize, -Common::kWindowBitsMax);
 }
 
 Common::SeekableReadStream *ERFFile::decompressZlib(const byte *compressedData, uint32 packedSize,
@@ -129,6 +129,15 @@ public:
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy = false) const;
 
+	/** Return a stream of the resource's contents, inflating large resources on demand. */
+	Common::SeekableReadStream *getResourceStreamed(uint32 index) const;
+
+	/** Find out where and how a resource is stored within the ERF. */
+	bool getResourceLocation(uint32 index, Location &location) const;
+
+	/** Can getResource() be called from several threads at once? */
+	bool canReadConcurrently() const;
+
 	/** Return the year the ERF was built. */
 	uint32 getBuildYear() const;
 	/** Return the day of year the ERF was built. */
@@ -279,6 +288,8 @@ private:
 	static Common::SeekableReadStream *decrypt(Common::SeekableReadStream &erf, size_t size,
 	                                           Encryption encryption, const std::vector<byte> &password);
 
+	static void decrypt(byte *data, size_t size, Encryption encryption, const std::vector<byte> &password);
+
 	static bool decryptNWNPremiumHeader(Common::SeekableReadStream &erf, ERFHeader &header,
 	                                    const std::vector<byte> &password);
 	static bool findNWNPremiumKey      (Common::SeekableReadStream &erf, ERFHeader &header,
@@ -289,15 +300,24 @@ private:
 	void decryptNWNPremium();
 	// '---
 
+	Common::SeekableReadStream *readResource(uint32 index, bool tryNoCopy, bool streamed) const;
+
 	// .--- Compression
 	Common::SeekableReadStream *decompress(Common::MemoryReadStream *packedStream,
 	                                       uint32 unpackedSize) const;
 
-	Common::SeekableReadStream *decompressBiowareZlib   (Common::MemoryReadStream *packedStream,
+	Common::SeekableReadStream *decompress(const byte *packedData, uint32 packedSize,
+	                                       uint32 unpackedSize) const;
+
+	/** Inflate the packed data incrementally, while the returned stream is being read. */
+	Common::SeekableReadStream *decompressStreamed(Common::SeekableReadStream *packedStream,
+	                                               uint32 unpackedSize) const;
+
+	Common::SeekableReadStream *decompressBiowareZlib   (const byte *packedData, uint32 packedSize,
 	                                                     uint32 unpackedSize) const;
-	Common::SeekableReadStream *decompressHeaderlessZlib(Common::MemoryReadStream *packedStream,
+	Common::SeekableReadStream *decompressHeaderlessZlib(const byte *packedData, uint32 packedSize,
 	                                                     uint32 unpackedSize) const;
-	Common::SeekableReadStream *decompressStandardZlib  (Common::MemoryReadStream *packedStream,
+	Common::SeekableReadStream *decompressStandardZlib  (const byte *packedData, uint32 packedSize,
 	                                                     uint32 unpackedSize) const;
 
 	Common::SeekableReadStream *decompressZlib(const byte *compressedData, uint32 packedSize,
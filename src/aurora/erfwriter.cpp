@@ -23,9 +23,13 @@
  */
 
 #include <ctime>
+#include <cstring>
+#include <cassert>
 
+#include "src/common/scopedptr.h"
 #include "src/common/deflate.h"
 #include "src/common/memwritestream.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/erfwriter.h"
 #include "src/aurora/util.h"
@@ -34,6 +38,13 @@ namespace Aurora {
 
 static const uint32 kVersion10 = MKTAG('V', '1', '.', '0');
 
+struct ERFWriter::PackedData {
+	Common::ScopedArray<byte> data;
+
+	uint32 packedSize   { 0 };
+	uint32 unpackedSize { 0 };
+};
+
 ERFWriter::ERFWriter(uint32 id, uint32 fileCount, Common::SeekableWriteStream &stream, Version version, Compression compression, LocString description) :
 		_stream(stream), _version(version), _compression(compression), _fileCount(fileCount) {
 
@@ -55,7 +66,14 @@ ERFWriter::ERFWriter(uint32 id, uint32 fileCount, Common::SeekableWriteStream &s
 	}
 }
 
-void ERFWriter::add(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream) {
+void ERFWriter::setCompressionLevel(int level) {
+	if ((level < Common::kCompressionLevelMin) || (level > Common::kCompressionLevelMax))
+		throw Common::Exception("Invalid compression level %d", level);
+
+	_compressionLevel = level;
+}
+
+void ERFWriter::prepareAdd(FileType &resType) const {
 	if (_currentFileCount == _fileCount)
 		throw Common::Exception("More files added than expected");
 
@@ -67,6 +85,10 @@ void ERFWriter::add(const Common::UString &resRef, FileType resType, Common::See
 	 * They have no real numerical type ID usable for ERF archives. */
 	if (resType >= kFileTypeMAXArchive)
 		resType = kFileTypeRES;
+}
+
+void ERFWriter::add(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream) {
+	prepareAdd(resType);
 
 	switch (_version) {
 		case kERFVersion10:
@@ -83,6 +105,48 @@ void ERFWriter::add(const Common::UString &resRef, FileType resType, Common::See
 	}
 }
 
+void ERFWriter::addAll(const std::vector<Resource> &resources, size_t threadCount,
+                       const std::function<void(size_t)> &packed) {
+
+	if ((_fileCount - _currentFileCount) < resources.size())
+		throw Common::Exception("More files added than expected");
+
+	// Only compressing V2.2 archives does any work worth spreading out over several threads
+	if ((_version != kERFVersion22) || (_compression == kCompressionNone)) {
+		for (size_t i = 0; i < resources.size(); i++) {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(resources[i].open());
+
+			add(resources[i].resRef, resources[i].resType, *stream);
+
+			if (packed)
+				packed(i);
+		}
+
+		return;
+	}
+
+	/* Read and compress the resources on the worker threads, while this
+	 * thread writes the already packed ones into the archive, in order. */
+
+	Common::parallelOrdered<PackedData>(Common::getThreadCount(threadCount), resources.size(),
+		[&](size_t i) -> PackedData * {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(resources[i].open());
+
+			return packV22(*stream);
+		},
+		[&](size_t i, Common::ParallelResult<PackedData> &result) {
+			Common::ScopedPtr<PackedData> data(result.release());
+
+			FileType resType = resources[i].resType;
+			prepareAdd(resType);
+
+			writeV22(resources[i].resRef, resType, *data);
+
+			if (packed)
+				packed(i);
+		});
+}
+
 void ERFWriter::initV10(uint32 id, LocString description) {
 	_stream.writeUint32BE(id);
 	_stream.writeUint32BE(kVersion10);
@@ -249,43 +313,73 @@ void ERFWriter::addV20(const Common::UString &resRef, FileType resType, Common::
 }
 
 void ERFWriter::addV22(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream) {
+	// Uncompressed data is streamed straight into the archive
+	if (_compression == kCompressionNone) {
+		_stream.seek(_offsetToResourceData);
+		const size_t size = _stream.writeStream(stream);
+
+		writeV22Entry(resRef, resType, size, size);
+		return;
+	}
+
+	Common::ScopedPtr<PackedData> data(packV22(stream));
+
+	writeV22(resRef, resType, *data);
+}
+
+ERFWriter::PackedData *ERFWriter::packV22(Common::SeekableReadStream &stream) const {
+	assert(_compression != kCompressionNone);
+
+	Common::ScopedPtr<PackedData> packed(new PackedData);
+
+	const size_t size = stream.size();
+
+	Common::ScopedArray<byte> data(new byte[size]);
+	if (stream.read(data.get(), size) != size)
+		throw Common::Exception(Common::kReadError);
+
+	packed->unpackedSize = size;
+
+	// BioWare zlib has an extra one byte header specifying the window size
+	const size_t headerSize = (_compression == kCompressionBiowareZlib) ? 1 : 0;
+
+	size_t compressedSize = 0;
+	Common::ScopedArray<byte> compressed(Common::compressDeflate(data.get(), size, compressedSize,
+	                                     Common::kWindowBitsMaxRaw, 4096, _compressionLevel));
+
+	if (headerSize > 0) {
+		packed->data.reset(new byte[headerSize + compressedSize]);
+
+		packed->data[0] = static_cast<uint>(Common::kWindowBitsMax) << 4;
+		std::memcpy(packed->data.get() + headerSize, compressed.get(), compressedSize);
+	} else
+		packed->data.reset(compressed.release());
+
+	packed->packedSize = headerSize + compressedSize;
+
+	return packed.release();
+}
+
+void ERFWriter::writeV22(const Common::UString &resRef, FileType resType, const PackedData &data) {
 	// Write the resource data
 	_stream.seek(_offsetToResourceData);
+	_stream.write(data.data.get(), data.packedSize);
 
-	size_t uncompressedSize = stream.size();
-	size_t size = 0;
-
-	switch (_compression) {
-		case kCompressionNone: {
-			size = _stream.writeStream(stream);
-			break;
-		}
-		case kCompressionBiowareZlib: {
-			std::unique_ptr<Common::SeekableReadStream> compressedStream(
-					Common::compressDeflate(stream, uncompressedSize, Common::kWindowBitsMaxRaw));
-			_stream.writeByte(static_cast<uint>(Common::kWindowBitsMax) << 4);
-			size = _stream.writeStream(*compressedStream);
-			size += 1;
-			break;
-		}
-		case kCompressionHeaderlessZlib: {
-			std::unique_ptr<Common::SeekableReadStream> compressedStream(
-					Common::compressDeflate(stream, uncompressedSize, Common::kWindowBitsMaxRaw));
-			size = _stream.writeStream(*compressedStream);
-			break;
-		}
-	}
+	writeV22Entry(resRef, resType, data.packedSize, data.unpackedSize);
+}
 
+void ERFWriter::writeV22Entry(const Common::UString &resRef, FileType resType,
+                              uint32 packedSize, uint32 unpackedSize) {
 	// Write the resource table entry.
 	_stream.seek(_resourceTableOffset + _currentFileCount * 76);
 
 	Common::writeStringFixed(_stream, TypeMan.addFileType(resRef, resType), Common::kEncodingUTF16LE, 64);
 	_stream.writeUint32LE(_offsetToResourceData);
-	_stream.writeUint32LE(size);
-	_stream.writeUint32LE(uncompressedSize);
+	_stream.writeUint32LE(packedSize);
+	_stream.writeUint32LE(unpackedSize);
 
 	// Advance offset and file count.
-	_offsetToResourceData += size;
+	_offsetToResourceData += packedSize;
 	_currentFileCount += 1;
 }
 
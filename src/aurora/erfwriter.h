@@ -25,8 +25,12 @@
 #ifndef AURORA_ERFWRITER_H
 #define AURORA_ERFWRITER_H
 
+#include <vector>
+#include <functional>
+
 #include "src/common/writestream.h"
 #include "src/common/readstream.h"
+#include "src/common/deflate.h"
 
 #include "src/aurora/locstring.h"
 
@@ -61,10 +65,38 @@ public:
 	          LocString description = LocString());
 	~ERFWriter() = default;
 
+	/** A resource to be packed by addAll(). */
+	struct Resource {
+		Common::UString resRef;
+		FileType resType;
+
+		/** Open the resource data. Might be called from any thread. */
+		std::function<Common::SeekableReadStream *()> open;
+	};
+
+	/** Set the zlib compression level, from Common::kCompressionLevelMin to
+	 *  Common::kCompressionLevelMax. The default is Common::kCompressionLevelMax. */
+	void setCompressionLevel(int level);
+
 	/** Add a new stream to this archive to be packed. */
 	void add(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream);
 
+	/** Add several resources to this archive to be packed.
+	 *
+	 *  For compressed V2.2 archives, the resources are read and compressed
+	 *  on threadCount threads, and then written to the archive in order.
+	 *
+	 *  @param resources   The resources to add.
+	 *  @param threadCount The number of threads to compress on. 0 means one per core.
+	 *  @param packed      If given, called on this thread after each resource was written.
+	 */
+	void addAll(const std::vector<Resource> &resources, size_t threadCount = 1,
+	            const std::function<void(size_t)> &packed = std::function<void(size_t)>());
+
 private:
+	/** A resource in its final, possibly compressed, form. */
+	struct PackedData;
+
 	void initV10(uint32 id, LocString description);
 	void initV20();
 	void initV22(Compression compression);
@@ -73,11 +105,19 @@ private:
 	void addV20(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream);
 	void addV22(const Common::UString &resRef, FileType resType, Common::SeekableReadStream &stream);
 
+	void prepareAdd(FileType &resType) const;
+
+	PackedData *packV22(Common::SeekableReadStream &stream) const;
+	void writeV22(const Common::UString &resRef, FileType resType, const PackedData &data);
+	void writeV22Entry(const Common::UString &resRef, FileType resType, uint32 packedSize, uint32 unpackedSize);
+
 	Common::SeekableWriteStream &_stream;
 
 	const Version _version;
 	const Compression _compression;
 
+	int _compressionLevel { Common::kCompressionLevelMax };
+
 	uint32 _currentFileCount { 0 };
 	uint32 _fileCount { 0 };
 	uint32 _offsetToResourceData { 0 };
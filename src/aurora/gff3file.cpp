@@ -27,7 +27,10 @@
  */
 
 #include <cassert>
+#include <algorithm>
 
+#include "src/common/scopedptr.h"
+#include "src/common/endianness.h"
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
 #include "src/common/encoding.h"
@@ -62,8 +65,13 @@ void GFF3File::Header::read(Common::SeekableReadStream &gff3) {
 }
 
 
-GFF3File::GFF3File(Common::SeekableReadStream *gff3, uint32 id, bool repairNWNPremium) :
-	_stream(gff3), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
+GFF3File::Table::Table() : offset(0), size(0) {
+}
+
+
+GFF3File::GFF3File(Common::SeekableReadStream *gff3, uint32 id, bool repairNWNPremium, bool lazy) :
+	_stream(gff3), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0), _lazy(lazy),
+	_fieldData(0), _fieldDataSize(0) {
 
 	assert(_stream);
 
@@ -87,6 +95,9 @@ void GFF3File::load(uint32 id) {
 	try {
 
 		loadHeader(id);
+		loadLabels();
+		loadTables();
+		loadFieldData();
 		loadStructs();
 		loadLists();
 
@@ -169,12 +180,119 @@ void GFF3File::loadHeader(uint32 id) {
 		throw Common::Exception("GFF3 header broken: section offset points outside stream");
 }
 
+void GFF3File::loadLabels() {
+	/* Decode the whole label table in one go, and fold labels that occur
+	 * several times into one distinct label. Fields then only need to
+	 * refer to labels by index. */
+
+	static const uint32 kLabelSize = 16;
+
+	// Only read the labels that are actually in the stream
+	const size_t labelCount = MIN<size_t>(_header.labelCount,
+	                                      (_stream->size() - _header.labelOffset) / kLabelSize);
+
+	_labelIndexToLabel.resize(labelCount);
+	if (labelCount == 0)
+		return;
+
+	Common::ScopedArray<byte> labels(new byte[labelCount * kLabelSize]);
+
+	_stream->seek(_header.labelOffset);
+	if (_stream->read(labels.get(), labelCount * kLabelSize) != (labelCount * kLabelSize))
+		throw Common::Exception(Common::kReadError);
+
+	_labelMap.reserve(labelCount);
+
+	for (size_t i = 0; i < labelCount; i++) {
+		const Common::UString label =
+			Common::readString(labels.get() + i * kLabelSize, kLabelSize, Common::kEncodingASCII);
+
+		std::pair<LabelMap::iterator, bool> result =
+			_labelMap.insert(std::make_pair(label, (uint32) _labels.size()));
+
+		if (result.second)
+			_labels.push_back(label);
+
+		_labelIndexToLabel[i] = result.first->second;
+	}
+}
+
+void GFF3File::loadTables() {
+	/* Read the struct, field, field indices and list indices tables into one
+	 * block of memory. Structs and lists are then created out of there, without
+	 * going through the stream again.
+	 *
+	 * Only as much of each table as is actually in the stream is read. If a
+	 * struct or list needs more, it throws when it is created. */
+
+	static const uint64 kStructSize = 12;
+	static const uint64 kFieldSize  = 12;
+
+	const uint64 streamSize = _stream->size();
+
+	_structTable.size       = MIN<uint64>(_header.structCount * kStructSize, streamSize - _header.structOffset);
+	_fieldTable.size        = MIN<uint64>(_header.fieldCount  * kFieldSize , streamSize - _header.fieldOffset);
+	_fieldIndicesTable.size = MIN<uint64>(_header.fieldIndicesCount        , streamSize - _header.fieldIndicesOffset);
+	_listIndicesTable.size  = MIN<uint64>(_header.listIndicesCount         , streamSize - _header.listIndicesOffset);
+
+	_structTable.offset       = 0;
+	_fieldTable.offset        = _structTable.offset       + _structTable.size;
+	_fieldIndicesTable.offset = _fieldTable.offset        + _fieldTable.size;
+	_listIndicesTable.offset  = _fieldIndicesTable.offset + _fieldIndicesTable.size;
+
+	_tables.reset(new byte[_listIndicesTable.offset + _listIndicesTable.size]);
+
+	readTable(_structTable      , _header.structOffset);
+	readTable(_fieldTable       , _header.fieldOffset);
+	readTable(_fieldIndicesTable, _header.fieldIndicesOffset);
+	readTable(_listIndicesTable , _header.listIndicesOffset);
+}
+
+void GFF3File::loadFieldData() {
+	/* Field values are read through positional reads out of memory, never
+	 * by seeking our stream. That way, several threads can read fields of
+	 * the same GFF3 at the same time.
+	 *
+	 * If our stream is already in memory (or memory-mapped), we use it in
+	 * place. Otherwise, we read everything from the field data on. */
+
+	_fieldDataSize = _stream->size() - _header.fieldDataOffset;
+
+	const byte *data = _stream->getData();
+	if (data) {
+		_fieldData = data + _header.fieldDataOffset;
+		return;
+	}
+
+	_fieldDataBuffer.reset(new byte[_fieldDataSize]);
+	_fieldData = _fieldDataBuffer.get();
+
+	_stream->seek(_header.fieldDataOffset);
+	if (_stream->read(_fieldDataBuffer.get(), _fieldDataSize) != _fieldDataSize)
+		throw Common::Exception(Common::kReadError);
+}
+
+void GFF3File::readTable(const Table &table, uint32 offset) {
+	_stream->seek(offset);
+
+	if (_stream->read(_tables.get() + table.offset, table.size) != table.size)
+		throw Common::Exception(Common::kReadError);
+}
+
 void GFF3File::loadStructs() {
 	static const uint32 kStructSize = 12;
 
-	_structs.reserve(_header.structCount);
+	if (!getTableData(_structTable, 0, (size_t) _header.structCount * kStructSize))
+		throw Common::Exception(Common::kReadError);
+
+	_structs.resize(_header.structCount);
+
+	// When loading lazily, structs are only created when they're needed
+	if (_lazy)
+		return;
+
 	for (uint32 i = 0; i < _header.structCount; i++)
-		_structs.push_back(new GFF3Struct(*this, _header.structOffset + i * kStructSize));
+		createStruct(i);
 }
 
 void GFF3File::loadLists() {
@@ -193,20 +311,19 @@ void GFF3File::loadLists() {
 	 * list of lists into a list index.
 	 */
 
-	_stream->seek(_header.listIndicesOffset);
+	const size_t rawCount = _header.listIndicesCount / 4;
 
-	// Read list array
-	std::vector<uint32> rawLists;
-	rawLists.resize(_header.listIndicesCount / 4);
-	for (std::vector<uint32>::iterator it = rawLists.begin(); it != rawLists.end(); ++it)
-		*it = _stream->readUint32LE();
+	// Raw list array
+	const byte *rawLists = getTableData(_listIndicesTable, 0, rawCount * 4);
+	if (!rawLists)
+		throw Common::Exception(Common::kReadError);
 
 	// Counting the actual amount of lists
 	uint32 listCount = 0;
-	for (size_t i = 0; i < rawLists.size(); i++) {
-		uint32 n = rawLists[i];
+	for (size_t i = 0; i < rawCount; i++) {
+		uint32 n = READ_LE_UINT32(rawLists + i * 4);
 
-		if ((i + n) > rawLists.size())
+		if ((i + n) > rawCount)
 			throw Common::Exception("GFF3: List indices broken during counting");
 
 		i += n;
@@ -214,68 +331,171 @@ void GFF3File::loadLists() {
 	}
 
 	_lists.resize(listCount);
-	_listOffsetToIndex.resize(rawLists.size(), 0xFFFFFFFF);
+	_listLoaded.resize(listCount, false);
 
-	// Converting the raw list array into real, usable lists
+	_listOffsetToIndex.resize(rawCount, 0xFFFFFFFF);
+	_listIndexToOffset.resize(listCount);
+
+	// Finding where each list starts
 	uint32 listIndex = 0;
-	for (size_t i = 0; i < rawLists.size(); listIndex++) {
+	for (size_t i = 0; i < rawCount; listIndex++) {
 		_listOffsetToIndex[i] = listIndex;
+		_listIndexToOffset[listIndex] = i;
+
+		i += READ_LE_UINT32(rawLists + i * 4) + 1;
+	}
+
+	// When loading lazily, lists are only created when they're needed
+	if (_lazy)
+		return;
+
+	for (uint32 i = 0; i < listCount; i++)
+		createList(i);
+}
+
+const GFF3Struct &GFF3File::createStruct(uint32 i) const {
+	assert(i < _structs.size());
+
+	if (!_structs[i])
+		_structs[i] = new GFF3Struct(*this, i);
+
+	return *_structs[i];
+}
+
+const GFF3List &GFF3File::createList(uint32 i) const {
+	assert(i < _lists.size());
+
+	if (_listLoaded[i])
+		return _lists[i];
+
+	// Converting the raw list into a real, usable list
+	std::vector<uint32> indices;
+	readListIndices(i, indices);
+
+	GFF3List &list = _lists[i];
 
-		const uint32 n = rawLists[i++];
-		if ((i + n) > rawLists.size())
-			throw Common::Exception("GFF3: List indices broken during conversion");
+	list.resize(indices.size());
+	for (size_t j = 0; j < indices.size(); j++)
+		list[j] = &createStruct(indices[j]);
 
-		_lists[listIndex].resize(n);
-		for (uint32 j = 0; j < n; j++, i++) {
-			const size_t structIndex = rawLists[i];
-			if (structIndex >= _structs.size())
-				throw Common::Exception("GFF3: List struct index out of range (%u >= %u)",
-				                        (uint) structIndex, (uint) _structs.size());
+	_listLoaded[i] = true;
 
-			_lists[listIndex][j] = _structs[structIndex];
-		}
+	return list;
+}
+
+void GFF3File::readListIndices(uint32 i, std::vector<uint32> &indices) const {
+	assert(i < _listIndexToOffset.size());
+
+	const size_t offset = _listIndexToOffset[i];
+
+	const byte *rawList = getTableData(_listIndicesTable, offset * 4, 4);
+	assert(rawList);
+
+	const uint32 n = READ_LE_UINT32(rawList);
+	rawList += 4;
+
+	indices.resize(n);
+	for (uint32 j = 0; j < n; j++) {
+		indices[j] = READ_LE_UINT32(rawList + j * 4);
+		if (indices[j] >= _structs.size())
+			throw Common::Exception("GFF3: List struct index out of range (%u >= %u)",
+			                        indices[j], (uint) _structs.size());
 	}
 }
 
 // --- Helpers for GFF3Struct ---
 
+uint32 GFF3File::getLabelIndex(uint32 i) const {
+	if (i >= _labelIndexToLabel.size())
+		throw Common::Exception("GFF3: Label index out of range (%u >= %u)",
+		                        i, (uint) _labelIndexToLabel.size());
+
+	return _labelIndexToLabel[i];
+}
+
+uint32 GFF3File::findLabel(const Common::UString &label) const {
+	LabelMap::const_iterator l = _labelMap.find(label);
+	if (l == _labelMap.end())
+		return kLabelNone;
+
+	return l->second;
+}
+
+const Common::UString &GFF3File::getLabel(uint32 label) const {
+	assert(label < _labels.size());
+
+	return _labels[label];
+}
+
+const byte *GFF3File::getTableData(const Table &table, size_t offset, size_t size) const {
+	if ((offset > table.size) || (size > (table.size - offset)))
+		return 0;
+
+	return _tables.get() + table.offset + offset;
+}
+
 const GFF3Struct &GFF3File::getStruct(uint32 i) const {
 	if (i >= _structs.size())
 		throw Common::Exception("GFF3: Struct index out of range (%u >= %u)", i, (uint) _structs.size());
 
-	return *_structs[i];
+	if (!_lazy)
+		return *_structs[i];
+
+	std::lock_guard<std::mutex> lock(_lazyMutex);
+	return createStruct(i);
 }
 
-const GFF3List &GFF3File::getList(uint32 i) const {
-	if (i >= _listOffsetToIndex.size())
+GFF3Struct *GFF3File::readStruct(uint32 i) const {
+	if (i >= _structs.size())
+		throw Common::Exception("GFF3: Struct index out of range (%u >= %u)", i, (uint) _structs.size());
+
+	return new GFF3Struct(*this, i);
+}
+
+/** Convert an offset into the list indices into a list index. */
+static uint32 getListIndex(const std::vector<uint32> &listOffsetToIndex, uint32 i) {
+	if (i >= listOffsetToIndex.size())
 		throw Common::Exception("GFF3: List offset index out of range (%u >= %u)",
-		                        i, (uint) _listOffsetToIndex.size());
+		                        i, (uint) listOffsetToIndex.size());
 
-	const uint32 listIndex = _listOffsetToIndex[i];
+	const uint32 listIndex = listOffsetToIndex[i];
 
 	if (listIndex == 0xFFFFFFFF)
 		throw Common::Exception("GFF3: Empty list index at %u", i);
 
+	return listIndex;
+}
+
+const GFF3List &GFF3File::getList(uint32 i) const {
+	const uint32 listIndex = getListIndex(_listOffsetToIndex, i);
+
 	assert(listIndex < _lists.size());
 
-	return _lists[listIndex];
-}
+	if (!_lazy)
+		return _lists[listIndex];
 
-Common::SeekableReadStream &GFF3File::getStream(uint32 offset) const {
-	_stream->seek(offset);
+	std::lock_guard<std::mutex> lock(_lazyMutex);
+	return createList(listIndex);
+}
 
-	return *_stream;
+void GFF3File::getListIndices(uint32 i, std::vector<uint32> &indices) const {
+	readListIndices(getListIndex(_listOffsetToIndex, i), indices);
 }
 
-Common::SeekableReadStream &GFF3File::getFieldData() const {
-	return getStream(_header.fieldDataOffset);
+const byte *GFF3File::getFieldData(uint32 offset, size_t &size) const {
+	if (offset > _fieldDataSize)
+		throw Common::Exception("GFF3: Field data offset out of range (%u > %u)", offset, (uint) _fieldDataSize);
+
+	size = _fieldDataSize - offset;
+	return _fieldData + offset;
 }
 
 
-GFF3Struct::Field::Field() : type(kFieldTypeNone), data(0), extended(false) {
+GFF3Struct::Field::Field() : label(GFF3File::kLabelNone), order(0), type(kFieldTypeNone), data(0),
+	extended(false) {
 }
 
-GFF3Struct::Field::Field(FieldType t, uint32 d) : type(t), data(d) {
+GFF3Struct::Field::Field(uint32 l, uint32 o, FieldType t, uint32 d) : label(l), order(o), type(t), data(d) {
 	// These field types need extended field data
 	extended = (type == kFieldTypeUint64     ) ||
 	           (type == kFieldTypeSint64     ) ||
@@ -289,9 +509,20 @@ GFF3Struct::Field::Field(FieldType t, uint32 d) : type(t), data(d) {
 	           (type == kFieldTypeStrRef     );
 }
 
+bool GFF3Struct::Field::operator<(const Field &right) const {
+	if (label != right.label)
+		return label < right.label;
+
+	return order < right.order;
+}
+
+bool GFF3Struct::Field::isSameLabel(const Field &a, const Field &b) {
+	return a.label == b.label;
+}
+
 
-GFF3Struct::GFF3Struct(const GFF3File &parent, uint32 offset) : _parent(&parent) {
-	load(offset);
+GFF3Struct::GFF3Struct(const GFF3File &parent, uint32 index) : _parent(&parent) {
+	load(index);
 }
 
 GFF3Struct::~GFF3Struct() {
@@ -303,81 +534,71 @@ uint32 GFF3Struct::getID() const {
 
 // --- Loader ---
 
-void GFF3Struct::load(uint32 offset) {
-	Common::SeekableReadStream &data = _parent->getStream(offset);
+void GFF3Struct::load(uint32 index) {
+	const byte *data = _parent->getTableData(_parent->_structTable, (size_t) index * 12, 12);
+	assert(data);
 
-	_id         = data.readUint32LE();
-	_fieldIndex = data.readUint32LE();
-	_fieldCount = data.readUint32LE();
+	_id         = READ_LE_UINT32(data + 0);
+	_fieldIndex = READ_LE_UINT32(data + 4);
+	_fieldCount = READ_LE_UINT32(data + 8);
 
 	// Read the field(s)
 	if      (_fieldCount == 1)
-		readField (data, _fieldIndex);
+		readField (_fieldIndex);
 	else if (_fieldCount > 1)
-		readFields(data, _fieldIndex, _fieldCount);
+		readFields(_fieldIndex, _fieldCount);
+
+	sortFields();
 }
 
-void GFF3Struct::readField(Common::SeekableReadStream &data, uint32 index) {
+void GFF3Struct::readField(uint32 index) {
 	// Sanity check
-	if (index > _parent->_header.fieldCount)
+	const byte *data = _parent->getTableData(_parent->_fieldTable, (size_t) index * 12, 12);
+	if (!data)
 		throw Common::Exception("GFF3: Field index out of range (%d/%d)",
 				index, _parent->_header.fieldCount);
 
-	// Seek
-	data.seek(_parent->_header.fieldOffset + index * 12);
-
 	// Read the field data
-	const uint32 fieldType  = data.readUint32LE();
-	const uint32 fieldLabel = data.readUint32LE();
-	const uint32 fieldData  = data.readUint32LE();
-
-	// Read the name
-	Common::UString fieldName = readLabel(data, fieldLabel);
-
-	// And add the field to the map and name list
-	_fields[fieldName] = Field((FieldType) fieldType, fieldData);
+	const uint32 fieldType  = READ_LE_UINT32(data + 0);
+	const uint32 fieldLabel = READ_LE_UINT32(data + 4);
+	const uint32 fieldData  = READ_LE_UINT32(data + 8);
 
-	_fieldNames.push_back(fieldName);
+	// And add the field, with its distinct label
+	_fields.push_back(Field(_parent->getLabelIndex(fieldLabel), _fields.size(), (FieldType) fieldType, fieldData));
 }
 
-void GFF3Struct::readFields(Common::SeekableReadStream &data, uint32 index, uint32 count) {
+void GFF3Struct::readFields(uint32 index, uint32 count) {
 	// Sanity check
-	if (index > _parent->_header.fieldIndicesCount)
+	const byte *indices = _parent->getTableData(_parent->_fieldIndicesTable, index, (size_t) count * 4);
+	if (!indices)
 		throw Common::Exception("GFF3: Field indices index out of range (%d/%d)",
 		                        index , _parent->_header.fieldIndicesCount);
 
-	// Seek
-	data.seek(_parent->_header.fieldIndicesOffset + index);
-
-	// Read the field indices
-	std::vector<uint32> indices;
-	readIndices(data, indices, count);
-
 	// Read the fields
-	for (std::vector<uint32>::const_iterator i = indices.begin(); i != indices.end(); ++i)
-		readField(data, *i);
+	_fields.reserve(count);
+	for (uint32 i = 0; i < count; i++)
+		readField(READ_LE_UINT32(indices + i * 4));
 }
 
-void GFF3Struct::readIndices(Common::SeekableReadStream &data,
-                             std::vector<uint32> &indices, uint32 count) const {
-	indices.reserve(count);
-	while (count-- > 0)
-		indices.push_back(data.readUint32LE());
-}
+void GFF3Struct::sortFields() {
+	if (_fields.size() <= 1)
+		return;
 
-Common::UString GFF3Struct::readLabel(Common::SeekableReadStream &data, uint32 index) const {
-	data.seek(_parent->_header.labelOffset + index * 16);
+	/* Sort by label, and within the same label by order. When a label
+	 * occurs more than once, the last field wins. So we reverse the
+	 * fields before removing duplicates, and then reverse them back. */
 
-	return Common::readStringFixed(data, Common::kEncodingASCII, 16);
+	std::sort(_fields.begin(), _fields.end());
+
+	std::reverse(_fields.begin(), _fields.end());
+	_fields.erase(std::unique(_fields.begin(), _fields.end(), Field::isSameLabel), _fields.end());
+	std::reverse(_fields.begin(), _fields.end());
 }
 
-Common::SeekableReadStream &GFF3Struct::getData(const Field &field) const {
+const byte *GFF3Struct::getData(const Field &field, size_t &size) const {
 	assert(field.extended);
 
-	Common::SeekableReadStream &data = _parent->getFieldData();
-	data.skip(field.data);
-
-	return data;
+	return _parent->getFieldData(field.data, size);
 }
 
 // --- Field properties ---
@@ -390,8 +611,30 @@ bool GFF3Struct::hasField(const Common::UString &field) const {
 	return getField(field) != 0;
 }
 
-const std::vector<Common::UString> &GFF3Struct::getFieldNames() const {
-	return _fieldNames;
+std::vector<Common::UString> GFF3Struct::getFieldNames() const {
+	/* The fields themselves only hold the last of several fields with the
+	 * same label. So we read the labels of all fields, duplicates included,
+	 * from the GFF3 again, in the order they appear there. */
+
+	std::vector<Common::UString> fieldNames;
+	fieldNames.reserve(_fieldCount);
+
+	const byte *indices = 0;
+	if (_fieldCount > 1) {
+		indices = _parent->getTableData(_parent->_fieldIndicesTable, _fieldIndex, (size_t) _fieldCount * 4);
+		assert(indices);
+	}
+
+	for (uint32 i = 0; i < _fieldCount; i++) {
+		const uint32 index = (_fieldCount == 1) ? _fieldIndex : READ_LE_UINT32(indices + i * 4);
+
+		const byte *data = _parent->getTableData(_parent->_fieldTable, (size_t) index * 12, 12);
+		assert(data);
+
+		fieldNames.push_back(_parent->getLabel(_parent->getLabelIndex(READ_LE_UINT32(data + 4))));
+	}
+
+	return fieldNames;
 }
 
 GFF3Struct::FieldType GFF3Struct::getFieldType(const Common::UString &field) const {
@@ -405,11 +648,17 @@ GFF3Struct::FieldType GFF3Struct::getFieldType(const Common::UString &field) con
 // --- Field value reader helpers ---
 
 const GFF3Struct::Field *GFF3Struct::getField(const Common::UString &name) const {
-	FieldMap::const_iterator field = _fields.find(name);
-	if (field == _fields.end())
+	Field wanted;
+	wanted.label = _parent->findLabel(name);
+	if (wanted.label == GFF3File::kLabelNone)
 		return 0;
 
-	return &field->second;
+	// Find the first field with this label. There is only one after sortFields()
+	FieldArray::const_iterator field = std::lower_bound(_fields.begin(), _fields.end(), wanted);
+	if ((field == _fields.end()) || (field->label != wanted.label))
+		return 0;
+
+	return &*field;
 }
 
 char GFF3Struct::getChar(const Common::UString &field, char def) const {
@@ -440,14 +689,25 @@ uint64 GFF3Struct::getUint(const Common::UString &field, uint64 def) const {
 		return (uint64) ((int64) ((int16) ((uint16) f->data)));
 	if (f->type == kFieldTypeSint32)
 		return (uint64) ((int64) ((int32) ((uint32) f->data)));
-	if (f->type == kFieldTypeUint64)
-		return (uint64) getData(*f).readUint64LE();
-	if (f->type == kFieldTypeSint64)
-		return ( int64) getData(*f).readUint64LE();
+	if (f->type == kFieldTypeUint64) {
+		size_t dataSize = 0;
+		const byte *fieldData = getData(*f, dataSize);
+
+		return (uint64) Common::MemoryReadStream(fieldData, dataSize).readUint64LE();
+	}
+	if (f->type == kFieldTypeSint64) {
+		size_t dataSize = 0;
+		const byte *fieldData = getData(*f, dataSize);
+
+		return ( int64) Common::MemoryReadStream(fieldData, dataSize).readUint64LE();
+	}
 
 	// StrRef, a numerical reference to a string in a talk table
 	if (f->type == kFieldTypeStrRef) {
-		Common::SeekableReadStream &data = getData(*f);
+		size_t dataSize = 0;
+		const byte *fieldData = getData(*f, dataSize);
+
+		Common::MemoryReadStream data(fieldData, dataSize);
 
 		const uint32 size = data.readUint32LE();
 		if (size != 4)
@@ -477,14 +737,25 @@ int64 GFF3Struct::getSint(const Common::UString &field, int64 def) const {
 		return (int64) ((int16) ((uint16) f->data));
 	if (f->type == kFieldTypeSint32)
 		return (int64) ((int32) ((uint32) f->data));
-	if (f->type == kFieldTypeUint64)
-		return (int64) getData(*f).readUint64LE();
-	if (f->type == kFieldTypeSint64)
-		return (int64) getData(*f).readUint64LE();
+	if (f->type == kFieldTypeUint64) {
+		size_t dataSize = 0;
+		const byte *fieldData = getData(*f, dataSize);
+
+		return (int64) Common::MemoryReadStream(fieldData, dataSize).readUint64LE();
+	}
+	if (f->type == kFieldTypeSint64) {
+		size_t dataSize = 0;
+		const byte *fieldData = getData(*f, dataSize);
+
+		return (int64) Common::MemoryReadStream(fieldData, dataSize).readUint64LE();
+	}
 
 	// StrRef, a numerical reference to a string in a talk table
 	if (f->type == kFieldTypeStrRef) {
-		Common::SeekableReadStream &data = getData(*f);
+		size_t dataSize = 0;
+		const byte *fieldData = getData(*f, dataSize);
+
+		Common::MemoryReadStream data(fieldData, dataSize);
 
 		const uint32 size = data.readUint32LE();
 		if (size != 4)
@@ -507,8 +778,12 @@ double GFF3Struct::getDouble(const Common::UString &field, double def) const {
 
 	if (f->type == kFieldTypeFloat)
 		return convertIEEEFloat(f->data);
-	if (f->type == kFieldTypeDouble)
-		return getData(*f).readIEEEDoubleLE();
+	if (f->type == kFieldTypeDouble) {
+		size_t dataSize = 0;
+		const byte *fieldData = getData(*f, dataSize);
+
+		return Common::MemoryReadStream(fieldData, dataSize).readIEEEDoubleLE();
+	}
 
 	throw Common::Exception("GFF3: Field is not a double type");
 }
@@ -522,7 +797,10 @@ Common::UString GFF3Struct::getString(const Common::UString &field,
 
 	// Direct string
 	if (f->type == kFieldTypeExoString) {
-		Common::SeekableReadStream &data = getData(*f);
+		size_t dataSize = 0;
+		const byte *fieldData = getData(*f, dataSize);
+
+		Common::MemoryReadStream data(fieldData, dataSize);
 
 		const uint32 length = data.readUint32LE();
 		return Common::readStringFixed(data, Common::kEncodingASCII, length);
@@ -536,7 +814,10 @@ Common::UString GFF3Struct::getString(const Common::UString &field,
 		 * however, this limit has been lifted, and a full 255 characters
 		 * are available in ResRef string fields. */
 
-		Common::SeekableReadStream &data = getData(*f);
+		size_t dataSize = 0;
+		const byte *fieldData = getData(*f, dataSize);
+
+		Common::MemoryReadStream data(fieldData, dataSize);
 
 		const uint32 length = data.readByte();
 		return Common::readStringFixed(data, Common::kEncodingASCII, length);
@@ -609,7 +890,10 @@ bool GFF3Struct::getLocString(const Common::UString &field, LocString &str) cons
 
 	try {
 
-		Common::SeekableReadStream &data = getData(*f);
+		size_t dataSize = 0;
+		const byte *fieldData = getData(*f, dataSize);
+
+		Common::MemoryReadStream data(fieldData, dataSize);
 
 		const uint32 size = data.readUint32LE();
 		Common::SeekableSubReadStream locStringData(&data, data.pos(), data.pos() + size);
@@ -633,7 +917,10 @@ Common::SeekableReadStream *GFF3Struct::getData(const Common::UString &field) co
 	    (f->type != kFieldTypeResRef))
 		throw Common::Exception("GFF3: Field is not a data type");
 
-	Common::SeekableReadStream &data = getData(*f);
+	size_t dataSize = 0;
+	const byte *fieldData = getData(*f, dataSize);
+
+	Common::MemoryReadStream data(fieldData, dataSize);
 
 	uint32 size = 0;
 	if      ((f->type == kFieldTypeVoid) || (f->type == kFieldTypeExoString))
@@ -655,7 +942,10 @@ void GFF3Struct::getVector(const Common::UString &field,
 	if (f->type != kFieldTypeVector)
 		throw Common::Exception("GFF3: Field is not a vector type");
 
-	Common::SeekableReadStream &data = getData(*f);
+	size_t dataSize = 0;
+	const byte *fieldData = getData(*f, dataSize);
+
+	Common::MemoryReadStream data(fieldData, dataSize);
 
 	x = data.readIEEEFloatLE();
 	y = data.readIEEEFloatLE();
@@ -671,7 +961,10 @@ void GFF3Struct::getOrientation(const Common::UString &field,
 	if (f->type != kFieldTypeOrientation)
 		throw Common::Exception("GFF3: Field is not an orientation type");
 
-	Common::SeekableReadStream &data = getData(*f);
+	size_t dataSize = 0;
+	const byte *fieldData = getData(*f, dataSize);
+
+	Common::MemoryReadStream data(fieldData, dataSize);
 
 	a = data.readIEEEFloatLE();
 	b = data.readIEEEFloatLE();
@@ -688,7 +981,10 @@ void GFF3Struct::getVector(const Common::UString &field,
 	if (f->type != kFieldTypeVector)
 		throw Common::Exception("GFF3: Field is not a vector type");
 
-	Common::SeekableReadStream &data = getData(*f);
+	size_t dataSize = 0;
+	const byte *fieldData = getData(*f, dataSize);
+
+	Common::MemoryReadStream data(fieldData, dataSize);
 
 	x = data.readIEEEFloatLE();
 	y = data.readIEEEFloatLE();
@@ -704,7 +1000,10 @@ void GFF3Struct::getOrientation(const Common::UString &field,
 	if (f->type != kFieldTypeOrientation)
 		throw Common::Exception("GFF3: Field is not an orientation type");
 
-	Common::SeekableReadStream &data = getData(*f);
+	size_t dataSize = 0;
+	const byte *fieldData = getData(*f, dataSize);
+
+	Common::MemoryReadStream data(fieldData, dataSize);
 
 	a = data.readIEEEFloatLE();
 	b = data.readIEEEFloatLE();
@@ -725,6 +1024,16 @@ const GFF3Struct &GFF3Struct::getStruct(const Common::UString &field) const {
 	return _parent->getStruct(f->data);
 }
 
+uint32 GFF3Struct::getStructIndex(const Common::UString &field) const {
+	const Field *f = getField(field);
+	if (!f)
+		throw Common::Exception("GFF3: No such field");
+	if (f->type != kFieldTypeStruct)
+		throw Common::Exception("GFF3: Field is not a struct type");
+
+	return f->data;
+}
+
 // --- Struct list reader ---
 
 const GFF3List &GFF3Struct::getList(const Common::UString &field) const {
@@ -738,4 +1047,15 @@ const GFF3List &GFF3Struct::getList(const Common::UString &field) const {
 	return _parent->getList(f->data / 4);
 }
 
+void GFF3Struct::getListIndices(const Common::UString &field, std::vector<uint32> &indices) const {
+	const Field *f = getField(field);
+	if (!f)
+		throw Common::Exception("GFF3: No such field");
+	if (f->type != kFieldTypeList)
+		throw Common::Exception("GFF3: Field is not a list type");
+
+	// Byte offset into the list area, all 32bit values.
+	_parent->getListIndices(f->data / 4, indices);
+}
+
 } // End of namespace Aurora
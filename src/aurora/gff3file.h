@@ -26,9 +26,10 @@
 #define AURORA_GFF3FILE_H
 
 #include <vector>
-#include <map>
+#include <mutex>
 
 #include <boost/noncopyable.hpp>
+#include <boost/unordered/unordered_map.hpp>
 
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
@@ -79,13 +80,24 @@ class GFF3Struct;
  *  LocStrings is different. Since xoreos has more flexible handling of
  *  language IDs anyway, this doesn't concern us.
  *
+ *  Normally, all structs and lists are created when the GFF3 is loaded.
+ *  When the constructor parameter lazy is set to true, a struct or list
+ *  is only created the first time it is reached through getTopLevel(),
+ *  GFF3Struct::getStruct() or GFF3Struct::getList(). This is considerably
+ *  faster when only a few fields of a large GFF3 are needed. In either
+ *  mode, the struct, field and index tables are read into memory in one
+ *  go when loading. Structs and lists created that way are kept until the
+ *  GFF3 is destroyed; to walk through a whole GFF3 without keeping all of
+ *  it, see readStruct().
+ *
  *  See also: GFF4File in gff4file.h for the later V4.0/V4.1 versions of
  *  the GFF format.
  */
 class GFF3File : boost::noncopyable, public AuroraFile {
 public:
 	/** Take over this stream and read a GFF3 file out of it. */
-	GFF3File(Common::SeekableReadStream *gff3, uint32 id = 0xFFFFFFFF, bool repairNWNPremium = false);
+	GFF3File(Common::SeekableReadStream *gff3, uint32 id = 0xFFFFFFFF, bool repairNWNPremium = false,
+	         bool lazy = false);
 	virtual ~GFF3File();
 
 	/** Return the GFF3's specific type. */
@@ -94,6 +106,19 @@ public:
 	/** Returns the top-level struct. */
 	const GFF3Struct &getTopLevel() const;
 
+	/** Read a struct on its own, for walking the GFF3 depth-first.
+	 *
+	 *  Unlike the structs returned by getTopLevel(), GFF3Struct::getStruct() and
+	 *  GFF3Struct::getList(), this struct is not kept within the GFF3. It's owned
+	 *  by the caller, and must not outlive the GFF3. Struct index 0 is the
+	 *  top-level struct; the indices of the others come from
+	 *  GFF3Struct::getStructIndex() and GFF3Struct::getListIndices().
+	 *
+	 *  Walking a lazily loaded GFF3 this way only ever holds the structs along
+	 *  the path to the current one.
+	 */
+	GFF3Struct *readStruct(uint32 i) const;
+
 
 private:
 	/** A GFF3 header. */
@@ -116,9 +141,22 @@ private:
 		void read(Common::SeekableReadStream &gff3);
 	};
 
+	/** A table of the GFF3, read into memory. */
+	struct Table {
+		size_t offset; ///< Offset of the table within _tables.
+		size_t size;   ///< Size of the table in bytes.
+
+		Table();
+	};
+
 	typedef Common::PtrVector<GFF3Struct> StructArray;
 	typedef std::vector<GFF3List> ListArray;
 
+	typedef boost::unordered_map<Common::UString, uint32, Common::hashUStringCaseSensitive> LabelMap;
+
+	/** Label index for a label that doesn't exist in this GFF3. */
+	static const uint32 kLabelNone = 0xFFFFFFFF;
+
 
 	Common::ScopedPtr<Common::SeekableReadStream> _stream;
 
@@ -129,30 +167,87 @@ private:
 	/** The correctional value for offsets to repair Neverwinter Nights premium modules. */
 	uint32 _offsetCorrection;
 
-	StructArray _structs; ///< Our structs.
-	ListArray   _lists;   ///< Our lists.
+	/** Only create structs and lists when they're first needed? */
+	bool _lazy;
+
+	/** The struct, field, field indices and list indices tables, in one block of memory. */
+	Common::ScopedArray<byte> _tables;
+
+	Table _structTable;       ///< The struct definitions within _tables.
+	Table _fieldTable;        ///< The field definitions within _tables.
+	Table _fieldIndicesTable; ///< The field indices within _tables.
+	Table _listIndicesTable;  ///< The list indices within _tables.
+
+	/** The field data, from its start to the end of the GFF3, if we had to read it. */
+	Common::ScopedArray<byte> _fieldDataBuffer;
+
+	const byte *_fieldData;     ///< The field data, in _fieldDataBuffer or in our stream.
+	size_t      _fieldDataSize; ///< The size of the field data, up to the end of the GFF3.
+
+	/** Our structs. When loading lazily, structs not yet needed are 0. */
+	mutable StructArray _structs;
+	/** Our lists. When loading lazily, lists not yet needed are empty. */
+	mutable ListArray   _lists;
+
+	/** Has this list been created yet? */
+	mutable std::vector<bool> _listLoaded;
+
+	/** Guards the lazy creation of structs and lists. */
+	mutable std::mutex _lazyMutex;
+
+	/** All distinct field labels in the GFF3. */
+	std::vector<Common::UString> _labels;
+	/** To convert label indices found in the GFF3 to indices into _labels. */
+	std::vector<uint32> _labelIndexToLabel;
+	/** To convert a label string to an index into _labels. */
+	LabelMap _labelMap;
 
 	/** To convert list offsets found in GFF3 to real indices. */
 	std::vector<uint32> _listOffsetToIndex;
+	/** To convert real list indices to list offsets found in the GFF3. */
+	std::vector<uint32> _listIndexToOffset;
 
 
 	// .--- Loading helpers
 	void load(uint32 id);
 	void loadHeader(uint32 id);
+	void loadLabels();
+	void loadTables();
+	void loadFieldData();
 	void loadStructs();
 	void loadLists();
+
+	void readTable(const Table &table, uint32 offset);
+
+	/** Create the struct with this index, if it doesn't exist yet. */
+	const GFF3Struct &createStruct(uint32 i) const;
+	/** Create the list with this index, if it doesn't exist yet. */
+	const GFF3List   &createList  (uint32 i) const;
+	/** Read the struct indices of the list with this index. */
+	void readListIndices(uint32 i, std::vector<uint32> &indices) const;
 	// '---
 
 	// .--- Helper methods called by GFF3Struct
-	/** Return the GFF3 stream. */
-	Common::SeekableReadStream &getStream(uint32 offset) const;
-	/** Return the GFF3 stream seeked to the start of the field data. */
-	Common::SeekableReadStream &getFieldData() const;
+	/** Return the field data from this offset on, and its size up to the end of the GFF3. */
+	const byte *getFieldData(uint32 offset, size_t &size) const;
+
+	/** Return the data at this offset of a table, or 0 if it doesn't hold size bytes there. */
+	const byte *getTableData(const Table &table, size_t offset, size_t size) const;
+
+	/** Return the distinct label for this label index found in the GFF3. */
+	uint32 getLabelIndex(uint32 i) const;
+	/** Return the distinct label with this name, or kLabelNone if there is none. */
+	uint32 findLabel(const Common::UString &label) const;
+	/** Return the name of this distinct label. */
+	const Common::UString &getLabel(uint32 label) const;
 
 	/** Return a struct within the GFF3. */
 	const GFF3Struct &getStruct(uint32 i) const;
 	/** Return a list within the GFF3. */
 	const GFF3List   &getList  (uint32 i) const;
+
+	/** Return the struct indices of a list within the GFF3. */
+	void getListIndices(uint32 i, std::vector<uint32> &indices) const;
 	// '---
 
 	friend class GFF3Struct;
@@ -201,8 +296,11 @@ public:
 	/** Does this specific field exist? */
 	bool hasField(const Common::UString &field) const;
 
-	/** Return a list of all field names in this struct. */
-	const std::vector<Common::UString> &getFieldNames() const;
+	/** Return a list of all field names in this struct, in the order they appear in the GFF3.
+	 *
+	 *  A label that occurs several times within the struct is listed as often.
+	 */
+	std::vector<Common::UString> getFieldNames() const;
 
 	/** Return the type of this field, or kFieldTypeNone if such a field doesn't exist. */
 	FieldType getFieldType(const Common::UString &field) const;
@@ -237,20 +335,33 @@ public:
 	// .--- Structs and lists of structs
 	const GFF3Struct &getStruct(const Common::UString &field) const;
 	const GFF3List   &getList  (const Common::UString &field) const;
+
+	/** Return the index of the struct in this field, for GFF3File::readStruct(). */
+	uint32 getStructIndex(const Common::UString &field) const;
+	/** Return the indices of the structs in this list, for GFF3File::readStruct(). */
+	void getListIndices(const Common::UString &field, std::vector<uint32> &indices) const;
 	// '---
 
 private:
 	/** A field in the GFF3 struct. */
 	struct Field {
+		uint32    label;    ///< Index of the field's label within the GFF3's distinct labels.
+		uint32    order;    ///< Position of the field within the struct in the GFF3.
 		FieldType type;     ///< Type of the field.
 		uint32    data;     ///< Data of the field.
 		bool      extended; ///< Does this field need extended data?
 
 		Field();
-		Field(FieldType t, uint32 d);
+		Field(uint32 l, uint32 o, FieldType t, uint32 d);
+
+		bool operator<(const Field &right) const;
+
+		/** Do these two fields have the same label? */
+		static bool isSameLabel(const Field &a, const Field &b);
 	};
 
-	typedef std::map<Common::UString, Field> FieldMap;
+	/** The fields of a struct, sorted by their label. */
+	typedef std::vector<Field> FieldArray;
 
 
 	const GFF3File *_parent; ///< The parent GFF3.
@@ -259,31 +370,27 @@ private:
 	uint32 _fieldIndex; ///< Field / Field indices index.
 	uint32 _fieldCount; ///< Field count.
 
-	FieldMap _fields; ///< The fields, indexed by their label.
-
-	/** The names of all fields in this struct. */
-	std::vector<Common::UString> _fieldNames;
+	FieldArray _fields; ///< The fields, sorted by their label.
 
 
 	// .--- Loader
-	GFF3Struct(const GFF3File &parent, uint32 offset);
+	GFF3Struct(const GFF3File &parent, uint32 index);
 	~GFF3Struct();
 
-	void load(uint32 offset);
+	void load(uint32 index);
 
-	void readField  (Common::SeekableReadStream &data, uint32 index);
-	void readFields (Common::SeekableReadStream &data, uint32 index, uint32 count);
-	void readIndices(Common::SeekableReadStream &data,
-	                 std::vector<uint32> &indices, uint32 count) const;
+	void readField (uint32 index);
+	void readFields(uint32 index, uint32 count);
 
-	Common::UString readLabel(Common::SeekableReadStream &data, uint32 index) const;
+	/** Sort the fields by label, keeping only the last of several fields with the same label. */
+	void sortFields();
 	// '---
 
 	// .--- Field and field data accessors
 	/** Returns the field with this tag. */
 	const Field *getField(const Common::UString &name) const;
-	/** Returns the extended field data for this field. */
-	Common::SeekableReadStream &getData(const Field &field) const;
+	/** Returns the extended field data for this field, and its size up to the end of the GFF3. */
+	const byte *getData(const Field &field, size_t &size) const;
 	// '---
 
 	friend class GFF3File;
@@ -28,8 +28,10 @@
 
 #include <cassert>
 
+#include "src/common/scopedptr.h"
 #include "src/common/error.h"
 #include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
 #include "src/common/encoding.h"
 #include "src/common/strutil.h"
 
@@ -154,6 +156,16 @@ void GFF4File::loadHeader(uint32 type) {
 	_header.read(*_origStream, _version);
 
 	const size_t pos = _origStream->pos();
+
+	/* Field values are read out of memory, through a new stream each time,
+	 * never by seeking a shared stream. That way, several threads can read
+	 * fields of the same GFF4 at the same time. If the GFF4 isn't already
+	 * in memory (or memory-mapped), read it in now. */
+	if (!_origStream->getData()) {
+		_origStream->seek(0);
+		_origStream.reset(_origStream->readStream(_origStream->size()));
+	}
+
 	_stream.reset(new Common::SeekableSubReadStreamEndian(_origStream.get(), 0, _origStream->size(),
 	                                                      _header.isBigEndian(), false));
 	_stream->seek(pos);
@@ -278,10 +290,54 @@ GFF4Struct *GFF4File::findStruct(uint64 id) {
 	return s->second;
 }
 
-Common::SeekableSubReadStreamEndian &GFF4File::getStream(uint32 offset) const {
-	_stream->seek(offset);
+/** A stream over the whole GFF4, seeked to an offset.
+ *
+ *  Reading a value goes through one of these, built on the stack over the
+ *  GFF4 in memory. That way, no stream needs to be allocated for each value,
+ *  and several threads can read values at the same time. An offset of
+ *  0xFFFFFFFF makes for an invalid stream, to be checked with operator!().
+ */
+class GFF4File::DataStream {
+public:
+	DataStream(const GFF4File &parent, uint32 offset) : _data(parent.getData(_size)),
+		_memory(_data, _size), _stream(&_memory, 0, _size, parent._header.isBigEndian()),
+		_valid(offset != 0xFFFFFFFF) {
+
+		if (_valid)
+			_stream.seek(offset);
+	}
 
-	return *_stream;
+	bool operator!() const {
+		return !_valid;
+	}
+
+	Common::SeekableSubReadStreamEndian &operator*() {
+		return _stream;
+	}
+
+	Common::SeekableSubReadStreamEndian *operator->() {
+		return &_stream;
+	}
+
+	/** Return the GFF4 data at the current position. */
+	const byte *getData() const {
+		return _data + _stream.pos();
+	}
+
+private:
+	size_t      _size;
+	const byte *_data;
+
+	Common::MemoryReadStream            _memory;
+	Common::SeekableSubReadStreamEndian _stream;
+
+	bool _valid;
+};
+
+const byte *GFF4File::getData(size_t &size) const {
+	size = _origStream->size();
+
+	return _origStream->getData();
 }
 
 uint32 GFF4File::getDataOffset() const {
@@ -452,11 +508,11 @@ void GFF4Struct::loadStructs(GFF4File &parent, Field &field) {
 
 	const GFF4File::StructTemplate &tmplt = parent.getStructTemplate(field.structIndex);
 
-	Common::SeekableSubReadStreamEndian &data = parent.getStream(field.offset);
+	GFF4File::DataStream data(parent, field.offset);
 
-	const uint32 structCount = getListCount(data, field);
+	const uint32 structCount = getListCount(*data, field);
 	const uint32 structSize  = field.isReference ? 4 : tmplt.size;
-	const uint32 structStart = data.pos();
+	const uint32 structStart = data->pos();
 
 	field.structs.resize(structCount, 0);
 	for (uint32 i = 0; i < structCount; i++) {
@@ -499,19 +555,19 @@ void GFF4Struct::load(GFF4File &parent, const Field &genericParent) {
 
 	static const uint32 kGenericSize = 8;
 
-	Common::SeekableSubReadStreamEndian &data = parent.getStream(genericParent.offset);
+	GFF4File::DataStream data(parent, genericParent.offset);
 
-	const uint32 genericCount = genericParent.isList ? data.readUint32() : 1;
-	const uint32 genericStart = data.pos();
+	const uint32 genericCount = genericParent.isList ? data->readUint32() : 1;
+	const uint32 genericStart = data->pos();
 
 	for (uint32 i = 0; i < genericCount; i++) {
-		data.seek(genericStart + i * kGenericSize);
+		data->seek(genericStart + i * kGenericSize);
 
-		const uint32 typeAndFlags = data.readUint32();
+		const uint32 typeAndFlags = data->readUint32();
 		const uint16 fieldType  = (typeAndFlags & 0x0000FFFF);
 		const uint16 fieldFlags = (typeAndFlags & 0xFFFF0000) >> 16;
 
-		const uint32 fieldOffset = getDataOffset(genericParent.isReference, data.pos());
+		const uint32 fieldOffset = getDataOffset(genericParent.isReference, data->pos());
 
 		if (fieldOffset == 0xFFFFFFFF)
 			continue;
@@ -598,9 +654,9 @@ uint32 GFF4Struct::getDataOffset(bool isReference, uint32 offset) const {
 	if (!isReference || (offset == 0xFFFFFFFF))
 		return offset;
 
-	Common::SeekableSubReadStreamEndian &data = _parent->getStream(offset);
+	GFF4File::DataStream data(*_parent, offset);
 
-	offset = data.readUint32();
+	offset = data->readUint32();
 	if (offset == 0xFFFFFFFF)
 		return offset;
 
@@ -614,19 +670,11 @@ uint32 GFF4Struct::getDataOffset(const Field &field) const {
 	return getDataOffset(field.isReference, field.offset);
 }
 
-Common::SeekableSubReadStreamEndian *GFF4Struct::getData(const Field &field) const {
-	const uint32 offset = getDataOffset(field);
-	if (offset == 0xFFFFFFFF)
-		return 0;
-
-	return &_parent->getStream(offset);
-}
-
-Common::SeekableSubReadStreamEndian *GFF4Struct::getField(uint32 fieldID, const Field *&field) const {
+uint32 GFF4Struct::getFieldOffset(uint32 fieldID, const Field *&field) const {
 	if (!(field = getField(fieldID)))
-		return 0;
+		return 0xFFFFFFFF;
 
-	return getData(*field);
+	return getDataOffset(*field);
 }
 
 uint32 GFF4Struct::getVectorMatrixLength(const Field &field, uint32 minLength, uint32 maxLength) const {
@@ -875,7 +923,7 @@ Common::UString GFF4Struct::getString(Common::SeekableSubReadStreamEndian &data,
 
 uint64 GFF4Struct::getUint(uint32 field, uint64 def) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return def;
 
@@ -887,7 +935,7 @@ uint64 GFF4Struct::getUint(uint32 field, uint64 def) const {
 
 int64 GFF4Struct::getSint(uint32 field, int64 def) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return def;
 
@@ -903,7 +951,7 @@ bool GFF4Struct::getBool(uint32 field, bool def) const {
 
 double GFF4Struct::getDouble(uint32 field, double def) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return def;
 
@@ -915,7 +963,7 @@ double GFF4Struct::getDouble(uint32 field, double def) const {
 
 float GFF4Struct::getFloat(uint32 field, float def) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return def;
 
@@ -929,7 +977,7 @@ Common::UString GFF4Struct::getString(uint32 field, Common::Encoding encoding,
                                       const Common::UString &def) const {
 
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return def;
 
@@ -947,7 +995,7 @@ bool GFF4Struct::getTalkString(uint32 field, Common::Encoding encoding,
                                uint32 &strRef, Common::UString &str) const {
 
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -977,7 +1025,7 @@ bool GFF4Struct::getTalkString(uint32 field, uint32 &strRef, Common::UString &st
 
 bool GFF4Struct::getVector3(uint32 field, double &v1, double &v2, double &v3) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -995,7 +1043,7 @@ bool GFF4Struct::getVector3(uint32 field, double &v1, double &v2, double &v3) co
 
 bool GFF4Struct::getVector3(uint32 field, float &v1, float &v2, float &v3) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1013,7 +1061,7 @@ bool GFF4Struct::getVector3(uint32 field, float &v1, float &v2, float &v3) const
 
 bool GFF4Struct::getVector4(uint32 field, double &v1, double &v2, double &v3, double &v4) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1032,7 +1080,7 @@ bool GFF4Struct::getVector4(uint32 field, double &v1, double &v2, double &v3, do
 
 bool GFF4Struct::getVector4(uint32 field, float &v1, float &v2, float &v3, float &v4) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1051,7 +1099,7 @@ bool GFF4Struct::getVector4(uint32 field, float &v1, float &v2, float &v3, float
 
 bool GFF4Struct::getMatrix4x4(uint32 field, double (&m)[16]) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1067,7 +1115,7 @@ bool GFF4Struct::getMatrix4x4(uint32 field, double (&m)[16]) const {
 
 bool GFF4Struct::getMatrix4x4(uint32 field, float (&m)[16]) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1083,7 +1131,7 @@ bool GFF4Struct::getMatrix4x4(uint32 field, float (&m)[16]) const {
 
 bool GFF4Struct::getVectorMatrix(uint32 field, std::vector<double> &vectorMatrix) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1101,7 +1149,7 @@ bool GFF4Struct::getVectorMatrix(uint32 field, std::vector<double> &vectorMatrix
 
 bool GFF4Struct::getVectorMatrix(uint32 field, std::vector<float> &vectorMatrix) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1121,7 +1169,7 @@ bool GFF4Struct::getVectorMatrix(uint32 field, std::vector<float> &vectorMatrix)
 
 bool GFF4Struct::getUint(uint32 field, std::vector<uint64> &list) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1136,7 +1184,7 @@ bool GFF4Struct::getUint(uint32 field, std::vector<uint64> &list) const {
 
 bool GFF4Struct::getSint(uint32 field, std::vector<int64> &list) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1151,7 +1199,7 @@ bool GFF4Struct::getSint(uint32 field, std::vector<int64> &list) const {
 
 bool GFF4Struct::getBool(uint32 field, std::vector<bool> &list) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1166,7 +1214,7 @@ bool GFF4Struct::getBool(uint32 field, std::vector<bool> &list) const {
 
 bool GFF4Struct::getDouble(uint32 field, std::vector<double> &list) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1181,7 +1229,7 @@ bool GFF4Struct::getDouble(uint32 field, std::vector<double> &list) const {
 
 bool GFF4Struct::getFloat(uint32 field, std::vector<float> &list) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1198,7 +1246,7 @@ bool GFF4Struct::getString(uint32 field, Common::Encoding encoding,
                            std::vector<Common::UString> &list) const {
 
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data) {
 		if (f && !f->isList) {
 			list.push_back("");
@@ -1226,7 +1274,7 @@ bool GFF4Struct::getTalkString(uint32 field, Common::Encoding encoding,
 
 
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1265,7 +1313,7 @@ bool GFF4Struct::getTalkString(uint32 field,
 
 bool GFF4Struct::getVectorMatrix(uint32 field, std::vector< std::vector<double> > &list) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1285,7 +1333,7 @@ bool GFF4Struct::getVectorMatrix(uint32 field, std::vector< std::vector<double>
 
 bool GFF4Struct::getVectorMatrix(uint32 field, std::vector< std::vector<float> > &list) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return false;
 
@@ -1354,7 +1402,7 @@ const GFF4List &GFF4Struct::getList(uint32 field) const {
 
 Common::SeekableReadStream *GFF4Struct::getData(uint32 field) const {
 	const Field *f;
-	Common::SeekableSubReadStreamEndian *data = getField(field, f);
+	GFF4File::DataStream data(*_parent, getFieldOffset(field, f));
 	if (!data)
 		return 0;
 
@@ -1366,13 +1414,12 @@ Common::SeekableReadStream *GFF4Struct::getData(uint32 field) const {
 
 	const size_t dataSize  = count * size;
 	const size_t dataBegin = data->pos();
-	const size_t dataEnd   = data->pos() + dataSize;
 
 	if ((dataBegin >= data->size()) || ((data->size() - dataBegin) < dataSize))
 		throw Common::Exception("Invalid data offset (%u, %u, %u)",
 		                        (uint) dataBegin, (uint) dataSize, (uint) data->size());
 
-	return new Common::SeekableSubReadStream(data, dataBegin, dataEnd);
+	return new Common::MemoryReadStream(data.getData(), dataSize);
 }
 
 } // End of namespace Aurora
@@ -186,7 +186,11 @@ private:
 	void unregisterStruct(uint64 id);
 	GFF4Struct *findStruct(uint64 id);
 
-	Common::SeekableSubReadStreamEndian &getStream(uint32 offset) const;
+	/** A stream over the whole GFF4, seeked to an offset, to build on the stack. */
+	class DataStream;
+
+	/** Return the whole GFF4, in memory, and its size. */
+	const byte *getData(size_t &size) const;
 	const StructTemplate &getStructTemplate(uint32 i) const;
 	uint32 getDataOffset() const;
 
@@ -399,8 +403,8 @@ private:
 	uint32 getDataOffset(bool isReference, uint32 offset) const;
 	uint32 getDataOffset(const Field &field) const;
 
-	Common::SeekableSubReadStreamEndian *getData(const Field &field) const;
-	Common::SeekableSubReadStreamEndian *getField(uint32 fieldID, const Field *&field) const;
+	/** Find a field and return the offset of its data, or 0xFFFFFFFF if there is none. */
+	uint32 getFieldOffset(uint32 fieldID, const Field *&field) const;
 	// '---
 
 	// .--- Field reader helpers
@@ -0,0 +1,522 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Path queries over the fields of GFF3 and GFF4 structs.
+ */
+
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/error.h"
+#include "src/common/strutil.h"
+#include "src/common/readstream.h"
+#include "src/common/base64.h"
+
+#include "src/aurora/gffquery.h"
+#include "src/aurora/gff3file.h"
+#include "src/aurora/gff4file.h"
+
+namespace Aurora {
+
+static const char * const kGFF3FieldTypeNames[] = {
+	"byte",
+	"char",
+	"uint16",
+	"sint16",
+	"uint32",
+	"sint32",
+	"uint64",
+	"sint64",
+	"float",
+	"double",
+	"exostring",
+	"resref",
+	"locstring",
+	"data",
+	"struct",
+	"list",
+	"orientation",
+	"vector",
+	"strref"
+};
+
+static const char * const kGFF4FieldTypeNames[] = {
+	"uint8",
+	"sint8",
+	"uint16",
+	"sint16",
+	"uint32",
+	"sint32",
+	"uint64",
+	"sint64",
+	"float",
+	"double",
+	"vector3f",
+	"fieldtype11",
+	"vector4f",
+	"quaternionf",
+	"string",
+	"color4f",
+	"matrix4x4f",
+	"tlkstring",
+	"ndsfixed",
+	"fieldtype19",
+	"ascii"
+};
+
+static Common::UString getGFF3TypeName(GFF3Struct::FieldType type) {
+	if (((size_t) type) < ARRAYSIZE(kGFF3FieldTypeNames))
+		return kGFF3FieldTypeNames[(int) type];
+
+	return "fieldtype" + Common::composeString((uint64) type);
+}
+
+static Common::UString getGFF4TypeName(GFF4Struct::FieldType type, bool isList) {
+	const char *listString = isList ? "_list" : "";
+	const char *typeString = "invalid";
+	if      (type == GFF4Struct::kFieldTypeStruct)
+		typeString = "struct";
+	else if (type == GFF4Struct::kFieldTypeGeneric)
+		typeString = "generic";
+	else if (((size_t) type) < ARRAYSIZE(kGFF4FieldTypeNames))
+		typeString = kGFF4FieldTypeNames[type];
+
+	return Common::UString::format("%s%s", typeString, listString);
+}
+
+static Common::UString getGFF3Value(const GFF3Struct &strct, const Common::UString &label,
+                                    GFF3Struct::FieldType type) {
+
+	if (type == GFF3Struct::kFieldTypeVoid) {
+		Common::ScopedPtr<Common::SeekableReadStream> data(strct.getData(label));
+
+		Common::UString base64;
+		Common::encodeBase64(*data, base64);
+
+		return base64;
+	}
+
+	return strct.getString(label);
+}
+
+static Common::UString joinValues(const std::vector<double> &values) {
+	Common::UString str;
+	for (std::vector<double>::const_iterator v = values.begin(); v != values.end(); ++v) {
+		if (v != values.begin())
+			str += "/";
+
+		str += Common::composeString(*v);
+	}
+
+	return str;
+}
+
+/** Read all values of a GFF4 field, which might or might not be a list, as strings. */
+static void getGFF4Values(const GFF4Struct &strct, uint32 label, GFF4Struct::FieldType type,
+                          Common::Encoding encoding, std::vector<Common::UString> &values) {
+
+	switch (type) {
+		case GFF4Struct::kFieldTypeUint8:
+		case GFF4Struct::kFieldTypeUint16:
+		case GFF4Struct::kFieldTypeUint32:
+		case GFF4Struct::kFieldTypeUint64:
+			{
+				std::vector<uint64> list;
+				strct.getUint(label, list);
+
+				for (std::vector<uint64>::const_iterator l = list.begin(); l != list.end(); ++l)
+					values.push_back(Common::composeString(*l));
+			}
+			break;
+
+		case GFF4Struct::kFieldTypeSint8:
+		case GFF4Struct::kFieldTypeSint16:
+		case GFF4Struct::kFieldTypeSint32:
+		case GFF4Struct::kFieldTypeSint64:
+			{
+				std::vector<int64> list;
+				strct.getSint(label, list);
+
+				for (std::vector<int64>::const_iterator l = list.begin(); l != list.end(); ++l)
+					values.push_back(Common::composeString(*l));
+			}
+			break;
+
+		case GFF4Struct::kFieldTypeFloat32:
+		case GFF4Struct::kFieldTypeFloat64:
+		case GFF4Struct::kFieldTypeNDSFixed:
+			{
+				std::vector<double> list;
+				strct.getDouble(label, list);
+
+				for (std::vector<double>::const_iterator l = list.begin(); l != list.end(); ++l)
+					values.push_back(Common::composeString(*l));
+			}
+			break;
+
+		case GFF4Struct::kFieldTypeString:
+		case GFF4Struct::kFieldTypeASCIIString:
+			if (encoding == Common::kEncodingInvalid)
+				strct.getString(label, values);
+			else
+				strct.getString(label, encoding, values);
+			break;
+
+		case GFF4Struct::kFieldTypeTlkString:
+			{
+				std::vector<uint32> strRefs;
+				std::vector<Common::UString> strs;
+
+				if (encoding == Common::kEncodingInvalid)
+					strct.getTalkString(label, strRefs, strs);
+				else
+					strct.getTalkString(label, encoding, strRefs, strs);
+
+				for (size_t i = 0; (i < strRefs.size()) && (i < strs.size()); i++) {
+					Common::UString value = Common::composeString(strRefs[i]);
+					if (!strs[i].empty())
+						value += " " + strs[i];
+
+					values.push_back(value);
+				}
+			}
+			break;
+
+		case GFF4Struct::kFieldTypeVector3f:
+		case GFF4Struct::kFieldTypeVector4f:
+		case GFF4Struct::kFieldTypeQuaternionf:
+		case GFF4Struct::kFieldTypeColor4f:
+		case GFF4Struct::kFieldTypeMatrix4x4f:
+			{
+				std::vector< std::vector<double> > list;
+				strct.getVectorMatrix(label, list);
+
+				for (std::vector< std::vector<double> >::const_iterator l = list.begin(); l != list.end(); ++l)
+					values.push_back(joinValues(*l));
+			}
+			break;
+
+		default:
+			throw Common::Exception("GFF4: Can't query fields of type %u", (uint) type);
+	}
+}
+
+
+GFFQuery::Step::Step() : gff4Label(kLabelNone), anyLabel(false), hasIndex(false), anyIndex(false), index(0) {
+}
+
+
+GFFQuery::GFFQuery(const Common::UString &query) : _query(query) {
+	try {
+		parse();
+	} catch (Common::Exception &e) {
+		e.add("Failed to parse GFF query \"%s\"", _query.c_str());
+		throw;
+	}
+}
+
+GFFQuery::~GFFQuery() {
+}
+
+const Common::UString &GFFQuery::getQuery() const {
+	return _query;
+}
+
+Common::UString GFFQuery::escape(const Common::UString &str) {
+	Common::UString escaped;
+
+	for (Common::UString::iterator c = str.begin(); c != str.end(); ++c) {
+		switch (*c) {
+			case '\\':
+				escaped += "\\\\";
+				break;
+
+			case '\t':
+				escaped += "\\t";
+				break;
+
+			case '\n':
+				escaped += "\\n";
+				break;
+
+			case '\r':
+				escaped += "\\r";
+				break;
+
+			default:
+				escaped += *c;
+				break;
+		}
+	}
+
+	return escaped;
+}
+
+void GFFQuery::parse() {
+	Common::UString::iterator c = _query.begin();
+
+	// The leading separator is optional
+	if ((c != _query.end()) && (*c == '/'))
+		++c;
+
+	while (true) {
+		Step step;
+
+		while ((c != _query.end()) && (*c != '/') && (*c != '.') && (*c != '[') && (*c != ']'))
+			step.label += *c++;
+
+		if (step.label.empty())
+			throw Common::Exception("Empty field label");
+
+		if ((c != _query.end()) && (*c == '[')) {
+			Common::UString index;
+			while ((++c != _query.end()) && (*c != ']'))
+				index += *c;
+
+			if (c == _query.end())
+				throw Common::Exception("Unterminated index");
+
+			++c;
+
+			step.hasIndex = true;
+			step.anyIndex = index == "*";
+
+			if (!step.anyIndex)
+				Common::parseString(index, step.index);
+		}
+
+		step.anyLabel = step.label == "*";
+
+		if (!step.anyLabel) {
+			try {
+				Common::parseString(step.label, step.gff4Label);
+			} catch (...) {
+				step.gff4Label = kLabelNone;
+			}
+		}
+
+		_steps.push_back(step);
+
+		if (c == _query.end())
+			break;
+
+		if ((*c != '/') && (*c != '.'))
+			throw Common::Exception("Expected a separator after \"%s\"", step.label.c_str());
+
+		++c;
+	}
+}
+
+bool GFFQuery::getRange(const Step &step, size_t size, size_t &begin, size_t &end) const {
+	if (step.anyIndex) {
+		begin = 0;
+		end   = size;
+	} else {
+		begin = step.index;
+		end   = step.index + 1;
+	}
+
+	return begin < end && end <= size;
+}
+
+void GFFQuery::evaluate(const GFF3Struct &strct, Results &results) const {
+	evaluateGFF3(strct, 0, "", results);
+}
+
+void GFFQuery::evaluateGFF3(const GFF3Struct &strct, size_t step, const Common::UString &path,
+                            Results &results) const {
+
+	const Step &s = _steps[step];
+
+	if (!s.anyLabel) {
+		if (strct.hasField(s.label))
+			evaluateGFF3(strct, s.label, step, path, results);
+
+		return;
+	}
+
+	const std::vector<Common::UString> labels = strct.getFieldNames();
+	for (std::vector<Common::UString>::const_iterator l = labels.begin(); l != labels.end(); ++l)
+		evaluateGFF3(strct, *l, step, path, results);
+}
+
+void GFFQuery::evaluateGFF3(const GFF3Struct &strct, const Common::UString &label, size_t step,
+                            const Common::UString &path, Results &results) const {
+
+	const Step &s = _steps[step];
+
+	const bool isLast = (step + 1) == _steps.size();
+	const GFF3Struct::FieldType type = strct.getFieldType(label);
+
+	const Common::UString fieldPath = path + "/" + label;
+
+	if (type == GFF3Struct::kFieldTypeList) {
+		const GFF3List &list = strct.getList(label);
+
+		if (!s.hasIndex) {
+			if (isLast)
+				results.push_back(Result { fieldPath, getGFF3TypeName(type), Common::composeString(list.size()) });
+
+			return;
+		}
+
+		size_t begin, end;
+		if (!getRange(s, list.size(), begin, end))
+			return;
+
+		for (size_t i = begin; i < end; i++) {
+			const Common::UString elementPath = fieldPath + "[" + Common::composeString(i) + "]";
+
+			if (isLast)
+				results.push_back(Result { elementPath, "struct", Common::composeString(list[i]->getID()) });
+			else
+				evaluateGFF3(*list[i], step + 1, elementPath, results);
+		}
+
+		return;
+	}
+
+	if (s.hasIndex)
+		return;
+
+	if (type == GFF3Struct::kFieldTypeStruct) {
+		const GFF3Struct &child = strct.getStruct(label);
+
+		if (isLast)
+			results.push_back(Result { fieldPath, getGFF3TypeName(type), Common::composeString(child.getID()) });
+		else
+			evaluateGFF3(child, step + 1, fieldPath, results);
+
+		return;
+	}
+
+	if (isLast)
+		results.push_back(Result { fieldPath, getGFF3TypeName(type), getGFF3Value(strct, label, type) });
+}
+
+void GFFQuery::evaluate(const GFF4Struct &strct, Results &results, Common::Encoding encoding) const {
+	evaluateGFF4(strct, 0, "", encoding, results);
+}
+
+void GFFQuery::evaluateGFF4(const GFF4Struct &strct, size_t step, const Common::UString &path,
+                            Common::Encoding encoding, Results &results) const {
+
+	const Step &s = _steps[step];
+
+	if (!s.anyLabel) {
+		if ((s.gff4Label != kLabelNone) && strct.hasField(s.gff4Label))
+			evaluateGFF4(strct, s.gff4Label, step, path, encoding, results);
+
+		return;
+	}
+
+	const std::vector<uint32> &labels = strct.getFieldLabels();
+	for (std::vector<uint32>::const_iterator l = labels.begin(); l != labels.end(); ++l)
+		evaluateGFF4(strct, *l, step, path, encoding, results);
+}
+
+void GFFQuery::evaluateGFF4(const GFF4Struct &strct, uint32 label, size_t step, const Common::UString &path,
+                            Common::Encoding encoding, Results &results) const {
+
+	const Step &s = _steps[step];
+
+	const bool isLast = (step + 1) == _steps.size();
+
+	bool isList = false;
+	const GFF4Struct::FieldType type = strct.getFieldType(label, isList);
+
+	const Common::UString fieldPath = path + "/" + Common::composeString(label);
+	const Common::UString typeName  = getGFF4TypeName(type, isList);
+
+	if ((type == GFF4Struct::kFieldTypeStruct) || (type == GFF4Struct::kFieldTypeGeneric)) {
+		if (isList) {
+			const GFF4List &list = strct.getList(label);
+
+			if (!s.hasIndex) {
+				if (isLast)
+					results.push_back(Result { fieldPath, typeName, Common::composeString(list.size()) });
+
+				return;
+			}
+
+			size_t begin, end;
+			if (!getRange(s, list.size(), begin, end))
+				return;
+
+			for (size_t i = begin; i < end; i++) {
+				if (!list[i])
+					continue;
+
+				const Common::UString elementPath = fieldPath + "[" + Common::composeString(i) + "]";
+
+				if (isLast)
+					results.push_back(Result { elementPath, "struct", Common::debugTag(list[i]->getLabel()) });
+				else
+					evaluateGFF4(*list[i], step + 1, elementPath, encoding, results);
+			}
+
+			return;
+		}
+
+		if (s.hasIndex)
+			return;
+
+		const GFF4Struct *child = (type == GFF4Struct::kFieldTypeStruct) ?
+			strct.getStruct(label) : strct.getGeneric(label);
+
+		if (!child)
+			return;
+
+		if (isLast)
+			results.push_back(Result { fieldPath, typeName, Common::debugTag(child->getLabel()) });
+		else
+			evaluateGFF4(*child, step + 1, fieldPath, encoding, results);
+
+		return;
+	}
+
+	if (!isLast || (!isList && s.hasIndex))
+		return;
+
+	std::vector<Common::UString> values;
+	getGFF4Values(strct, label, type, encoding, values);
+
+	if (!isList) {
+		if (!values.empty())
+			results.push_back(Result { fieldPath, typeName, values[0] });
+
+		return;
+	}
+
+	if (!s.hasIndex) {
+		results.push_back(Result { fieldPath, typeName, Common::composeString(values.size()) });
+		return;
+	}
+
+	size_t begin, end;
+	if (!getRange(s, values.size(), begin, end))
+		return;
+
+	for (size_t i = begin; i < end; i++)
+		results.push_back(Result { fieldPath + "[" + Common::composeString(i) + "]",
+		                           getGFF4TypeName(type, false), values[i] });
+}
+
+} // End of namespace Aurora
@@ -0,0 +1,134 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Path queries over the fields of GFF3 and GFF4 structs.
+ */
+
+#ifndef AURORA_GFFQUERY_H
+#define AURORA_GFFQUERY_H
+
+#include <vector>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/encoding.h"
+
+namespace Aurora {
+
+class GFF3Struct;
+class GFF4Struct;
+
+/** A compiled path query over the fields of a GFF.
+ *
+ *  A query is a list of field labels, separated by '/' or '.'. A leading
+ *  '/' is optional. Every label but the last has to name a struct or, with
+ *  an index in square brackets, an element of a list. Examples:
+ *
+ *  - ItemList[*].Tag
+ *  - /Creature List[3]/Appearance_Type
+ *  - 16000[0]/16001
+ *
+ *  A label of "*" matches every field of a struct, an index of "*" every
+ *  element of a list. Labels may contain spaces. GFF4 field labels are
+ *  numbers; labels that aren't never match any GFF4 field.
+ *
+ *  A query is parsed once and can then be evaluated against any number
+ *  of structs, from several threads at once. The evaluation walks the
+ *  binary GFF directly, reading only the fields along the path.
+ *
+ *  Fields that don't exist or are of a different type than the path
+ *  requires simply don't match. A matched list without an index yields
+ *  the number of elements, a matched struct its ID (GFF3) or label (GFF4).
+ */
+class GFFQuery {
+public:
+	/** A field matched by a query. */
+	struct Result {
+		Common::UString path;  ///< The concrete path of the field, with all wildcards resolved.
+		Common::UString type;  ///< The name of the field's type.
+		Common::UString value; ///< The value of the field, as a string.
+	};
+
+	typedef std::vector<Result> Results;
+
+	/** Compile a query. Throws an exception if it's malformed. */
+	GFFQuery(const Common::UString &query);
+	~GFFQuery();
+
+	/** Return the query string this query was compiled from. */
+	const Common::UString &getQuery() const;
+
+	/** Escape a path or value of a result, so that it fits onto one line.
+	 *
+	 *  Backslashes, tabs, line feeds and carriage returns are replaced
+	 *  by their C escape sequences.
+	 */
+	static Common::UString escape(const Common::UString &str);
+
+	/** Evaluate the query against a GFF3 struct, appending all matches to results. */
+	void evaluate(const GFF3Struct &strct, Results &results) const;
+
+	/** Evaluate the query against a GFF4 struct, appending all matches to results.
+	 *
+	 *  Strings are read in the given encoding, or in the GFF4's native
+	 *  encoding if the encoding is kEncodingInvalid.
+	 */
+	void evaluate(const GFF4Struct &strct, Results &results,
+	              Common::Encoding encoding = Common::kEncodingInvalid) const;
+
+private:
+	/** One step of a query: a field label, optionally indexing into a list. */
+	struct Step {
+		Common::UString label; ///< The label of the field.
+		uint32 gff4Label;      ///< The label as a GFF4 field label, or kLabelNone.
+
+		bool anyLabel; ///< Does this step match every field?
+		bool hasIndex; ///< Does this step index into a list?
+		bool anyIndex; ///< Does this step match every list element?
+
+		size_t index; ///< The index of the list element.
+
+		Step();
+	};
+
+	static const uint32 kLabelNone = 0xFFFFFFFF;
+
+	Common::UString _query;
+	std::vector<Step> _steps;
+
+	void parse();
+
+	bool getRange(const Step &step, size_t size, size_t &begin, size_t &end) const;
+
+	void evaluateGFF3(const GFF3Struct &strct, size_t step, const Common::UString &path,
+	                  Results &results) const;
+	void evaluateGFF3(const GFF3Struct &strct, const Common::UString &label, size_t step,
+	                  const Common::UString &path, Results &results) const;
+
+	void evaluateGFF4(const GFF4Struct &strct, size_t step, const Common::UString &path,
+	                  Common::Encoding encoding, Results &results) const;
+	void evaluateGFF4(const GFF4Struct &strct, uint32 label, size_t step, const Common::UString &path,
+	                  Common::Encoding encoding, Results &results) const;
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_GFFQUERY_H
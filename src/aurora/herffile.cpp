@@ -64,6 +64,8 @@ void HERFFile::load(Common::SeekableReadStream &herf) {
 		e.add("Failed reading HERF file");
 		throw;
 	}
+
+	invalidateResourceIndex();
 }
 
 void HERFFile::searchDictionary(Common::SeekableReadStream &herf, uint32 resCount) {
@@ -160,11 +162,24 @@ Common::SeekableReadStream *HERFFile::getResource(uint32 index, bool tryNoCopy)
 	const IResource &res = getIResource(index);
 
 	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_herf.get(), res.offset, res.offset + res.size);
+		return _herf->getSubStream(res.offset, res.offset + res.size);
+
+	return _herf->readStreamAt(res.offset, res.size);
+}
 
-	_herf->seek(res.offset);
+bool HERFFile::getResourceLocation(uint32 index, Location &location) const {
+	const IResource &res = getIResource(index);
+
+	location.offset     = res.offset;
+	location.packedSize = res.size;
+	location.size       = res.size;
+	location.packing    = kPackingNone;
+
+	return true;
+}
 
-	return _herf->readStream(res.size);
+bool HERFFile::canReadConcurrently() const {
+	return _herf->canReadAtConcurrently();
 }
 
 Common::HashAlgo HERFFile::getNameHashAlgo() const {
@@ -65,6 +65,12 @@ public:
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy = false) const;
 
+	/** Find out where and how a resource is stored within the HERF. */
+	bool getResourceLocation(uint32 index, Location &location) const;
+
+	/** Can getResource() be called from several threads at once? */
+	bool canReadConcurrently() const;
+
 	/** Return with which algorithm the name is hashed. */
 	Common::HashAlgo getNameHashAlgo() const;
 
@@ -0,0 +1,371 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A cache of the resource indices of KEYs and archives.
+ */
+
+#include <cassert>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/filepath.h"
+#include "src/common/readstream.h"
+#include "src/common/mappedreadfile.h"
+#include "src/common/writefile.h"
+#include "src/common/encoding.h"
+
+#include "src/aurora/indexcache.h"
+#include "src/aurora/util.h"
+#include "src/aurora/cachedarchive.h"
+#include "src/aurora/keydatafile.h"
+#include "src/aurora/biffile.h"
+#include "src/aurora/bzffile.h"
+#include "src/aurora/erffile.h"
+#include "src/aurora/rimfile.h"
+#include "src/aurora/zipfile.h"
+#include "src/aurora/herffile.h"
+
+static const uint32 kCacheID      = MKTAG('X', 'R', 'I', 'C');
+static const uint32 kCacheVersion = MKTAG('V', '2', '.', '0');
+
+namespace Aurora {
+
+IndexCache::File::File() : size(0), time(0) {
+}
+
+IndexCache::File::File(const Common::UString &p) : path(p),
+	size(Common::FilePath::getFileSize(p)), time(Common::FilePath::getModificationTime(p)) {
+
+}
+
+bool IndexCache::File::isCurrent() const {
+	if (!Common::FilePath::isRegularFile(path))
+		return false;
+
+	return (Common::FilePath::getFileSize(path) == size) && (Common::FilePath::getModificationTime(path) == time);
+}
+
+
+IndexCache::Resource::Resource() : type(kFileTypeNone), hash(0), index(0xFFFFFFFF), dataFile(0) {
+}
+
+
+IndexCache::Entry::Entry() : hashAlgo(Common::kHashNone) {
+}
+
+
+IndexCache::IndexCache() : _modified(false) {
+}
+
+IndexCache::~IndexCache() {
+}
+
+bool IndexCache::isModified() const {
+	return _modified;
+}
+
+void IndexCache::load(const Common::UString &cacheFile) {
+	if (!Common::FilePath::isRegularFile(cacheFile))
+		return;
+
+	EntryMap entries;
+
+	try {
+		Common::MappedReadFile cache(cacheFile);
+
+		if ((cache.readUint32BE() != kCacheID) || (cache.readUint32BE() != kCacheVersion))
+			throw Common::Exception("Not an index cache file");
+
+		const uint32 entryCount = cache.readUint32LE();
+		for (uint32 i = 0; i < entryCount; i++) {
+			Entry entry;
+			readEntry(cache, entry);
+
+			entries[entry.file.path] = entry;
+		}
+
+	} catch (...) {
+		Common::exceptionDispatcherWarnAndIgnore(Common::UString::format("Ignoring index cache \"%s\"",
+		                                                                 cacheFile.c_str()));
+		return;
+	}
+
+	// Entries added to this cache are more recent than those of the file
+	for (EntryMap::const_iterator e = _entries.begin(); e != _entries.end(); ++e)
+		entries[e->first] = e->second;
+
+	_modified = !_entries.empty();
+
+	_entries.swap(entries);
+}
+
+void IndexCache::save(const Common::UString &cacheFile) const {
+	// WriteFile only normalizes the path, which would drop a leading ".."
+	Common::WriteFile cache(Common::FilePath::canonicalize(cacheFile));
+
+	cache.writeUint32BE(kCacheID);
+	cache.writeUint32BE(kCacheVersion);
+
+	cache.writeUint32LE(_entries.size());
+	for (EntryMap::const_iterator e = _entries.begin(); e != _entries.end(); ++e)
+		writeEntry(cache, e->second);
+
+	cache.flush();
+
+	_modified = false;
+}
+
+const IndexCache::Entry *IndexCache::find(const Common::UString &path, const Common::UString &baseDirectory) const {
+	EntryMap::const_iterator e = _entries.find(path);
+	if (e == _entries.end())
+		return 0;
+
+	const Entry &entry = e->second;
+	if ((entry.baseDirectory != baseDirectory) || !entry.file.isCurrent())
+		return 0;
+
+	for (std::vector<File>::const_iterator d = entry.dataFiles.begin(); d != entry.dataFiles.end(); ++d)
+		if (!d->isCurrent())
+			return 0;
+
+	return &entry;
+}
+
+const IndexCache::Entry &IndexCache::add(const Entry &entry) {
+	_modified = true;
+
+	return _entries[entry.file.path] = entry;
+}
+
+void IndexCache::setLocations(const Common::UString &path, size_t dataFile,
+                              const std::vector<Archive::Location> &locations) {
+
+	EntryMap::iterator e = _entries.find(path);
+	if ((e == _entries.end()) || (dataFile >= e->second.dataFiles.size()))
+		return;
+
+	e->second.dataFiles[dataFile].locations = locations;
+
+	_modified = true;
+}
+
+Archive *IndexCache::openArchive(const Common::UString &file, FileType type, const std::vector<byte> &password) {
+	const Common::UString path = Common::FilePath::canonicalize(file);
+
+	const Entry *cached = find(path);
+	if (cached && !cached->file.locations.empty())
+		return openCachedArchive(*cached);
+
+	Common::ScopedPtr<Archive> archive(openArchiveFile(file, type, password));
+
+	Entry entry;
+	createEntry(entry, path, *archive);
+
+	add(entry);
+
+	return archive.release();
+}
+
+Archive *IndexCache::openCachedArchive(const Entry &entry) {
+	assert(!entry.file.locations.empty());
+
+	Archive::ResourceList resources;
+	resources.resize(entry.resources.size());
+
+	for (size_t i = 0; i < resources.size(); i++) {
+		resources[i].name  = entry.resources[i].name;
+		resources[i].hash  = entry.resources[i].hash;
+		resources[i].type  = entry.resources[i].type;
+		resources[i].index = entry.resources[i].index;
+	}
+
+	return new CachedArchive(entry.file.path, resources, entry.file.locations, entry.hashAlgo);
+}
+
+void IndexCache::createEntry(Entry &entry, const Common::UString &path, const Archive &archive) {
+	entry.file     = File(path);
+	entry.hashAlgo = archive.getNameHashAlgo();
+
+	const Archive::ResourceList &resources = archive.getResources();
+	entry.resources.resize(resources.size());
+
+	for (size_t i = 0; i < resources.size(); i++) {
+		entry.resources[i].name     = resources[i].name;
+		entry.resources[i].type     = resources[i].type;
+		entry.resources[i].hash     = resources[i].hash;
+		entry.resources[i].index    = resources[i].index;
+		entry.resources[i].dataFile = 0;
+	}
+
+	getLocations(archive, resources.size(), entry.file.locations);
+}
+
+bool IndexCache::getLocations(const Archive &archive, uint32 count, std::vector<Archive::Location> &locations) {
+	locations.resize(count);
+
+	for (uint32 i = 0; i < count; i++) {
+		if (!archive.getResourceLocation(i, locations[i])) {
+			locations.clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+Archive *IndexCache::openArchiveFile(const Common::UString &file, FileType type,
+                                     const std::vector<byte> &password) {
+
+	switch (type) {
+		case kFileTypeBIF:
+		case kFileTypeBZF:
+			return openKEYDataFile(file);
+
+		case kFileTypeERF:
+		case kFileTypeMOD:
+		case kFileTypeHAK:
+		case kFileTypeSAV:
+		case kFileTypeNWM:
+			return new ERFFile(Common::mapOrReadFile(file), password);
+
+		case kFileTypeRIM:
+		case kFileTypeRIMP:
+			return new RIMFile(Common::mapOrReadFile(file));
+
+		case kFileTypeZIP:
+			return new ZIPFile(Common::mapOrReadFile(file));
+
+		case kFileTypeHERF:
+			return new HERFFile(Common::mapOrReadFile(file));
+
+		default:
+			break;
+	}
+
+	throw Common::Exception("Unsupported archive \"%s\"", file.c_str());
+}
+
+KEYDataFile *IndexCache::openKEYDataFile(const Common::UString &file) {
+	if (TypeMan.getFileType(file) == kFileTypeBZF)
+		return new BZFFile(Common::mapOrReadFile(file));
+
+	return new BIFFile(Common::mapOrReadFile(file));
+}
+
+void IndexCache::readFile(Common::SeekableReadStream &cache, File &file) {
+	file.path = Common::readString(cache, Common::kEncodingUTF8);
+	file.size = cache.readUint64LE();
+	file.time = cache.readUint64LE();
+
+	const uint32 locationCount = cache.readUint32LE();
+
+	// Each location takes 17 bytes. Don't trust broken counts
+	if (locationCount > ((cache.size() - cache.pos()) / 17))
+		throw Common::Exception(Common::kReadError);
+
+	file.locations.resize(locationCount);
+	for (std::vector<Archive::Location>::iterator l = file.locations.begin(); l != file.locations.end(); ++l) {
+		l->offset     = cache.readUint64LE();
+		l->packedSize = cache.readUint32LE();
+		l->size       = cache.readUint32LE();
+
+		const byte packing = cache.readByte();
+		if (packing >= Archive::kPackingMAX)
+			throw Common::Exception("Invalid resource packing %u", (uint) packing);
+
+		l->packing = (Archive::Packing) packing;
+	}
+}
+
+void IndexCache::writeFile(Common::WriteStream &cache, const File &file) {
+	Common::writeString(cache, file.path, Common::kEncodingUTF8, true);
+	cache.writeUint64LE(file.size);
+	cache.writeUint64LE(file.time);
+
+	cache.writeUint32LE(file.locations.size());
+	for (std::vector<Archive::Location>::const_iterator l = file.locations.begin(); l != file.locations.end(); ++l) {
+		cache.writeUint64LE(l->offset);
+		cache.writeUint32LE(l->packedSize);
+		cache.writeUint32LE(l->size);
+		cache.writeByte((byte) l->packing);
+	}
+}
+
+void IndexCache::readEntry(Common::SeekableReadStream &cache, Entry &entry) {
+	readFile(cache, entry.file);
+
+	entry.baseDirectory = Common::readString(cache, Common::kEncodingUTF8);
+
+	entry.dataFiles.resize(cache.readUint32LE());
+	for (std::vector<File>::iterator d = entry.dataFiles.begin(); d != entry.dataFiles.end(); ++d)
+		readFile(cache, *d);
+
+	entry.hashAlgo = (Common::HashAlgo) cache.readSint32LE();
+	if ((entry.hashAlgo < Common::kHashNone) || (entry.hashAlgo >= Common::kHashMAX))
+		throw Common::Exception("Invalid hash algorithm %d", (int) entry.hashAlgo);
+
+	const uint32 resourceCount = cache.readUint32LE();
+
+	// Each resource takes at least 21 bytes. Don't trust broken counts
+	if (resourceCount > ((cache.size() - cache.pos()) / 21))
+		throw Common::Exception(Common::kReadError);
+
+	entry.resources.resize(resourceCount);
+	for (std::vector<Resource>::iterator r = entry.resources.begin(); r != entry.resources.end(); ++r) {
+		r->name     = Common::readString(cache, Common::kEncodingUTF8);
+		r->type     = (FileType) cache.readUint32LE();
+		r->hash     = cache.readUint64LE();
+		r->index    = cache.readUint32LE();
+		r->dataFile = cache.readUint32LE();
+
+		if ((entry.dataFiles.empty() && (r->dataFile != 0)) ||
+		    (!entry.dataFiles.empty() && (r->dataFile >= entry.dataFiles.size())))
+			throw Common::Exception("Invalid data file index %u", r->dataFile);
+
+		// The resources of an archive index its locations
+		if (!entry.file.locations.empty() && (r->index >= entry.file.locations.size()))
+			throw Common::Exception("Invalid resource index %u", r->index);
+	}
+}
+
+void IndexCache::writeEntry(Common::WriteStream &cache, const Entry &entry) {
+	writeFile(cache, entry.file);
+
+	Common::writeString(cache, entry.baseDirectory, Common::kEncodingUTF8, true);
+
+	cache.writeUint32LE(entry.dataFiles.size());
+	for (std::vector<File>::const_iterator d = entry.dataFiles.begin(); d != entry.dataFiles.end(); ++d)
+		writeFile(cache, *d);
+
+	cache.writeSint32LE((int32) entry.hashAlgo);
+
+	cache.writeUint32LE(entry.resources.size());
+	for (std::vector<Resource>::const_iterator r = entry.resources.begin(); r != entry.resources.end(); ++r) {
+		Common::writeString(cache, r->name, Common::kEncodingUTF8, true);
+		cache.writeUint32LE((uint32) r->type);
+		cache.writeUint64LE(r->hash);
+		cache.writeUint32LE(r->index);
+		cache.writeUint32LE(r->dataFile);
+	}
+}
+
+} // End of namespace Aurora
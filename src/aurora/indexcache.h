@@ -0,0 +1,194 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A cache of the resource indices of KEYs and archives.
+ */
+
+#ifndef AURORA_INDEXCACHE_H
+#define AURORA_INDEXCACHE_H
+
+#include <vector>
+#include <map>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/hash.h"
+
+#include "src/aurora/types.h"
+#include "src/aurora/archive.h"
+
+namespace Common {
+	class SeekableReadStream;
+	class WriteStream;
+}
+
+namespace Aurora {
+
+class KEYDataFile;
+
+/** A cache of the resource indices of KEYs and archives.
+ *
+ *  For every KEY and archive, the cache holds the list of resources within,
+ *  together with the size and modification time of all files involved. As
+ *  long as those still match the files on disk, the KEY or archive doesn't
+ *  need to be read again.
+ *
+ *  Where possible, the cache also holds where and how each resource is stored
+ *  within its archive, BIF or BZF (see Archive::Location). Those can then be
+ *  listed and read with a CachedArchive, without being parsed at all.
+ *
+ *  Modification times are recorded in nanoseconds, as far as the OS and the
+ *  file system provide them (see Common::FilePath::getModificationTime()).
+ *
+ *  The cache is not thread-safe.
+ */
+class IndexCache : boost::noncopyable {
+public:
+	/** A file within the index cache. */
+	struct File {
+		Common::UString path; ///< The canonical path of the file.
+
+		uint64 size; ///< The size of the file.
+		uint64 time; ///< The modification time, in nanoseconds since the epoch.
+
+		/** Where and how the resources are stored within the file, by their
+		 *  index within it. Empty if that's not known. */
+		std::vector<Archive::Location> locations;
+
+		File();
+		File(const Common::UString &p);
+
+		/** Does the file on disk still have the same size and modification time? */
+		bool isCurrent() const;
+	};
+
+	/** A resource within the index cache. */
+	struct Resource {
+		Common::UString name; ///< The resource's name, if known.
+		FileType        type; ///< The resource's type.
+		uint64          hash; ///< The resource's hashed name.
+
+		uint32 index;    ///< The resource's index within the archive, BIF or BZF.
+		uint32 dataFile; ///< The BIF/BZF of a KEY the resource is in.
+
+		Resource();
+	};
+
+	/** The index of a KEY or an archive. */
+	struct Entry {
+		File file; ///< The KEY or archive.
+
+		Common::UString   baseDirectory; ///< The directory the BIFs/BZFs of a KEY were looked up in.
+		std::vector<File> dataFiles;     ///< The BIFs/BZFs of a KEY, or the KEYs naming the resources of a BIF/BZF.
+
+		Common::HashAlgo hashAlgo; ///< The algorithm the resource names of an archive are hashed with.
+
+		std::vector<Resource> resources;
+
+		Entry();
+	};
+
+	IndexCache();
+	~IndexCache();
+
+	/** Load an index cache file.
+	 *
+	 *  Entries already in this cache take precedence over those in the file.
+	 *  A missing file is ignored; a broken one is ignored with a warning.
+	 */
+	void load(const Common::UString &cacheFile);
+
+	/** Save all entries into an index cache file. */
+	void save(const Common::UString &cacheFile) const;
+
+	/** Were entries added or changed since the cache was last loaded or saved? */
+	bool isModified() const;
+
+	/** Find the entry of a KEY or an archive.
+	 *
+	 *  @param  path The canonical path of the KEY or archive.
+	 *  @param  baseDirectory The canonical directory the BIFs/BZFs of a KEY are in.
+	 *  @return The entry, or 0 if there is none or if any of its files have changed.
+	 */
+	const Entry *find(const Common::UString &path, const Common::UString &baseDirectory = "") const;
+
+	/** Add an entry, replacing any previous entry of the same path. */
+	const Entry &add(const Entry &entry);
+
+	/** Record the locations of the resources within a BIF/BZF of a KEY.
+	 *
+	 *  Nothing happens if there's no entry of that path anymore.
+	 */
+	void setLocations(const Common::UString &path, size_t dataFile,
+	                  const std::vector<Archive::Location> &locations);
+
+	/** Open an archive through the cache.
+	 *
+	 *  If the cache holds a current entry of the archive that records the
+	 *  locations of all its resources, a CachedArchive is returned and the
+	 *  archive is not parsed at all. Otherwise, the archive is opened and its
+	 *  entry added to the cache.
+	 */
+	Archive *openArchive(const Common::UString &file, FileType type,
+	                     const std::vector<byte> &password = std::vector<byte>());
+
+	/** Open an archive through the resource list and locations of its entry.
+	 *
+	 *  The entry has to record the locations of the resources.
+	 */
+	static Archive *openCachedArchive(const Entry &entry);
+
+	/** Fill an entry with the resources of an archive and their locations. */
+	static void createEntry(Entry &entry, const Common::UString &path, const Archive &archive);
+
+	/** Get the locations of the first count resources of an archive.
+	 *
+	 *  @return true if all locations are known. Otherwise, locations is left empty.
+	 */
+	static bool getLocations(const Archive &archive, uint32 count, std::vector<Archive::Location> &locations);
+
+	/** Open an archive file, according to its type. */
+	static Archive *openArchiveFile(const Common::UString &file, FileType type,
+	                                const std::vector<byte> &password = std::vector<byte>());
+
+	/** Open a BIF or BZF file, according to its extension. */
+	static KEYDataFile *openKEYDataFile(const Common::UString &file);
+
+private:
+	/** All entries, by the canonical path of the KEY or archive. */
+	typedef std::map<Common::UString, Entry> EntryMap;
+
+	EntryMap _entries;
+
+	mutable bool _modified;
+
+	static void readFile(Common::SeekableReadStream &cache, File &file);
+	static void writeFile(Common::WriteStream &cache, const File &file);
+
+	static void readEntry(Common::SeekableReadStream &cache, Entry &entry);
+	static void writeEntry(Common::WriteStream &cache, const Entry &entry);
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_INDEXCACHE_H
@@ -80,6 +80,8 @@ void KEYFile::load(Common::SeekableReadStream &key) {
 		_resources.resize(resCount);
 		readResList(key, offResTable);
 
+		sortBIFResources();
+
 	} catch (Common::Exception &e) {
 		e.add("Failed reading KEY file");
 		throw;
@@ -138,6 +140,18 @@ void KEYFile::readResList(Common::SeekableReadStream &key, uint32 offset) {
 	}
 }
 
+void KEYFile::sortBIFResources() {
+	// The resources may reference bifs past the end of the bif list. Keep those too
+	size_t bifCount = _bifs.size();
+	for (ResourceList::const_iterator res = _resources.begin(); res != _resources.end(); ++res)
+		bifCount = MAX<size_t>(bifCount, res->bifIndex + 1);
+
+	_bifResources.resize(bifCount);
+
+	for (size_t i = 0; i < _resources.size(); i++)
+		_bifResources[_resources[i].bifIndex].push_back(i);
+}
+
 const KEYFile::BIFList &KEYFile::getBIFs() const {
 	return _bifs;
 }
@@ -146,4 +160,13 @@ const KEYFile::ResourceList &KEYFile::getResources() const {
 	return _resources;
 }
 
+const KEYFile::ResourceIndexList &KEYFile::getBIFResources(uint32 bifIndex) const {
+	static const ResourceIndexList kEmptyList;
+
+	if (bifIndex >= _bifResources.size())
+		return kEmptyList;
+
+	return _bifResources[bifIndex];
+}
+
 } // End of namespace Aurora
@@ -80,6 +80,7 @@ public:
 
 	typedef std::vector<Resource> ResourceList;
 	typedef std::vector<Common::UString> BIFList;
+	typedef std::vector<uint32> ResourceIndexList;
 
 	KEYFile(Common::SeekableReadStream &key);
 	~KEYFile();
@@ -90,14 +91,21 @@ public:
 	/** Return a list of all containing resources. */
 	const ResourceList &getResources() const;
 
+	/** Return the indices into the resource list of all resources within this bif. */
+	const ResourceIndexList &getBIFResources(uint32 bifIndex) const;
+
 private:
 	BIFList      _bifs;      ///< All managed bifs.
 	ResourceList _resources; ///< All containing resources.
 
+	std::vector<ResourceIndexList> _bifResources; ///< The resources, sorted into buckets by bif.
+
 	void load(Common::SeekableReadStream &key);
 
 	void readBIFList(Common::SeekableReadStream &key, uint32 offset);
 	void readResList(Common::SeekableReadStream &key, uint32 offset);
+
+	void sortBIFResources();
 };
 
 } // End of namespace Aurora
@@ -74,6 +74,7 @@ void NDSFile::load(Common::SeekableReadStream &nds) {
 		throw;
 	}
 
+	invalidateResourceIndex();
 }
 
 void NDSFile::readNames(Common::SeekableReadStream &nds, uint32 offset, uint32 length) {
@@ -166,14 +167,14 @@ uint32 NDSFile::getResourceSize(uint32 index) const {
 Common::SeekableReadStream *NDSFile::getResource(uint32 index, bool tryNoCopy) const {
 	const IResource &res = getIResource(index);
 
-	_nds->seek(res.offset);
-
 	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_nds.get(), res.offset, res.offset + res.size);
+		return _nds->getSubStream(res.offset, res.offset + res.size);
 
-	_nds->seek(res.offset);
+	return _nds->readStreamAt(res.offset, res.size);
+}
 
-	return _nds->readStream(res.size);
+bool NDSFile::canReadConcurrently() const {
+	return _nds->canReadAtConcurrently();
 }
 
 } // End of namespace Aurora
@@ -62,6 +62,9 @@ public:
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy = false) const;
 
+	/** Can getResource() be called from several threads at once? */
+	bool canReadConcurrently() const;
+
 	/** Return the game title string stored in the NDS header. */
 	const Common::UString &getTitle() const;
 	/** Return the game code string stored in the NDS header. */
@@ -353,6 +353,8 @@ void NSBTXFile::load(Common::SeekableSubReadStreamEndian &nsbtx) {
 		e.add("Failed reading NSBTX file");
 		throw;
 	}
+
+	invalidateResourceIndex();
 }
 
 void NSBTXFile::readHeader(Common::SeekableSubReadStreamEndian &nsbtx) {
@@ -61,6 +61,8 @@ void OBBFile::load(Common::SeekableReadStream &obb) {
 		e.add("Failed reading OBB file");
 		throw;
 	}
+
+	invalidateResourceIndex();
 }
 
 void OBBFile::readResList(Common::SeekableReadStream &index) {
@@ -166,6 +168,14 @@ uint32 OBBFile::getResourceSize(uint32 index) const {
 }
 
 Common::SeekableReadStream *OBBFile::getResource(uint32 index, bool UNUSED(tryNoCopy)) const {
+	return readResource(index, false);
+}
+
+Common::SeekableReadStream *OBBFile::getResourceStreamed(uint32 index) const {
+	return readResource(index, true);
+}
+
+Common::SeekableReadStream *OBBFile::readResource(uint32 index, bool streamed) const {
 	/* Decompress a single file.
 	 *
 	 * Files in OBB virtual filesystems are split up in zlib compressed chunks.
@@ -191,7 +201,20 @@ Common::SeekableReadStream *OBBFile::getResource(uint32 index, bool UNUSED(tryNo
 
 	const IResource &res = getIResource(index);
 
-	_obb->seek(res.offset);
+	/* Since the compressed size includes the extra data mentioned above, it is
+	 * an upper bound for the chunk data. So we can read all chunks in one go,
+	 * without touching the position of the OBB stream. */
+	if (res.offset > _obb->size())
+		throw Common::Exception(Common::kReadError);
+
+	const size_t packedSize = MIN<size_t>(res.compressedSize, _obb->size() - res.offset);
+
+	// When asked to, large files are inflated on demand, chunk after chunk, while they're being read
+	if (streamed && (res.uncompressedSize >= Common::kInflateStreamThreshold))
+		return new Common::InflateReadStream(_obb->getSubStream(res.offset, res.offset + packedSize), true,
+		                                     res.uncompressedSize, Common::kWindowBitsMax, true);
+
+	Common::ScopedPtr<Common::MemoryReadStream> packed(_obb->readStreamAt(res.offset, packedSize));
 
 	Common::ScopedArray<byte> data(new byte[res.uncompressedSize]);
 
@@ -200,7 +223,7 @@ Common::SeekableReadStream *OBBFile::getResource(uint32 index, bool UNUSED(tryNo
 
 	while (bytesLeft > 0) {
 		const size_t bytesChunk =
-			Common::decompressDeflateChunk(*_obb, Common::kWindowBitsMax,
+			Common::decompressDeflateChunk(*packed, Common::kWindowBitsMax,
 			                               data.get() + offset, bytesLeft, 4096);
 
 		offset    += bytesChunk;
@@ -210,4 +233,8 @@ Common::SeekableReadStream *OBBFile::getResource(uint32 index, bool UNUSED(tryNo
 	return new Common::MemoryReadStream(data.release(), res.uncompressedSize, true);
 }
 
+bool OBBFile::canReadConcurrently() const {
+	return _obb->canReadAtConcurrently();
+}
+
 } // End of namespace Aurora
@@ -68,6 +68,12 @@ public:
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy = false) const;
 
+	/** Return a stream of the resource's contents, inflating large resources on demand. */
+	Common::SeekableReadStream *getResourceStreamed(uint32 index) const;
+
+	/** Can getResource() be called from several threads at once? */
+	bool canReadConcurrently() const;
+
 private:
 	/** Internal resource information. */
 	struct IResource {
@@ -92,6 +98,8 @@ private:
 	Common::SeekableReadStream *getIndex(Common::SeekableReadStream &obb);
 
 	const IResource &getIResource(uint32 index) const;
+
+	Common::SeekableReadStream *readResource(uint32 index, bool streamed) const;
 };
 
 } // End of namespace Aurora
@@ -0,0 +1,341 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A manager indexing the resources of a game installation.
+ */
+
+#include <cassert>
+#include <list>
+
+#include <boost/functional/hash.hpp>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/filepath.h"
+#include "src/common/readfile.h"
+
+#include "src/aurora/resman.h"
+#include "src/aurora/util.h"
+#include "src/aurora/keyfile.h"
+#include "src/aurora/keydatafile.h"
+#include "src/aurora/cachedarchive.h"
+
+namespace Aurora {
+
+ResourceManager::Resource::Resource() : type(kFileTypeNone), priority(0), source(SIZE_MAX), index(0xFFFFFFFF) {
+}
+
+
+ResourceManager::Source::Source(const Common::UString &p, const std::vector<byte> &pw,
+                                const IndexCache::Entry &entry, size_t d, Archive *a) :
+	path(p), type(TypeMan.getFileType(p)), password(pw),
+	entryPath(entry.file.path), baseDirectory(entry.baseDirectory), dataFile(d), archive(a) {
+
+}
+ResourceManager::Source::~Source() {
+}
+
+
+size_t ResourceManager::hashResourceKey::operator()(const ResourceKey &key) const {
+	size_t seed = Common::hashUStringCaseSensitive()(key.first);
+	boost::hash_combine<int>(seed, key.second);
+
+	return seed;
+}
+
+
+ResourceManager::ResourceManager() {
+}
+
+ResourceManager::~ResourceManager() {
+}
+
+void ResourceManager::clear() {
+	_resources.clear();
+	_sources.clear();
+}
+
+void ResourceManager::addResource(const Resource &resource) {
+	std::pair<ResourceMap::iterator, bool> result =
+		_resources.insert(std::make_pair(ResourceKey(resource.name.toLower(), resource.type), resource));
+
+	// Already have a resource of that name and type. Replace it if it's not of a higher priority
+	if (!result.second && (result.first->second.priority <= resource.priority))
+		result.first->second = resource;
+}
+
+void ResourceManager::addIndexEntry(const IndexCache::Entry &entry, uint32 priority,
+                                    const std::vector<byte> &password, Archive *archive) {
+
+	// An archive is its own, single source. A KEY has one source for every BIF/BZF
+	const size_t firstSource = _sources.size();
+	if (entry.dataFiles.empty())
+		_sources.push_back(new Source(entry.file.path, password, entry, SIZE_MAX, archive));
+	else
+		for (size_t d = 0; d < entry.dataFiles.size(); d++)
+			_sources.push_back(new Source(entry.dataFiles[d].path, password, entry, d));
+
+	_resources.reserve(_resources.size() + entry.resources.size());
+
+	Resource resource;
+	resource.priority = priority;
+
+	for (std::vector<IndexCache::Resource>::const_iterator r = entry.resources.begin(); r != entry.resources.end(); ++r) {
+		// Resources only known by their hashed names can't be looked up by name
+		if (r->name.empty())
+			continue;
+
+		resource.name   = r->name;
+		resource.type   = r->type;
+		resource.index  = r->index;
+		resource.source = firstSource + r->dataFile;
+
+		addResource(resource);
+	}
+}
+
+void ResourceManager::addKEY(const Common::UString &keyFile, const Common::UString &baseDirectory,
+                             uint32 priority) {
+
+	const Common::UString path    = Common::FilePath::canonicalize(keyFile);
+	const Common::UString baseDir = Common::FilePath::canonicalize(baseDirectory);
+
+	const IndexCache::Entry *cached = _indexCache.find(path, baseDir);
+	if (cached) {
+		addIndexEntry(*cached, priority);
+		return;
+	}
+
+	Common::ReadFile keyStream(keyFile);
+	KEYFile key(keyStream);
+
+	IndexCache::Entry entry;
+	entry.file          = IndexCache::File(path);
+	entry.baseDirectory = baseDir;
+
+	const KEYFile::BIFList &bifs = key.getBIFs();
+	const KEYFile::ResourceList &keyResources = key.getResources();
+
+	entry.resources.reserve(keyResources.size());
+
+	// Every directory the BIFs/BZFs are in is only listed once
+	DirectoryMap directories;
+
+	for (uint32 i = 0; i < bifs.size(); i++) {
+		const Common::UString dataFile = findKEYDataFile(baseDirectory, bifs[i], directories);
+		if (dataFile.empty()) {
+			warning("KEY \"%s\" references non-existent file \"%s\"", keyFile.c_str(), bifs[i].c_str());
+			continue;
+		}
+
+		entry.dataFiles.push_back(IndexCache::File(Common::FilePath::canonicalize(dataFile)));
+
+		IndexCache::Resource resource;
+		resource.dataFile = entry.dataFiles.size() - 1;
+
+		const KEYFile::ResourceIndexList &bifResources = key.getBIFResources(i);
+		for (KEYFile::ResourceIndexList::const_iterator r = bifResources.begin(); r != bifResources.end(); ++r) {
+			resource.name  = keyResources[*r].name;
+			resource.type  = keyResources[*r].type;
+			resource.index = keyResources[*r].resIndex;
+
+			entry.resources.push_back(resource);
+		}
+	}
+
+	addIndexEntry(_indexCache.add(entry), priority);
+}
+
+void ResourceManager::addArchive(const Common::UString &archiveFile, uint32 priority,
+                                 const std::vector<byte> &password) {
+
+	const Common::UString path = Common::FilePath::canonicalize(archiveFile);
+
+	const IndexCache::Entry *cached = _indexCache.find(path);
+	if (cached) {
+		addIndexEntry(*cached, priority, password);
+		return;
+	}
+
+	Common::ScopedPtr<Archive> archive(IndexCache::openArchiveFile(archiveFile, TypeMan.getFileType(archiveFile),
+	                                                              password));
+
+	IndexCache::Entry entry;
+	IndexCache::createEntry(entry, path, *archive);
+
+	addIndexEntry(_indexCache.add(entry), priority, password, archive.release());
+}
+
+void ResourceManager::addDirectory(const Common::UString &directory, uint32 priority, bool recursive) {
+	std::list<Common::UString> files;
+	if (!Common::FilePath::getFiles(directory, files, recursive))
+		throw Common::Exception("Can't read directory \"%s\"", directory.c_str());
+
+	Resource resource;
+	resource.priority = priority;
+
+	for (std::list<Common::UString>::const_iterator f = files.begin(); f != files.end(); ++f) {
+		resource.type = TypeMan.getFileType(*f);
+		if (resource.type == kFileTypeNone)
+			continue;
+
+		resource.name = Common::FilePath::getStem(*f);
+		resource.path = *f;
+
+		addResource(resource);
+	}
+}
+
+size_t ResourceManager::getResourceCount() const {
+	return _resources.size();
+}
+
+bool ResourceManager::hasResource(const Common::UString &name, FileType type) const {
+	return findResource(name, type) != 0;
+}
+
+const ResourceManager::Resource *ResourceManager::findResource(const Common::UString &name, FileType type) const {
+	ResourceMap::const_iterator r = _resources.find(ResourceKey(name.toLower(), type));
+	if (r == _resources.end())
+		return 0;
+
+	return &r->second;
+}
+
+void ResourceManager::getResources(FileType type, std::vector<const Resource *> &resources) const {
+	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r)
+		if (r->second.type == type)
+			resources.push_back(&r->second);
+}
+
+Common::SeekableReadStream *ResourceManager::getResource(const Common::UString &name, FileType type) const {
+	const Resource *resource = findResource(name, type);
+	if (!resource)
+		return 0;
+
+	return getResource(*resource);
+}
+
+Common::SeekableReadStream *ResourceManager::getResource(const Resource &resource) const {
+	if (resource.source == SIZE_MAX)
+		return new Common::ReadFile(resource.path);
+
+	Archive &archive = *getArchive(resource.source);
+	if (archive.canReadConcurrently())
+		return archive.getResource(resource.index);
+
+	std::lock_guard<std::mutex> lock(_sources[resource.source]->mutex);
+	return archive.getResource(resource.index);
+}
+
+Archive *ResourceManager::getArchive(size_t source) const {
+	assert(source < _sources.size());
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	Source &s = *_sources[source];
+	if (!s.archive) {
+		try {
+			s.archive.reset(openSource(s));
+		} catch (Common::Exception &e) {
+			e.add("Failed opening \"%s\"", s.path.c_str());
+			throw;
+		}
+	}
+
+	return s.archive.get();
+}
+
+Archive *ResourceManager::openSource(const Source &source) const {
+	const IndexCache::Entry *entry = _indexCache.find(source.entryPath, source.baseDirectory);
+
+	const IndexCache::File *file = 0;
+	if (entry)
+		file = (source.dataFile == SIZE_MAX) ? &entry->file : &entry->dataFiles[source.dataFile];
+
+	// We only ever read resources by index, so the cached archive doesn't need a resource list
+	if (file && !file->locations.empty())
+		return new CachedArchive(source.path, Archive::ResourceList(), file->locations);
+
+	if (source.dataFile == SIZE_MAX)
+		return IndexCache::openArchiveFile(source.path, source.type, source.password);
+
+	// Remember where the resources of this BIF/BZF are, for the next time
+	Common::ScopedPtr<KEYDataFile> dataFile(IndexCache::openKEYDataFile(source.path));
+
+	std::vector<Archive::Location> locations;
+	if (entry && IndexCache::getLocations(*dataFile, dataFile->getInternalResourceCount(), locations))
+		_indexCache.setLocations(source.entryPath, source.dataFile, locations);
+
+	return dataFile.release();
+}
+
+void ResourceManager::loadIndexCache(const Common::UString &cacheFile) {
+	_indexCache.load(cacheFile);
+}
+
+void ResourceManager::saveIndexCache(const Common::UString &cacheFile) const {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_indexCache.save(cacheFile);
+}
+
+bool ResourceManager::isIndexCacheModified() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	return _indexCache.isModified();
+}
+
+Common::UString ResourceManager::findKEYDataFile(const Common::UString &baseDirectory,
+                                                 const Common::UString &dataFile, DirectoryMap &directories) {
+
+	const Common::UString subDirectory = Common::FilePath::getDirectory(dataFile);
+
+	std::pair<DirectoryMap::iterator, bool> directory =
+		directories.insert(std::make_pair(subDirectory.toLower(), DirectoryFiles()));
+
+	DirectoryFiles &files = directory.first->second;
+
+	// A directory we haven't looked at yet. List its files
+	if (directory.second) {
+		const Common::UString path = Common::FilePath::findSubDirectory(baseDirectory, subDirectory, true);
+
+		std::list<Common::UString> fileList;
+		if (!path.empty() && Common::FilePath::getFiles(path, fileList)) {
+			for (std::list<Common::UString>::const_iterator f = fileList.begin(); f != fileList.end(); ++f) {
+				const Common::UString name = Common::FilePath::getStem(*f) + Common::FilePath::getExtension(*f);
+
+				files.insert(std::make_pair(name.toLower(), *f));
+			}
+		}
+	}
+
+	const Common::UString stem = Common::FilePath::getStem(dataFile).toLower();
+
+	// Look for the data file itself first, then for a BZF of the same name
+	DirectoryFiles::const_iterator file = files.find(stem + Common::FilePath::getExtension(dataFile).toLower());
+	if (file == files.end())
+		file = files.find(stem + ".bzf");
+
+	return (file != files.end()) ? file->second : "";
+}
+
+} // End of namespace Aurora
@@ -0,0 +1,208 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A manager indexing the resources of a game installation.
+ */
+
+#ifndef AURORA_RESMAN_H
+#define AURORA_RESMAN_H
+
+#include <vector>
+#include <map>
+#include <mutex>
+
+#include <boost/noncopyable.hpp>
+#include <boost/unordered/unordered_map.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ptrvector.h"
+
+#include "src/aurora/types.h"
+#include "src/aurora/indexcache.h"
+
+namespace Common {
+	class SeekableReadStream;
+}
+
+namespace Aurora {
+
+class Archive;
+
+/** A manager indexing the resources of a game installation.
+ *
+ *  Resources can be added from KEY files, from the BIFs or BZFs they index,
+ *  from other archives (ERF, RIM, ZIP and HERF) and from directories, like
+ *  the override directory. All of them are indexed in one hash table, so
+ *  that looking up a resource by name and type takes constant time.
+ *
+ *  Every source has a priority. When several sources contain a resource of
+ *  the same name and type, the one with the highest priority wins. Among
+ *  sources of equal priority, the one added last wins.
+ *
+ *  Resource names are case-insensitive, like they are in the games.
+ *
+ *  When adding a KEY, only the KEY itself is read. Each BIF or BZF is
+ *  opened the first time a resource within it is requested. Other archives
+ *  are opened when they are added, to read their resource lists.
+ *
+ *  To skip even that on later runs, the index of all KEYs and archives can
+ *  be saved into an index cache file with saveIndexCache() (see IndexCache).
+ *  After loading it again with loadIndexCache(), KEYs and archives that
+ *  haven't changed are indexed from the cache, and archives are only opened
+ *  on demand as well. Archives, BIFs and BZFs whose resource locations are
+ *  cached are then read without being parsed at all.
+ *
+ *  Once all sources are added, getResource() can be called from several
+ *  threads at once. Archives that can't be read from concurrently are
+ *  then read from by one thread at a time.
+ */
+class ResourceManager : boost::noncopyable {
+public:
+	/** A resource known to the manager. */
+	struct Resource {
+		Common::UString name; ///< The resource's name.
+		FileType        type; ///< The resource's type.
+
+		uint32 priority; ///< The priority of the resource's source.
+
+		size_t source; ///< Index of the archive containing the resource, or SIZE_MAX.
+		uint32 index;  ///< The resource's index within the archive.
+
+		Common::UString path; ///< The file the resource is in, if it's not in an archive.
+
+		Resource();
+	};
+
+	ResourceManager();
+	~ResourceManager();
+
+	/** Remove all sources and resources. A loaded index cache is kept. */
+	void clear();
+
+	/** Load an index cache file.
+	 *
+	 *  KEYs and archives added afterwards are indexed from the cache if their
+	 *  size and modification time (and those of the BIFs/BZFs of a KEY) still
+	 *  match the cached ones. A missing or broken cache file is ignored.
+	 */
+	void loadIndexCache(const Common::UString &cacheFile);
+
+	/** Save the index of all KEYs and archives known into a cache file.
+	 *
+	 *  This includes all KEYs and archives added, as well as all other ones
+	 *  from a previously loaded cache.
+	 */
+	void saveIndexCache(const Common::UString &cacheFile) const;
+
+	/** Did the index cache change since it was loaded or saved? */
+	bool isIndexCacheModified() const;
+
+	/** Add a KEY file and its BIFs/BZFs.
+	 *
+	 *  The BIFs/BZFs are looked up relative to the base directory, ignoring
+	 *  case. BIFs for which only a BZF of the same name exists are read from
+	 *  that BZF. Resources within BIFs that can't be found are not added.
+	 */
+	void addKEY(const Common::UString &keyFile, const Common::UString &baseDirectory, uint32 priority);
+
+	/** Add an archive: an ERF (including MOD, HAK, SAV and NWM), RIM, ZIP or HERF. */
+	void addArchive(const Common::UString &archiveFile, uint32 priority,
+	                const std::vector<byte> &password = std::vector<byte>());
+
+	/** Add all files within a directory, like the override directory. */
+	void addDirectory(const Common::UString &directory, uint32 priority, bool recursive = false);
+
+	/** Return the number of distinct resources. */
+	size_t getResourceCount() const;
+
+	/** Does a resource of this name and type exist? */
+	bool hasResource(const Common::UString &name, FileType type) const;
+
+	/** Find a resource of this name and type. Returns 0 if it doesn't exist. */
+	const Resource *findResource(const Common::UString &name, FileType type) const;
+
+	/** Collect all resources of this type. */
+	void getResources(FileType type, std::vector<const Resource *> &resources) const;
+
+	/** Return the contents of a resource of this name and type, or 0 if it doesn't exist. */
+	Common::SeekableReadStream *getResource(const Common::UString &name, FileType type) const;
+	/** Return the contents of a resource. */
+	Common::SeekableReadStream *getResource(const Resource &resource) const;
+
+private:
+	/** An archive the resources are read from. */
+	struct Source {
+		Common::UString   path;     ///< The archive file.
+		FileType          type;     ///< The type of the archive file.
+		std::vector<byte> password; ///< The password to open an encrypted ERF with.
+
+		Common::UString entryPath;     ///< The KEY or archive of the index cache entry.
+		Common::UString baseDirectory; ///< The base directory of the index cache entry.
+		size_t          dataFile;      ///< The BIF/BZF within a KEY entry, or SIZE_MAX.
+
+		Common::ScopedPtr<Archive> archive; ///< The archive, if it has been opened.
+
+		/** Guards reading from the archive, if it can't be read from concurrently. */
+		std::mutex mutex;
+
+		Source(const Common::UString &p, const std::vector<byte> &pw, const IndexCache::Entry &entry,
+		       size_t d = SIZE_MAX, Archive *a = 0);
+		~Source();
+	};
+
+	typedef std::pair<Common::UString, FileType> ResourceKey;
+
+	struct hashResourceKey {
+		size_t operator()(const ResourceKey &key) const;
+	};
+
+	typedef boost::unordered_map<ResourceKey, Resource, hashResourceKey> ResourceMap;
+
+	/** The files within a directory, by their lowercased file names. */
+	typedef std::map<Common::UString, Common::UString> DirectoryFiles;
+	/** The files within the directories of the BIFs/BZFs of a KEY, by their lowercased directory names. */
+	typedef std::map<Common::UString, DirectoryFiles> DirectoryMap;
+
+	Common::PtrVector<Source> _sources;
+	ResourceMap _resources;
+
+	/** The index cache. Archives opened lazily record their resource locations into it. */
+	mutable IndexCache _indexCache;
+
+	/** Guards the lazy opening of archives. */
+	mutable std::mutex _mutex;
+
+	void addResource(const Resource &resource);
+	void addIndexEntry(const IndexCache::Entry &entry, uint32 priority,
+	                   const std::vector<byte> &password = std::vector<byte>(), Archive *archive = 0);
+
+	Archive *getArchive(size_t source) const;
+	Archive *openSource(const Source &source) const;
+
+	static Common::UString findKEYDataFile(const Common::UString &baseDirectory, const Common::UString &dataFile,
+	                                       DirectoryMap &directories);
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_RESMAN_H
@@ -72,6 +72,7 @@ void RIMFile::load(Common::SeekableReadStream &rim) {
 		throw;
 	}
 
+	invalidateResourceIndex();
 }
 
 void RIMFile::readResList(Common::SeekableReadStream &rim, uint32 offset) {
@@ -109,11 +110,24 @@ Common::SeekableReadStream *RIMFile::getResource(uint32 index, bool tryNoCopy) c
 	const IResource &res = getIResource(index);
 
 	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_rim.get(), res.offset, res.offset + res.size);
+		return _rim->getSubStream(res.offset, res.offset + res.size);
 
-	_rim->seek(res.offset);
+	return _rim->readStreamAt(res.offset, res.size);
+}
+
+bool RIMFile::getResourceLocation(uint32 index, Location &location) const {
+	const IResource &res = getIResource(index);
+
+	location.offset     = res.offset;
+	location.packedSize = res.size;
+	location.size       = res.size;
+	location.packing    = kPackingNone;
+
+	return true;
+}
 
-	return _rim->readStream(res.size);
+bool RIMFile::canReadConcurrently() const {
+	return _rim->canReadAtConcurrently();
 }
 
 } // End of namespace Aurora
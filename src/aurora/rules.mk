@@ -44,6 +44,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/gff3writer.h \
     src/aurora/gff4file.h \
     src/aurora/gff4fields.h \
+    src/aurora/gffquery.h \
     src/aurora/talktable.h \
     src/aurora/talktable_tlk.h \
     src/aurora/talktable_gff.h \
@@ -64,6 +65,9 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/bifwriter.h \
     src/aurora/bzfwriter.h \
     src/aurora/rimwriter.h \
+    src/aurora/resman.h \
+    src/aurora/indexcache.h \
+    src/aurora/cachedarchive.h \
     $(EMPTY)
 
 src_aurora_libaurora_la_SOURCES += \
@@ -84,6 +88,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/gff3file.cpp \
     src/aurora/gff3writer.cpp \
     src/aurora/gff4file.cpp \
+    src/aurora/gffquery.cpp \
     src/aurora/talktable.cpp \
     src/aurora/talktable_tlk.cpp \
     src/aurora/talktable_gff.cpp \
@@ -103,4 +108,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/bifwriter.cpp \
     src/aurora/bzfwriter.cpp \
     src/aurora/rimwriter.cpp \
+    src/aurora/resman.cpp \
+    src/aurora/indexcache.cpp \
+    src/aurora/cachedarchive.cpp \
     $(EMPTY)
@@ -22,6 +22,8 @@
  *  Decompressing "small" files, Nintendo DS LZSS (types 0x00 and 0x10), found in Sonic.
  */
 
+#include <cstring>
+
 #include "src/common/scopedptr.h"
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
@@ -53,7 +55,7 @@ static void compress00(Common::ReadStream &in, Common::WriteStream &small, uint3
 	small.writeStream(in, size);
 }
 
-/* Simple LZSS 0x10 decompression.
+/* Simple LZSS 0x10 decompression, for streams we can't seek in.
  *
  * Code loosely based on DSDecmp by Barubary, released under the terms of the MIT license.
  *
@@ -118,127 +120,389 @@ static void decompress10(Common::ReadStream &small, Common::WriteStream &out, ui
 		throw Common::Exception("Invalid \"small\" data");
 }
 
-/** Determine the maximum size of an LZSS-compressed block.
- *
- *  Since this function supports continuously copying bytes from the "edge"
- *  of the current compression pointer (which is the main difference between
- *  LZSS and vanilla LZ77), both newPtr and oldPtr need to point into the
- *  same memory region.
+/* LZSS 0x10 decompression out of and into memory.
  *
- *  Takes O(newLength * oldLength) = O(n^2) time.
+ * Since the whole output is available, back-references can be copied
+ * straight out of the already decompressed data, without a ring buffer.
  *
- *  @param  newPtr The start of the data that needs to be compressed.
- *  @param  newLength The number of bytes that still need to be compressed.
- *  @param  oldPtr The start of the raw file.
- *  @param  oldLength The number of bytes already compressed.
- *  @param  displacement The offset of the start of the longest block to refer to.
- *  @param  minDisplacement The minimum allowed value for a valid displacement.
- *  @return The length of the longest sequence of bytes that can be copied from oldPtr.
+ * Returns the number of bytes of compressed data used.
  */
-size_t getOccurrenceLength(const byte *newPtr, size_t newLength,
-                           const byte *oldPtr, size_t oldLength,
-                           size_t &displacement, size_t minDisplacement = 1) {
-	displacement = 0;
-
-	// Can we actually do anything with the data?
-	if ((minDisplacement > oldLength) || (newLength == 0))
-		return 0;
-
-	size_t maxLength = 0;
-	for (size_t i = 0; i < oldLength - minDisplacement; i++) {
-		/* Try out every single possible displacement value, from the
-		 * start of the old data to the end. */
-
-		const byte *currentOldPtr = oldPtr + i;
-		size_t currentLength = 0;
-
-		/* Determine the length we can copy if we go back (oldLength - i) bytes.
-		 *  Always check the next newLength bytes, because we do LZSS. */
-		for (size_t j = 0; j < newLength; j++, currentLength++)
-			if (currentOldPtr[j] != newPtr[j])
-				break;
+static size_t decompress10(const byte *small, size_t smallSize, byte *out, size_t size) {
+	const byte *in    = small;
+	const byte *inEnd = small + smallSize;
 
-		if (currentLength > maxLength) {
-			// We've bettered our last try
-			maxLength = currentLength;
-			displacement = oldLength - i;
+	byte *outPos = out;
+	byte *outEnd = out + size;
 
-			// If we can't get any better than that, stop
-			if (maxLength == newLength)
-				break;
+	while (outPos < outEnd) {
+		// Read flags for the next 8 blocks
+		if (in == inEnd)
+			throw Common::Exception(Common::kReadError);
+
+		byte flags = *in++;
+
+		for (size_t block = 0; (block < 8) && (outPos < outEnd); block++, flags <<= 1) {
+			if (!(flags & 0x80)) {
+				// Literal byte
+
+				if (in == inEnd)
+					throw Common::Exception(Common::kReadError);
+
+				*outPos++ = *in++;
+				continue;
+			}
+
+			// Copy from the already decompressed data
+
+			if ((inEnd - in) < 2)
+				throw Common::Exception(Common::kReadError);
+
+			const byte data1 = *in++;
+			const byte data2 = *in++;
+
+			// Copy how many bytes from where (relative)?
+			const size_t length = (data1 >> 4) + 3;
+			const size_t offset = (((data1 & 0x0F) << 8) | data2) + 1;
+
+			if (offset > static_cast<size_t>(outPos - out))
+				throw Common::Exception("Tried to copy past the buffer");
+			if (length > static_cast<size_t>(outEnd - outPos))
+				throw Common::Exception("Invalid \"small\" data");
+
+			const byte *copy = outPos - offset;
+
+			if (offset >= length) {
+				std::memcpy(outPos, copy, length);
+				outPos += length;
+			} else {
+				// Overlapping copy, repeating the last offset bytes
+				for (size_t i = 0; i < length; i++)
+					*outPos++ = *copy++;
+			}
 		}
 	}
 
-	return maxLength;
+	return in - small;
 }
 
-/* Simple LZSS 0x10 compression.
+/** LZSS 0x10 decompression of a seekable stream into memory.
  *
- * Code loosely based on DSDecmp by Barubary, released under the terms of the MIT license.
+ *  The compressed data is used in-place if the stream is backed by memory,
+ *  otherwise it's read in one go. Afterwards, the stream is positioned
+ *  directly after the compressed data.
+ */
+static void decompress10(Common::SeekableReadStream &small, byte *out, uint32 size) {
+	const size_t start = small.pos();
+
+	// Even if there's nothing but literals, we need one flags byte for every 8 bytes
+	const size_t smallSize = MIN<size_t>(small.size() - start, size + (size + 7) / 8);
+
+	Common::ScopedArray<byte> buffer;
+
+	const byte *data = small.getData();
+	if (data) {
+		data += start;
+	} else {
+		buffer.reset(new byte[smallSize]);
+		if (small.read(buffer.get(), smallSize) != smallSize)
+			throw Common::Exception(Common::kReadError);
+
+		data = buffer.get();
+	}
+
+	const size_t smallUsed = decompress10(data, smallSize, out, size);
+
+	small.seek(start + smallUsed);
+}
+
+/** Finds earlier occurrences of data to compress with LZSS 0x10, using hash chains.
  *
- * See <https://github.com/gravgun/dsdecmp/blob/master/CSharp/DSDecmp/Formats/Nitro/LZ10.cs#L249>
- * and <https://code.google.com/p/dsdecmp/>.
+ *  Every position in the input is hashed by its next 3 bytes (the minimum
+ *  length worth copying). All earlier positions within the window with the
+ *  same hash are chained together, newest first, so that finding a match
+ *  only needs to look at positions that share at least the hash.
  */
-static void compress10(Common::ReadStream &in, Common::WriteStream &small, uint32 size) {
-	Common::ScopedArray<byte> inBuffer(new byte[size]);
-	if (in.read(inBuffer.get(), size) != size)
-		throw Common::Exception(Common::kReadError);
+class LZ10Matcher {
+public:
+	static const size_t kWindowSize = 0x1000; ///< Maximum displacement.
+	static const size_t kMinLength  = 3;      ///< Minimum length of a copy.
+	static const size_t kMaxLength  = 0x12;   ///< Maximum length of a copy.
 
-	// Buffer for 8 blocks (max. 2 bytes each), plus their flags byte
-	byte outBuffer[8 * 2 + 1] = { 0 };
-	size_t bufferedBlocks = 0, bufferLength = 1;
+	/** Minimum displacement. Copying from just 1 byte back breaks on the
+	 *  Nintendo DS when decompressing directly into VRAM. */
+	static const size_t kMinDisplacement = 2;
 
-	size_t inRead = 0;
-	while (inRead < size) {
-		// If 8 blocks have been buffered, write them and reset the buffer
-		if (bufferedBlocks == 8) {
-			if (small.write(outBuffer, bufferLength) != bufferLength)
-				throw Common::Exception(Common::kWriteError);
+	LZ10Matcher(const byte *data, size_t size, size_t maxChain) :
+		_data(data), _size(size), _maxChain(maxChain), _inserted(0) {
+
+		for (size_t i = 0; i < kHashSize; i++)
+			_head[i] = kNone;
+	}
+
+	/** Find the longest earlier occurrence of the data at this position.
+	 *
+	 *  All positions before this one have to be inserted already.
+	 *
+	 *  @param  pos          The position of the data to look for.
+	 *  @param  displacement The distance back to the start of the occurrence.
+	 *  @return The length of the longest occurrence, 0 if none was found.
+	 */
+	size_t find(size_t pos, size_t &displacement) const {
+		displacement = 0;
 
-			bufferedBlocks = 0;
-			bufferLength   = 1;
+		const size_t maxLength = MIN<size_t>(_size - pos, kMaxLength);
+		if (maxLength < kMinLength)
+			return 0;
 
-			outBuffer[0] = 0x00;
+		const byte *current = _data + pos;
+
+		size_t bestLength = 0;
+		size_t chain      = _maxChain;
+
+		for (size_t candidate = _head[hash(current)]; (candidate != kNone) && (chain > 0);
+		     candidate = _prev[candidate % kWindowSize]) {
+
+			const size_t distance = pos - candidate;
+			if (distance > kWindowSize)
+				break;
+
+			if (distance < kMinDisplacement)
+				continue;
+
+			chain--;
+
+			/* Check the byte that would make this one longer than the best one first.
+			 * Bytes after the current position might be compared, since LZSS allows
+			 * the copy to overlap with the data it produces. */
+			const byte *old = _data + candidate;
+			if (old[bestLength] != current[bestLength])
+				continue;
+
+			size_t length = 0;
+			while ((length < maxLength) && (old[length] == current[length]))
+				length++;
+
+			if (length > bestLength) {
+				bestLength   = length;
+				displacement = distance;
+
+				if (bestLength == maxLength)
+					break;
+			}
+		}
+
+		return (bestLength >= kMinLength) ? bestLength : 0;
+	}
+
+	/** Insert all positions up to (but not including) this one into the hash chains. */
+	void insertUntil(size_t pos) {
+		pos = MIN(pos, _size - MIN<size_t>(_size, kMinLength - 1));
+
+		for (; _inserted < pos; _inserted++) {
+			const uint32 h = hash(_data + _inserted);
+
+			_prev[_inserted % kWindowSize] = _head[h];
+			_head[h] = _inserted;
 		}
+	}
+
+private:
+	static const size_t kHashBits = 13;
+	static const size_t kHashSize = 1 << kHashBits;
+
+	static const size_t kNone = SIZE_MAX;
 
-		/* Look for duplications in the input data:
-		 * Try to find an occurrence of data starting from the current place in the
-		 * data within the last 0x1000 bytes bytes (the maximum displacement the
-		 * format supports) of the already compressed data, but only check the next
-		 * 0x12 bytes (the maximum copy length). */
+	const byte *_data;
+	const size_t _size;
+
+	const size_t _maxChain;
+
+	size_t _inserted; ///< Number of positions inserted into the chains.
+
+	size_t _head[kHashSize];   ///< Latest position for each hash.
+	size_t _prev[kWindowSize]; ///< Previous position with the same hash, per window slot.
+
+	static uint32 hash(const byte *data) {
+		const uint32 value = data[0] | (data[1] << 8) | (data[2] << 16);
+
+		return (value * 2654435761U) >> (32 - kHashBits);
+	}
+};
+
+/** Maximum number of positions to check for a match, per compression effort. */
+static const size_t kLZ10MaxChain[Small::kEffortMax + 1] = {
+	0, 1, 2, 4, 8, 16, 64, 256, 1024, LZ10Matcher::kWindowSize
+};
+
+/** Starting from this compression effort, only take a match if the next position doesn't have a better one. */
+static const int kLZ10LazyEffort = 4;
+/** Starting from this compression effort, find the smallest encoding of the whole data at once. */
+static const int kLZ10OptimalEffort = 7;
+
+/** Writes LZSS 0x10 blocks, in groups of 8 with a flags byte in front. */
+class LZ10BlockWriter {
+public:
+	LZ10BlockWriter(Common::WriteStream &small) : _small(small), _bufferedBlocks(0), _bufferLength(1) {
+		_buffer[0] = 0x00;
+	}
+
+	void writeLiteral(byte data) {
+		startBlock();
+
+		_buffer[_bufferLength++] = data;
+		_bufferedBlocks++;
+	}
+
+	void writeCopy(size_t length, size_t displacement) {
+		startBlock();
+
+		// Mark the block as compressed
+		_buffer[0] |= 1 << (7 - _bufferedBlocks);
+
+		_buffer[_bufferLength  ]  = ((length       - 3) << 4) & 0xF0;
+		_buffer[_bufferLength++] |= ((displacement - 1) >> 8) & 0x0F;
+		_buffer[_bufferLength++]  =  (displacement - 1)       & 0xFF;
+		_bufferedBlocks++;
+	}
+
+	/** Write the remaining blocks. */
+	void flush() {
+		if (_bufferedBlocks > 0)
+			if (_small.write(_buffer, _bufferLength) != _bufferLength)
+				throw Common::Exception(Common::kWriteError);
+
+		_bufferedBlocks = 0;
+		_bufferLength   = 1;
+
+		_buffer[0] = 0x00;
+	}
 
-		const size_t newLength = MIN<size_t>(size - inRead, 0x12);
-		const size_t oldLength = MIN<size_t>(inRead, 0x1000);
+private:
+	Common::WriteStream &_small;
+
+	// Buffer for 8 blocks (max. 2 bytes each), plus their flags byte
+	byte _buffer[8 * 2 + 1];
+	size_t _bufferedBlocks, _bufferLength;
+
+	void startBlock() {
+		// If 8 blocks have been buffered, write them and reset the buffer
+		if (_bufferedBlocks == 8)
+			flush();
+	}
+};
+
+/** Compress by taking the longest occurrence at each position, or with lazy
+ *  matching, only if the next position doesn't have an even longer one. */
+static void compress10Greedy(const byte *data, size_t size, LZ10Matcher &matcher,
+                             LZ10BlockWriter &writer, bool lazy) {
+
+	size_t pos = 0;
+	while (pos < size) {
+		matcher.insertUntil(pos);
 
 		size_t displacement = 0;
-		const size_t length =
-			getOccurrenceLength(inBuffer.get() + inRead            , newLength,
-			                    inBuffer.get() + inRead - oldLength, oldLength,
-			                    displacement);
+		size_t length = matcher.find(pos, displacement);
+
+		/* With lazy matching, a literal byte is written instead if the next
+		 * position has an even longer occurrence. That one is then taken
+		 * (or bettered again) in the next round. */
+		if (lazy && (length > 0) && (length < LZ10Matcher::kMaxLength)) {
+			matcher.insertUntil(pos + 1);
+
+			size_t nextDisplacement = 0;
+			if (matcher.find(pos + 1, nextDisplacement) > length)
+				length = 0;
+		}
 
 		/* If the length of the occurrence is at least 3 bytes, we safe space by
 		 * referring to the earlier place in the data. If it's shorter (or even
 		 * non-existent), then just encode the next byte literally. */
 
-		if (length >= 3) {
-			inRead += length;
+		if (length >= LZ10Matcher::kMinLength) {
+			writer.writeCopy(length, displacement);
+			pos += length;
+		} else
+			writer.writeLiteral(data[pos++]);
+	}
+}
+
+/** Compress into the smallest possible encoding, given the longest occurrence at each position.
+ *
+ *  Since a literal always costs 9 bits (including its flag) and a copy 17 bits,
+ *  working backwards from the end, we can find the cheapest way to encode the
+ *  rest of the data from each position. Any shorter copy of an occurrence is
+ *  possible as well, so all lengths are considered.
+ */
+static void compress10Optimal(const byte *data, size_t size, LZ10Matcher &matcher,
+                              LZ10BlockWriter &writer) {
 
-			// Mark the block as compressed
-			outBuffer[0] |= 1 << (7 - bufferedBlocks);
+	Common::ScopedArray<uint16> displacements(new uint16[size]);
+	Common::ScopedArray<byte>   lengths(new byte[size]);
 
-			outBuffer[bufferLength  ]  = ((length       - 3) << 4) & 0xF0;
-			outBuffer[bufferLength++] |= ((displacement - 1) >> 8) & 0x0F;
-			outBuffer[bufferLength++]  =  (displacement - 1)       & 0xFF;
-		} else
-			outBuffer[bufferLength++] = inBuffer[inRead++];
+	for (size_t pos = 0; pos < size; pos++) {
+		matcher.insertUntil(pos);
 
-		bufferedBlocks++;
+		size_t displacement = 0;
+		lengths[pos] = matcher.find(pos, displacement);
+		displacements[pos] = displacement;
 	}
 
-	// Write the remaining blocks
-	if (bufferedBlocks > 0)
-		if (small.write(outBuffer, bufferLength) != bufferLength)
-			throw Common::Exception(Common::kWriteError);
+	// Cost in bits of encoding everything from a position, and how long the first block there is
+	Common::ScopedArray<size_t> cost(new size_t[size + 1]);
+	Common::ScopedArray<byte>   step(new byte[size]);
+
+	cost[size] = 0;
+	for (size_t pos = size; pos-- > 0; ) {
+		cost[pos] = cost[pos + 1] + 9;
+		step[pos] = 1;
+
+		for (size_t length = LZ10Matcher::kMinLength; length <= lengths[pos]; length++) {
+			if ((cost[pos + length] + 17) < cost[pos]) {
+				cost[pos] = cost[pos + length] + 17;
+				step[pos] = length;
+			}
+		}
+	}
+
+	for (size_t pos = 0; pos < size; pos += step[pos]) {
+		if (step[pos] == 1)
+			writer.writeLiteral(data[pos]);
+		else
+			writer.writeCopy(step[pos], displacements[pos]);
+	}
+}
+
+/* LZSS 0x10 compression.
+ *
+ * The format is based on DSDecmp by Barubary, released under the terms of the MIT license.
+ *
+ * See <https://github.com/gravgun/dsdecmp/blob/master/CSharp/DSDecmp/Formats/Nitro/LZ10.cs#L249>
+ * and <https://code.google.com/p/dsdecmp/>.
+ */
+static void compress10(Common::ReadStream &in, Common::WriteStream &small, uint32 size, int effort) {
+	if ((effort < Small::kEffortMin) || (effort > Small::kEffortMax))
+		throw Common::Exception("Invalid compression effort %d", effort);
+
+	Common::ScopedArray<byte> inBuffer(new byte[size]);
+	if (in.read(inBuffer.get(), size) != size)
+		throw Common::Exception(Common::kReadError);
+
+	/* Look for duplications in the input data:
+	 * Try to find an occurrence of data starting from the current place in the
+	 * data within the last 0x1000 bytes bytes (the maximum displacement the
+	 * format supports) of the already compressed data, but only check the next
+	 * 0x12 bytes (the maximum copy length). */
+
+	Common::ScopedPtr<LZ10Matcher> matcher(new LZ10Matcher(inBuffer.get(), size, kLZ10MaxChain[effort]));
+
+	LZ10BlockWriter writer(small);
+
+	if (effort >= kLZ10OptimalEffort)
+		compress10Optimal(inBuffer.get(), size, *matcher, writer);
+	else
+		compress10Greedy(inBuffer.get(), size, *matcher, writer, effort >= kLZ10LazyEffort);
+
+	writer.flush();
 }
 
 static void decompress(Common::ReadStream &small, Common::WriteStream &out,
@@ -252,6 +516,20 @@ static void decompress(Common::ReadStream &small, Common::WriteStream &out,
 		throw Common::Exception("Unsupported type 0x%08X", (uint) type);
 }
 
+static byte *decompress(Common::SeekableReadStream &small, uint32 type, uint32 size) {
+	Common::ScopedArray<byte> out(new byte[size]);
+
+	if      (type == 0x00) {
+		if (small.read(out.get(), size) != size)
+			throw Common::Exception(Common::kReadError);
+	} else if (type == 0x10)
+		decompress10(small, out.get(), size);
+	else
+		throw Common::Exception("Unsupported type 0x%08X", (uint) type);
+
+	return out.release();
+}
+
 void Small::decompress(Common::ReadStream &small, Common::WriteStream &out) {
 	uint32 type, size;
 	readSmallHeader(small, type, size);
@@ -265,6 +543,22 @@ void Small::decompress(Common::ReadStream &small, Common::WriteStream &out) {
 
 }
 
+void Small::decompress(Common::SeekableReadStream &small, Common::WriteStream &out) {
+	uint32 type, size;
+	readSmallHeader(small, type, size);
+
+	try {
+		Common::ScopedArray<byte> data(::Aurora::decompress(small, type, size));
+
+		if (out.write(data.get(), size) != size)
+			throw Common::Exception(Common::kWriteError);
+
+	} catch (Common::Exception &e) {
+		e.add("Failed to decompress \"small\" file");
+		throw e;
+	}
+}
+
 Common::SeekableReadStream *Small::decompress(Common::SeekableReadStream *small) {
 	Common::ScopedPtr<Common::SeekableReadStream> in(small);
 
@@ -279,17 +573,32 @@ Common::SeekableReadStream *Small::decompress(Common::SeekableReadStream *small)
 		// Uncompressed. Just return a sub stream for the raw data
 		return new Common::SeekableSubReadStream(in.release(), pos, pos + size, true);
 
-	Common::MemoryWriteStreamDynamic out(true, size);
+	byte *data = 0;
 
 	try {
-		::Aurora::decompress(*in, out, type, size);
+		data = ::Aurora::decompress(*in, type, size);
 	} catch (Common::Exception &e) {
 		e.add("Failed to decompress \"small\" file");
 		throw e;
 	}
 
-	out.setDisposable(false);
-	return new Common::MemoryReadStream(out.getData(), out.size(), true);
+	return new Common::MemoryReadStream(data, size, true);
+}
+
+Common::SeekableReadStream *Small::decompress(Common::SeekableReadStream &small) {
+	uint32 type, size;
+	readSmallHeader(small, type, size);
+
+	byte *data = 0;
+
+	try {
+		data = ::Aurora::decompress(small, type, size);
+	} catch (Common::Exception &e) {
+		e.add("Failed to decompress \"small\" file");
+		throw e;
+	}
+
+	return new Common::MemoryReadStream(data, size, true);
 }
 
 Common::SeekableReadStream *Small::decompress(Common::ReadStream &small) {
@@ -325,13 +634,13 @@ void Small::compress00(Common::SeekableReadStream &in, Common::WriteStream &smal
 	::Aurora::compress00(in, small, size);
 }
 
-void Small::compress10(Common::SeekableReadStream &in, Common::WriteStream &small) {
+void Small::compress10(Common::SeekableReadStream &in, Common::WriteStream &small, int effort) {
 	const size_t size = in.size() - in.pos();
 	if (size >= 0xFFFFFF)
 		throw Common::Exception("Small::compress10(): Input stream too large");
 
 	writeSmallHeader(small, 0x10, size);
-	::Aurora::compress10(in, small, size);
+	::Aurora::compress10(in, small, size, effort);
 }
 
 } // End of namespace Aurora
@@ -35,10 +35,18 @@ namespace Aurora {
 
 class Small {
 public:
+	static const int kEffortMin     = 1; ///< Fastest, but worst, compression.
+	static const int kEffortDefault = 6; ///< Good compression at a reasonable speed.
+	static const int kEffortMax     = 9; ///< Best, but slowest, compression.
+
 	static void decompress(Common::ReadStream &small, Common::WriteStream &out);
+	/** Decompress this stream, using the fast in-memory decompressor. */
+	static void decompress(Common::SeekableReadStream &small, Common::WriteStream &out);
 
 	/** Decompress this stream into a new SeekableReadStream. */
 	static Common::SeekableReadStream *decompress(Common::ReadStream &small);
+	/** Decompress this stream into a new SeekableReadStream, using the fast in-memory decompressor. */
+	static Common::SeekableReadStream *decompress(Common::SeekableReadStream &small);
 	/** Take over this stream and decompress it into a new SeekableReadStream. */
 	static Common::SeekableReadStream *decompress(Common::ReadStream *small);
 
@@ -59,8 +67,13 @@ public:
 	 *
 	 *  Note that, depending on the input data, the result may be bigger
 	 *  that the input stream.
+	 *
+	 *  @param in     The data to compress.
+	 *  @param small  The stream to write the compressed small file into.
+	 *  @param effort How hard to look for data to compress, from kEffortMin to kEffortMax.
 	 */
-	static void compress10(Common::SeekableReadStream &in, Common::WriteStream &small);
+	static void compress10(Common::SeekableReadStream &in, Common::WriteStream &small,
+	                       int effort = kEffortDefault);
 };
 
 } // End of namespace Aurora
@@ -47,12 +47,13 @@ Common::SeekableReadStream *TheWitcherSaveFile::getResource(uint32 index, bool t
 	IResource resource = _resources[index];
 
 	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_tws.get(), resource.offset, resource.offset + resource.length);
-	else {
-		_tws->seek(resource.offset);
-		Common::SeekableReadStream *readStream = _tws->readStream(resource.length);
-		return readStream;
-	}
+		return _tws->getSubStream(resource.offset, resource.offset + resource.length);
+
+	return _tws->readStreamAt(resource.offset, resource.length);
+}
+
+bool TheWitcherSaveFile::canReadConcurrently() const {
+	return _tws->canReadAtConcurrently();
 }
 
 void TheWitcherSaveFile::load() {
@@ -120,6 +121,8 @@ void TheWitcherSaveFile::load() {
 		_resourceList.push_back(resource);
 		_resources[i] = iResource;
 	}
+
+	invalidateResourceIndex();
 }
 
 uint32 TheWitcherSaveFile::getResourceSize(uint32 index) const {
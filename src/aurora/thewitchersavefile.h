@@ -54,6 +54,9 @@ public:
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy = false) const;
 
+	/** Can getResource() be called from several threads at once? */
+	bool canReadConcurrently() const override;
+
 private:
 	void load();
 
@@ -524,32 +524,29 @@ FileType FileTypeManager::getFileType(Common::HashAlgo algo, uint64 hashedExtens
 }
 
 void FileTypeManager::buildExtensionLookup() {
-	if (!_extensionLookup.empty())
-		return;
-
-	for (size_t i = 0; i < ARRAYSIZE(types); i++)
-		_extensionLookup.insert(std::make_pair(Common::UString(types[i].extension), &types[i]));
+	std::call_once(_extensionLookupBuilt, [this]() {
+		for (size_t i = 0; i < ARRAYSIZE(types); i++)
+			_extensionLookup.insert(std::make_pair(Common::UString(types[i].extension), &types[i]));
+	});
 }
 
 void FileTypeManager::buildTypeLookup() {
-	if (!_typeLookup.empty())
-		return;
-
-	for (size_t i = 0; i < ARRAYSIZE(types); i++)
-		_typeLookup.insert(std::make_pair(types[i].type, &types[i]));
+	std::call_once(_typeLookupBuilt, [this]() {
+		for (size_t i = 0; i < ARRAYSIZE(types); i++)
+			_typeLookup.insert(std::make_pair(types[i].type, &types[i]));
+	});
 }
 
 void FileTypeManager::buildHashLookup(Common::HashAlgo algo) {
-	if (!_hashLookup[algo].empty())
-		return;
-
-	for (size_t i = 0; i < ARRAYSIZE(types); i++) {
-		const char *ext = types[i].extension;
-		if (ext[0] == '.')
-			ext++;
-
-		_hashLookup[algo].insert(std::make_pair(Common::hashString(ext, algo), &types[i]));
-	}
+	std::call_once(_hashLookupBuilt[algo], [this, algo]() {
+		for (size_t i = 0; i < ARRAYSIZE(types); i++) {
+			const char *ext = types[i].extension;
+			if (ext[0] == '.')
+				ext++;
+
+			_hashLookup[algo].insert(std::make_pair(Common::hashString(ext, algo), &types[i]));
+		}
+	});
 }
 
 Common::UString getPlatformDescription(Platform platform) {
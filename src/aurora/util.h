@@ -26,6 +26,7 @@
 #define AURORA_UTIL_H
 
 #include <map>
+#include <mutex>
 
 #include "src/common/singleton.h"
 #include "src/common/hash.h"
@@ -78,6 +79,11 @@ private:
 	TypeLookup      _typeLookup;
 	HashLookup      _hashLookup[Common::kHashMAX];
 
+	// The lookups are built on first use, which might happen in several threads at once
+	std::once_flag _extensionLookupBuilt;
+	std::once_flag _typeLookupBuilt;
+	std::once_flag _hashLookupBuilt[Common::kHashMAX];
+
 
 	void buildExtensionLookup();
 	void buildTypeLookup();
@@ -53,6 +53,14 @@ Common::SeekableReadStream *ZIPFile::getResource(uint32 index, bool tryNoCopy) c
 	return _zipFile->getFile(index, tryNoCopy);
 }
 
+Common::SeekableReadStream *ZIPFile::getResourceStreamed(uint32 index) const {
+	return _zipFile->getFileStreamed(index);
+}
+
+bool ZIPFile::canReadConcurrently() const {
+	return _zipFile->canReadConcurrently();
+}
+
 void ZIPFile::load() {
 	const Common::ZipFile::FileList &files = _zipFile->getFiles();
 	for (Common::ZipFile::FileList::const_iterator file = files.begin(); file != files.end(); ++file) {
@@ -64,6 +72,8 @@ void ZIPFile::load() {
 
 		_resources.push_back(res);
 	}
+
+	invalidateResourceIndex();
 }
 
 } // End of namespace Aurora
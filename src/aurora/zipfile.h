@@ -54,6 +54,12 @@ public:
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy = false) const;
 
+	/** Return a stream of the resource's contents, inflating large resources on demand. */
+	Common::SeekableReadStream *getResourceStreamed(uint32 index) const;
+
+	/** Can getResource() be called from several threads at once? */
+	bool canReadConcurrently() const;
+
 private:
 	/** The actual zip file. */
 	Common::ScopedPtr<Common::ZipFile> _zipFile;
@@ -49,6 +49,11 @@ class SeekableReadStream;
 void encodeBase64(ReadStream &data, UString &base64);
 /** Encode the binary stream data into a list of Base64 strings of at max lineLength characters. */
 void encodeBase64(ReadStream &data, std::list<UString> &base64, size_t lineLength);
+/** Encode size bytes of binary data into Base64 characters, returning the number of characters written.
+ *
+ *  base64 needs to have room for 4 characters for every 3 bytes of data, rounded up.
+ */
+size_t encodeBase64(const byte *data, size_t size, char *base64);
 
 /** Decode the Base64 string into binary data, returning a newly allocated stream. */
 SeekableReadStream *decodeBase64(const UString &base64);
@@ -378,4 +378,16 @@ MemoryReadStream *decryptBlowfishEBC(SeekableReadStream &input, const std::vecto
 	return blowfishEBC(input, key, kModeDecrypt);
 }
 
+void decryptBlowfishEBC(byte *data, size_t size, const std::vector<byte> &key) {
+	if ((size % kBlockSize) != 0)
+		throw Exception("Blowfish operates on blocks of 8 bytes (%u)", (uint) size);
+
+	BlowfishContext ctx;
+
+	blowfishSetKey(ctx, &key[0], key.size());
+
+	for (size_t i = 0; i < size; i += kBlockSize)
+		blowfishECB(ctx, kModeDecrypt, data + i, data + i);
+}
+
 } // End of namespace Common
@@ -39,6 +39,12 @@ MemoryReadStream *encryptBlowfishEBC(SeekableReadStream &input, const std::vecto
 /** Decrypt the stream with the Blowfish algorithm in EBC mode. */
 MemoryReadStream *decryptBlowfishEBC(SeekableReadStream &input, const std::vector<byte> &key);
 
+/** Decrypt the data in-place with the Blowfish algorithm in EBC mode.
+ *
+ *  The size has to be a multiple of the block size (8 bytes).
+ */
+void decryptBlowfishEBC(byte *data, size_t size, const std::vector<byte> &key);
+
 } // End of namespace Common
 
 #endif // COMMON_BLOWFISH_H
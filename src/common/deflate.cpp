@@ -22,6 +22,9 @@
  *  Compress (deflate) and decompress (inflate) using zlib's DEFLATE algorithm.
  */
 
+#include <cassert>
+#include <cstring>
+
 #include <zlib.h>
 
 #include <boost/scope_exit.hpp>
@@ -60,7 +63,7 @@ static void initInflateZStream(z_stream &strm, int windowBits, size_t size, cons
 		throw Exception("Could not initialize zlib inflate: %s (%d)", zError(zResult), zResult);
 }
 
-static void initDeflateZStream(z_stream &strm, int windowBits, size_t size, const byte *data) {
+static void initDeflateZStream(z_stream &strm, int windowBits, int level, size_t size, const byte *data) {
 	/* Initialize the zlib data stream for compression with our input data. */
 
 	strm.zalloc   = Z_NULL;
@@ -71,7 +74,7 @@ static void initDeflateZStream(z_stream &strm, int windowBits, size_t size, cons
 
 	int zResult = deflateInit2(
 			&strm,
-			Z_BEST_COMPRESSION,
+			level,
 			Z_DEFLATED,
 			windowBits,
 			9,
@@ -225,13 +228,18 @@ size_t decompressDeflateChunk(SeekableReadStream &input, int windowBits,
 	return strm.total_out;
 }
 
-byte *compressDeflate(const byte *data, size_t inputSize, size_t &outputSize, int windowBits, unsigned int frameSize) {
+byte *compressDeflate(const byte *data, size_t inputSize, size_t &outputSize, int windowBits,
+                      unsigned int frameSize, int level) {
+
+	if ((level < kCompressionLevelMin) || (level > kCompressionLevelMax))
+		throw Exception("Invalid deflate compression level %d", level);
+
 	z_stream strm;
 	BOOST_SCOPE_EXIT( (&strm) ) {
 		deflateEnd(&strm);
 	} BOOST_SCOPE_EXIT_END
 
-	initDeflateZStream(strm, windowBits, inputSize, data);
+	initDeflateZStream(strm, windowBits, level, inputSize, data);
 
 	Common::PtrVector<byte, Common::DeallocatorArray> buffers;
 
@@ -247,30 +255,214 @@ byte *compressDeflate(const byte *data, size_t inputSize, size_t &outputSize, in
 		zResult = deflate(&strm, Z_FINISH);
 		if (zResult != Z_STREAM_END && zResult != Z_OK)
 			throw Exception("Failed to deflate: %s (%d)", zError(zResult), zResult);
-	} while (strm.avail_in != 0);
+	} while (zResult != Z_STREAM_END);
 
 	ScopedArray<byte> compressedData(new byte[strm.total_out]);
-	for (size_t i = 0; i < buffers.size(); ++i) {
-		if (i == buffers.size() - 1)
-			std::memcpy(compressedData.get() + i * frameSize, buffers[i], strm.total_out % frameSize);
-		else
-			std::memcpy(compressedData.get() + i * frameSize, buffers[i], frameSize);
-	}
+	for (size_t i = 0; i < buffers.size(); ++i)
+		std::memcpy(compressedData.get() + i * frameSize, buffers[i],
+		            MIN<size_t>(frameSize, strm.total_out - i * frameSize));
 
 	outputSize = strm.total_out;
 
 	return compressedData.release();
 }
 
-SeekableReadStream *compressDeflate(ReadStream &input, size_t inputSize, int windowBits, unsigned int frameSize) {
+SeekableReadStream *compressDeflate(ReadStream &input, size_t inputSize, int windowBits,
+                                    unsigned int frameSize, int level) {
 	ScopedArray<byte> uncompressedData(new byte[inputSize]);
 	if (input.read(uncompressedData.get(), inputSize) != inputSize)
 		throw Exception(kReadError);
 
 	size_t size = 0;
-	byte *decompressedData = compressDeflate(uncompressedData.get(), inputSize, size, windowBits, frameSize);
+	byte *compressedData = compressDeflate(uncompressedData.get(), inputSize, size, windowBits, frameSize, level);
 
-	return new MemoryReadStream(decompressedData, size, true);
+	return new MemoryReadStream(compressedData, size, true);
+}
+
+/** Size of the buffer the compressed input of an InflateReadStream is read into. */
+static const size_t kInflateInputBufferSize = 16 * 1024;
+
+struct InflateReadStream::State {
+	z_stream strm;
+
+	size_t inputPos;  ///< Position within the input of the next byte to inflate.
+	size_t outputPos; ///< Position within the decompressed data.
+
+	State() : inputPos(0), outputPos(0) {
+		std::memset(&strm, 0, sizeof(strm));
+	}
+
+	~State() {
+		inflateEnd(&strm);
+	}
+};
+
+InflateReadStream::InflateReadStream(SeekableReadStream *input, bool disposeInput, size_t outputSize,
+                                     int windowBits, bool concatenated, size_t checkpointInterval) :
+	_input(input, disposeInput), _size(outputSize), _pos(0), _eos(false), _windowBits(windowBits),
+	_concatenated(concatenated), _checkpointInterval(checkpointInterval),
+	_inputBuffer(new byte[kInflateInputBufferSize]), _inputPos(0) {
+
+	assert(_input);
+
+	_state.reset(new State);
+	initInflateZStream(_state->strm, _windowBits, 0, 0);
+}
+
+InflateReadStream::~InflateReadStream() {
+	for (std::vector<State *>::iterator c = _checkpoints.begin(); c != _checkpoints.end(); ++c)
+		delete *c;
+}
+
+void InflateReadStream::reset() {
+	int zResult = inflateReset(&_state->strm);
+	if (zResult != Z_OK)
+		throw Exception("Failed to reset inflate: %s (%d)", zError(zResult), zResult);
+
+	setZStreamInput(_state->strm, 0, 0);
+
+	_inputPos = 0;
+	_pos      = 0;
+}
+
+void InflateReadStream::restore(const State &checkpoint) {
+	ScopedPtr<State> state(new State);
+
+	int zResult = inflateCopy(&state->strm, const_cast<z_stream *>(&checkpoint.strm));
+	if (zResult != Z_OK)
+		throw Exception("Failed to restore inflate state: %s (%d)", zError(zResult), zResult);
+
+	_state.reset(state.release());
+
+	_inputPos = checkpoint.inputPos;
+	_pos      = checkpoint.outputPos;
+}
+
+void InflateReadStream::addCheckpoint() {
+	ScopedPtr<State> checkpoint(new State);
+
+	int zResult = inflateCopy(&checkpoint->strm, &_state->strm);
+	if (zResult != Z_OK)
+		throw Exception("Failed to save inflate state: %s (%d)", zError(zResult), zResult);
+
+	// The checkpoint doesn't own the input buffer, it continues with the first byte not yet inflated
+	setZStreamInput(checkpoint->strm, 0, 0);
+
+	checkpoint->inputPos  = _inputPos - _state->strm.avail_in;
+	checkpoint->outputPos = _pos;
+
+	_checkpoints.push_back(checkpoint.release());
+}
+
+void InflateReadStream::inflateData(byte *data, size_t size) {
+	z_stream &strm = _state->strm;
+
+	while (size > 0) {
+		size_t chunkSize = size;
+
+		// Stop at the next checkpoint, if we haven't saved that one yet
+		const size_t nextCheckpoint = (_checkpoints.size() + 1) * _checkpointInterval;
+		if ((_checkpointInterval > 0) && (_pos < nextCheckpoint))
+			chunkSize = MIN(chunkSize, nextCheckpoint - _pos);
+
+		if (strm.avail_in == 0) {
+			const size_t inputSize = _input->readAt(_inputPos, _inputBuffer.get(), kInflateInputBufferSize);
+
+			setZStreamInput(strm, inputSize, _inputBuffer.get());
+			_inputPos += inputSize;
+		}
+
+		const bool inputEmpty = strm.avail_in == 0;
+
+		strm.avail_out = chunkSize;
+		strm.next_out  = data;
+
+		const int zResult = inflate(&strm, Z_NO_FLUSH);
+
+		const size_t inflated = chunkSize - strm.avail_out;
+
+		data += inflated;
+		size -= inflated;
+		_pos += inflated;
+
+		if ((_checkpointInterval > 0) && (_pos == nextCheckpoint))
+			addCheckpoint();
+
+		if (zResult == Z_STREAM_END) {
+			if (size == 0)
+				break;
+
+			if (!_concatenated)
+				throw Exception("Failed to inflate: premature end of input stream");
+
+			// Continue with the next DEFLATE stream
+			int zResetResult = inflateReset(&strm);
+			if (zResetResult != Z_OK)
+				throw Exception("Failed to reset inflate: %s (%d)", zError(zResetResult), zResetResult);
+
+			continue;
+		}
+
+		if ((zResult == Z_BUF_ERROR) && inputEmpty)
+			throw Exception("Failed to inflate: input buffer empty, stream not ended");
+
+		if ((zResult != Z_OK) && (zResult != Z_BUF_ERROR))
+			throw Exception("Failed to inflate: %s (%d)", zError(zResult), zResult);
+	}
+}
+
+size_t InflateReadStream::read(void *dataPtr, size_t dataSize) {
+	assert(_pos <= _size);
+
+	if (dataSize > (_size - _pos)) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+
+	if (dataSize > 0) {
+		assert(dataPtr);
+		inflateData(static_cast<byte *>(dataPtr), dataSize);
+	}
+
+	return dataSize;
+}
+
+bool InflateReadStream::eos() const {
+	return _eos;
+}
+
+size_t InflateReadStream::pos() const {
+	return _pos;
+}
+
+size_t InflateReadStream::size() const {
+	return _size;
+}
+
+size_t InflateReadStream::seek(ptrdiff_t offset, Origin whence) {
+	const size_t oldPos = _pos;
+	const size_t newPos = evalSeek(offset, whence, _pos, 0, _size);
+	if (newPos > _size)
+		throw Exception(kSeekError);
+
+	if (newPos < _pos) {
+		// Restart from the last checkpoint before the new position
+		const size_t checkpoint = (_checkpointInterval > 0) ?
+			MIN(newPos / _checkpointInterval, _checkpoints.size()) : 0;
+
+		if (checkpoint == 0)
+			reset();
+		else
+			restore(*_checkpoints[checkpoint - 1]);
+	}
+
+	byte skipBuffer[4096];
+	while (_pos < newPos)
+		inflateData(skipBuffer, MIN<size_t>(sizeof(skipBuffer), newPos - _pos));
+
+	_eos = false;
+
+	return oldPos;
 }
 
 } // End of namespace Common
@@ -25,7 +25,14 @@
 #ifndef COMMON_DEFLATE_H
 #define COMMON_DEFLATE_H
 
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
 #include "src/common/types.h"
+#include "src/common/scopedptr.h"
+#include "src/common/disposableptr.h"
+#include "src/common/readstream.h"
 
 namespace Common {
 
@@ -35,12 +42,13 @@ namespace Common {
  *   of the decompressed data beforehand
  */
 
-class ReadStream;
-class SeekableReadStream;
-
 static const int kWindowBitsMax    =  15;
 static const int kWindowBitsMaxRaw = -kWindowBitsMax;
 
+static const int kCompressionLevelMin     = 0; ///< No compression at all, only store.
+static const int kCompressionLevelFastest = 1; ///< Fastest compression.
+static const int kCompressionLevelMax     = 9; ///< Best, but slowest, compression.
+
 /** Decompress (inflate) using zlib's DEFLATE algorithm.
  *
  *  @param  data       The compressed input data.
@@ -125,10 +133,11 @@ size_t decompressDeflateChunk(SeekableReadStream &input, int windowBits, byte *o
  *                    the history buffer). See the zlib documentation on
  *                    deflateInit2() for details.
  *  @param frameSize  The size of a frame for reading from the input stream.
+ *  @param level      The compression level, from kCompressionLevelMin to kCompressionLevelMax.
  *  @return A stream of compressed data.
  */
 SeekableReadStream *compressDeflate(ReadStream &input, size_t inputSize, int windowBits,
-                                    unsigned int frameSize = 4096);
+                                    unsigned int frameSize = 4096, int level = kCompressionLevelMax);
 
 /** Compress (deflate) using zlib's DEFLATE algorithm.
  *
@@ -139,10 +148,84 @@ SeekableReadStream *compressDeflate(ReadStream &input, size_t inputSize, int win
  *                    the history buffer). See the zlib documentation on
  *                    deflateInit2() for details.
  *  @param frameSize  The size of a frame for reading from the input stream.
+ *  @param level      The compression level, from kCompressionLevelMin to kCompressionLevelMax.
  *  @return A stream of compressed data.
  */
 byte *compressDeflate(const byte *data, size_t inputSize, size_t &outputSize, int windowBits,
-                      unsigned int frameSize = 4096);
+                      unsigned int frameSize = 4096, int level = kCompressionLevelMax);
+
+/** Decompressed resources of at least this size are best inflated with an InflateReadStream. */
+static const size_t kInflateStreamThreshold = 1024 * 1024;
+
+/** A stream that decompresses (inflates) DEFLATE data incrementally, while it is read.
+ *
+ *  Only as much data is inflated as has been read so far, so even huge
+ *  resources can be read in constant memory. Seeking forward inflates and
+ *  throws away the data in between. For seeking backward, the state of the
+ *  decompressor is saved at regular checkpoints, from which inflating can
+ *  then be restarted.
+ *
+ *  Several DEFLATE streams directly following each other, like the chunks
+ *  of a file in an OBB, can be read as one concatenated stream.
+ */
+class InflateReadStream : boost::noncopyable, public SeekableReadStream {
+public:
+	/** Create an InflateReadStream.
+	 *
+	 *  @param input        The compressed input data.
+	 *  @param disposeInput Should the input stream be deleted together with this stream?
+	 *  @param outputSize   The size of the decompressed data.
+	 *  @param windowBits   The base two logarithm of the window size (the size of
+	 *                      the history buffer). See the zlib documentation on
+	 *                      inflateInit2() for details.
+	 *  @param concatenated Does the input consist of several DEFLATE streams in a row?
+	 *  @param checkpointInterval Number of decompressed bytes between two checkpoints.
+	 *                      0 means no checkpoints, every backward seek restarts from
+	 *                      the beginning of the input.
+	 */
+	InflateReadStream(SeekableReadStream *input, bool disposeInput, size_t outputSize, int windowBits,
+	                  bool concatenated = false, size_t checkpointInterval = 4 * 1024 * 1024);
+	~InflateReadStream();
+
+	size_t read(void *dataPtr, size_t dataSize);
+
+	bool eos() const;
+
+	size_t pos() const;
+	size_t size() const;
+
+	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
+
+private:
+	/** A state of the decompressor. */
+	struct State;
+
+	DisposablePtr<SeekableReadStream> _input;
+
+	size_t _size;
+	size_t _pos;
+	bool   _eos;
+
+	int  _windowBits;
+	bool _concatenated;
+
+	size_t _checkpointInterval;
+
+	ScopedPtr<State> _state; ///< The current state of the decompressor.
+
+	/** Saved states at every checkpointInterval bytes of output, starting with the first one. */
+	std::vector<State *> _checkpoints;
+
+	ScopedArray<byte> _inputBuffer;
+	size_t _inputPos; ///< Position within the input of the first byte not yet in the input buffer.
+
+	void reset();
+	void restore(const State &checkpoint);
+	void addCheckpoint();
+
+	/** Inflate exactly this many bytes, starting at the current position. */
+	void inflateData(byte *data, size_t size);
+};
 
 } // End of namespace Common
 
@@ -57,25 +57,25 @@ static const size_t kTerminatorLength  [kEncodingMAX] = {
 	1, 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1
 };
 
-/** A manager handling string encoding conversions. */
-class ConversionManager : public Singleton<ConversionManager> {
+/** The iconv contexts of one thread.
+ *
+ *  An iconv context holds the conversion state, so only one conversion can
+ *  run through it at a time. Instead of serializing all conversions, every
+ *  thread converts with its own contexts, opened the first time it needs them.
+ */
+class ConversionContexts {
 public:
-	ConversionManager() {
+	ConversionContexts() {
 		for (size_t i = 0; i < kEncodingMAX; i++) {
 			_contextFrom[i] = (iconv_t) -1;
 			_contextTo  [i] = (iconv_t) -1;
-		}
-
-		for (size_t i = 0; i < kEncodingMAX; i++)
-			if ((_contextFrom[i] = iconv_open("UTF-8", kEncodingName[i])) == ((iconv_t) -1))
-				warning("Failed to initialize %s -> UTF-8 conversion: %s", kEncodingName[i], strerror(errno));
 
-		for (size_t i = 0; i < kEncodingMAX; i++)
-			if ((_contextTo  [i] = iconv_open(kEncodingName[i], "UTF-8")) == ((iconv_t) -1))
-				warning("Failed to initialize UTF-8 -> %s conversion: %s", kEncodingName[i], strerror(errno));
+			_openedFrom[i] = false;
+			_openedTo  [i] = false;
+		}
 	}
 
-	~ConversionManager() {
+	~ConversionContexts() {
 		for (size_t i = 0; i < kEncodingMAX; i++) {
 			if (_contextFrom[i] != ((iconv_t) -1))
 				iconv_close(_contextFrom[i]);
@@ -84,16 +84,81 @@ public:
 		}
 	}
 
+	/** Return the context converting from this encoding into UTF-8. */
+	iconv_t &getFrom(Encoding encoding) {
+		if (!_openedFrom[encoding]) {
+			_contextFrom[encoding] = iconv_open("UTF-8", kEncodingName[encoding]);
+			_openedFrom [encoding] = true;
+		}
+
+		return _contextFrom[encoding];
+	}
+
+	/** Return the context converting from UTF-8 into this encoding. */
+	iconv_t &getTo(Encoding encoding) {
+		if (!_openedTo[encoding]) {
+			_contextTo[encoding] = iconv_open(kEncodingName[encoding], "UTF-8");
+			_openedTo [encoding] = true;
+		}
+
+		return _contextTo[encoding];
+	}
+
+	/** Return the contexts of the calling thread. */
+	static ConversionContexts &getThreadContexts() {
+		static thread_local ConversionContexts contexts;
+
+		return contexts;
+	}
+
+private:
+	iconv_t _contextFrom[kEncodingMAX];
+	iconv_t _contextTo  [kEncodingMAX];
+
+	bool _openedFrom[kEncodingMAX];
+	bool _openedTo  [kEncodingMAX];
+};
+
+/** A manager handling string encoding conversions. */
+class ConversionManager : public Singleton<ConversionManager> {
+public:
+	ConversionManager() {
+		// Find out which conversions are supported, warning once about those that aren't
+
+		for (size_t i = 0; i < kEncodingMAX; i++) {
+			iconv_t ctx = iconv_open("UTF-8", kEncodingName[i]);
+
+			_supportFrom[i] = ctx != ((iconv_t) -1);
+			if (_supportFrom[i])
+				iconv_close(ctx);
+			else
+				warning("Failed to initialize %s -> UTF-8 conversion: %s", kEncodingName[i], strerror(errno));
+		}
+
+		for (size_t i = 0; i < kEncodingMAX; i++) {
+			iconv_t ctx = iconv_open(kEncodingName[i], "UTF-8");
+
+			_supportTo[i] = ctx != ((iconv_t) -1);
+			if (_supportTo[i])
+				iconv_close(ctx);
+			else
+				warning("Failed to initialize UTF-8 -> %s conversion: %s", kEncodingName[i], strerror(errno));
+		}
+	}
+
+	~ConversionManager() {
+	}
+
 	bool hasSupportTranscode(Encoding from, Encoding to) {
 		if ((((size_t) from) >= kEncodingMAX) ||
 		    (((size_t) to  ) >= kEncodingMAX))
 			return false;
 
 		if (from == kEncodingUTF8)
-			return _contextTo[to] != ((iconv_t) -1);
+			return _supportTo[to];
 
 		if (to == kEncodingUTF8)
-			return _contextFrom[from] != ((iconv_t) -1);
+			return _supportFrom[from];
 
 		return false;
 	}
@@ -102,20 +167,27 @@ public:
 		if (((size_t) encoding) >= kEncodingMAX)
 			throw Exception("Invalid encoding %d", encoding);
 
-		return convert(_contextFrom[encoding], data, n, kEncodingGrowthFrom[encoding], 1);
+		if (!_supportFrom[encoding])
+			return "[!!!]";
+
+		return convert(ConversionContexts::getThreadContexts().getFrom(encoding), data, n,
+		               kEncodingGrowthFrom[encoding], 1);
 	}
 
 	MemoryReadStream *convert(Encoding encoding, const UString &str, bool terminate = true) {
 		if (((size_t) encoding) >= kEncodingMAX)
 			throw Exception("Invalid encoding %d", encoding);
 
-		return convert(_contextTo[encoding], str, kEncodingGrowthTo[encoding],
+		if (!_supportTo[encoding])
+			return 0;
+
+		return convert(ConversionContexts::getThreadContexts().getTo(encoding), str, kEncodingGrowthTo[encoding],
 		               terminate ? kTerminatorLength[encoding] : 0);
 	}
 
 private:
-	iconv_t _contextFrom[kEncodingMAX];
-	iconv_t _contextTo  [kEncodingMAX];
+	bool _supportFrom[kEncodingMAX];
+	bool _supportTo  [kEncodingMAX];
 
 	byte *doConvert(iconv_t &ctx, byte *data, size_t nIn, size_t nOut, size_t &size) {
 		size_t inBytes  = nIn;
@@ -22,6 +22,7 @@
  *  Utility class for manipulating file paths.
  */
 
+#include <ctime>
 #include <list>
 #include <regex>
 
@@ -41,6 +42,7 @@ using boost::filesystem::is_regular_file;
 using boost::filesystem::is_directory;
 using boost::filesystem::file_size;
 using boost::filesystem::directory_iterator;
+using boost::filesystem::recursive_directory_iterator;
 using boost::filesystem::create_directories;
 
 // boost-string_algo
@@ -78,6 +80,14 @@ size_t FilePath::getFileSize(const UString &p) {
 	return size;
 }
 
+uint64 FilePath::getModificationTime(const UString &p) {
+	uint64 time = 0;
+	if (!Platform::getModificationTime(p, time))
+		return 0;
+
+	return time;
+}
+
 UString FilePath::getFile(const UString &p) {
 	path file(p.c_str());
 
@@ -250,6 +260,29 @@ bool FilePath::getSubDirectories(const UString &directory, std::list<UString> &s
 	return true;
 }
 
+bool FilePath::getFiles(const UString &directory, std::list<UString> &files, bool recursive) {
+	path dirPath(directory.c_str());
+
+	try {
+		if (recursive) {
+			recursive_directory_iterator itEnd;
+			for (recursive_directory_iterator itDir(dirPath); itDir != itEnd; ++itDir)
+				if (is_regular_file(itDir->status()))
+					files.push_back(itDir->path().generic_string());
+
+		} else {
+			directory_iterator itEnd;
+			for (directory_iterator itDir(dirPath); itDir != itEnd; ++itDir)
+				if (is_regular_file(itDir->status()))
+					files.push_back(itDir->path().generic_string());
+		}
+	} catch (...) {
+		return false;
+	}
+
+	return true;
+}
+
 static void splitDirectories(const UString &directory, std::list<UString> &dirs) {
 	UString curDir;
 
@@ -58,6 +58,13 @@ public:
 	 */
 	static size_t getFileSize(const UString &p);
 
+	/** Return a file's last modification time.
+	 *
+	 *  @param  p The file to look up.
+	 *  @return The modification time in nanoseconds since the epoch, or 0 if not a valid file.
+	 */
+	static uint64 getModificationTime(const UString &p);
+
 	/** Return a file name without its path.
 	 *
 	 *  Example: "/path/to/file.ext" > "file.ext"
@@ -191,6 +198,16 @@ public:
 	 */
 	static bool getSubDirectories(const UString &directory, std::list<UString> &subDirectories);
 
+	/** Collect all regular files within a directory in a list.
+	 *
+	 *  @param  directory The directory in which to look.
+	 *  @param  files The list to add the files to.
+	 *  @param  recursive Also collect the files within all subdirectories?
+	 *  @return false if the specified path was not a directory or could not be searched;
+	 *          true otherwise.
+	 */
+	static bool getFiles(const UString &directory, std::list<UString> &files, bool recursive = false);
+
 	/** Create all directories in this path.
 	 *
 	 *  For example, if called on the path "/foo/bar/quux/", this will create
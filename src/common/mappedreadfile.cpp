@@ -0,0 +1,166 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Implementing the stream reading interfaces for memory-mapped files.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "src/common/mappedreadfile.h"
+#include "src/common/readfile.h"
+#include "src/common/scopedptr.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/ustring.h"
+#include "src/common/platform.h"
+
+namespace Common {
+
+MappedReadFile::MappedReadFile() : _data(0), _size(kSizeInvalid), _pos(0), _isOpen(false), _eos(false) {
+}
+
+MappedReadFile::MappedReadFile(const UString &fileName) :
+	_data(0), _size(kSizeInvalid), _pos(0), _isOpen(false), _eos(false) {
+
+	if (!open(fileName))
+		throw Exception("Can't open file \"%s\"", fileName.c_str());
+}
+
+MappedReadFile::~MappedReadFile() {
+	close();
+}
+
+bool MappedReadFile::open(const UString &fileName) {
+	close();
+
+	size_t fileSize = 0;
+	if (!Platform::mapFile(fileName, _data, fileSize)) {
+		close();
+		return false;
+	}
+
+	_size   = fileSize;
+	_pos    = 0;
+	_isOpen = true;
+	_eos    = false;
+
+	return true;
+}
+
+void MappedReadFile::close() {
+	if (_isOpen)
+		Platform::unmapFile(_data, _size);
+
+	_data   = 0;
+	_size   = kSizeInvalid;
+	_pos    = 0;
+	_isOpen = false;
+	_eos    = false;
+}
+
+bool MappedReadFile::isOpen() const {
+	return _isOpen;
+}
+
+bool MappedReadFile::eos() const {
+	if (!_isOpen)
+		return true;
+
+	return _eos;
+}
+
+size_t MappedReadFile::pos() const {
+	if (!_isOpen)
+		return kPositionInvalid;
+
+	return _pos;
+}
+
+size_t MappedReadFile::size() const {
+	return _size;
+}
+
+size_t MappedReadFile::seek(ptrdiff_t offset, Origin whence) {
+	if (!_isOpen)
+		throw Exception(kSeekError);
+
+	const size_t oldPos = _pos;
+	const size_t newPos = evalSeek(offset, whence, _pos, 0, _size);
+	if (newPos > _size)
+		throw Exception(kSeekError);
+
+	_pos = newPos;
+	_eos = false;
+
+	return oldPos;
+}
+
+size_t MappedReadFile::read(void *dataPtr, size_t dataSize) {
+	if (!_isOpen)
+		return 0;
+
+	assert(dataPtr);
+
+	if (dataSize > (_size - _pos)) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+
+	if (dataSize > 0)
+		std::memcpy(dataPtr, _data + _pos, dataSize);
+
+	_pos += dataSize;
+
+	return dataSize;
+}
+
+size_t MappedReadFile::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (!_isOpen || (offset > _size))
+		return 0;
+
+	dataSize = MIN(dataSize, _size - offset);
+	if (dataSize > 0) {
+		assert(dataPtr);
+		std::memcpy(dataPtr, _data + offset, dataSize);
+	}
+
+	return dataSize;
+}
+
+bool MappedReadFile::canReadAtConcurrently() const {
+	return true;
+}
+
+const byte *MappedReadFile::getData() const {
+	return _data;
+}
+
+
+SeekableReadStream *mapOrReadFile(const UString &fileName) {
+	ScopedPtr<MappedReadFile> mapped(new MappedReadFile);
+	if (mapped->open(fileName))
+		return mapped.release();
+
+	return new ReadFile(fileName);
+}
+
+} // End of namespace Common
@@ -0,0 +1,103 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Implementing the stream reading interfaces for memory-mapped files.
+ */
+
+#ifndef COMMON_MAPPEDREADFILE_H
+#define COMMON_MAPPEDREADFILE_H
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/readstream.h"
+
+namespace Common {
+
+class UString;
+
+/** A file reading class that maps the whole file read-only into memory.
+ *
+ *  Reading and seeking never touches stdio. Instead, the file contents
+ *  are accessed directly through the mapping, which also allows callers
+ *  to get at the raw file data via getData() without copying it.
+ */
+class MappedReadFile : boost::noncopyable, public SeekableReadStream {
+public:
+	MappedReadFile();
+	MappedReadFile(const UString &fileName);
+	~MappedReadFile();
+
+	/** Try to map the file with the given fileName.
+	 *
+	 *  @param  fileName the name of the file to map.
+	 *  @return true if file was mapped successfully, false otherwise.
+	 */
+	bool open(const UString &fileName);
+
+	/** Unmap the file, if mapped. */
+	void close();
+
+	/** Checks if the object mapped a file successfully.
+	 *
+	 *  @return true if any file is mapped, false otherwise.
+	 */
+	bool isOpen() const;
+
+	bool eos() const;
+
+	size_t pos() const;
+	size_t size() const;
+
+	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
+	size_t read(void *dataPtr, size_t dataSize);
+
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+	bool canReadAtConcurrently() const;
+
+	/** Return a pointer to the mapped contents of the file.
+	 *
+	 *  The pointer is only valid as long as the file stays open.
+	 */
+	const byte *getData() const;
+
+
+private:
+	const byte *_data; ///< The mapped file contents.
+	size_t _size;      ///< The file's size.
+
+	size_t _pos;
+
+	bool _isOpen;
+	bool _eos;
+};
+
+/** Open a file for reading, mapping it into memory if possible.
+ *
+ *  Files that can't be mapped (like pipes and other special files, files
+ *  too large for the address space, or any file on platforms without
+ *  memory mapping support) are read through a ReadFile instead.
+ */
+SeekableReadStream *mapOrReadFile(const UString &fileName);
+
+} // End of namespace Common
+
+#endif // COMMON_MAPPEDREADFILE_H
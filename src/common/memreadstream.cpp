@@ -89,6 +89,19 @@ size_t MemoryReadStream::seek(ptrdiff_t offset, Origin whence) {
 	return oldPos;
 }
 
+size_t MemoryReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (offset > _size)
+		return 0;
+
+	dataSize = MIN(dataSize, _size - offset);
+	if (dataSize > 0) {
+		assert(dataPtr);
+		std::memcpy(dataPtr, _ptrOrig.get() + offset, dataSize);
+	}
+
+	return dataSize;
+}
+
 bool MemoryReadStream::eos() const {
 	return _eos;
 }
@@ -101,6 +114,10 @@ size_t MemoryReadStream::size() const {
 	return _size;
 }
 
+bool MemoryReadStream::canReadAtConcurrently() const {
+	return true;
+}
+
 const byte *MemoryReadStream::getData() const {
 	return _ptrOrig.get();
 }
@@ -0,0 +1,98 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Simple helpers for spreading independent jobs over several threads.
+ */
+
+#include "src/common/util.h"
+#include "src/common/parallel.h"
+
+namespace Common {
+
+size_t getHardwareThreadCount() {
+	const unsigned int count = std::thread::hardware_concurrency();
+
+	return (count > 0) ? count : 1;
+}
+
+size_t getThreadCount(size_t requested) {
+	return (requested > 0) ? requested : getHardwareThreadCount();
+}
+
+void parallelFor(size_t threadCount, size_t count, const std::function<void(size_t)> &func) {
+	if ((threadCount <= 1) || (count <= 1)) {
+		for (size_t i = 0; i < count; i++)
+			func(i);
+
+		return;
+	}
+
+	threadCount = MIN(threadCount, count);
+
+	std::mutex mutex;
+
+	size_t nextJob = 0;
+	std::exception_ptr error;
+
+	std::function<void()> worker = [&]() {
+		while (true) {
+			size_t i;
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (error || (nextJob >= count))
+					return;
+
+				i = nextJob++;
+			}
+
+			try {
+				func(i);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+
+	try {
+		for (size_t t = 1; t < threadCount; t++)
+			threads.push_back(std::thread(worker));
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(mutex);
+		error = std::current_exception();
+	}
+
+	// The calling thread pulls its weight as well
+	worker();
+
+	for (std::vector<std::thread>::iterator t = threads.begin(); t != threads.end(); ++t)
+		t->join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+} // End of namespace Common
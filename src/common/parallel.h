@@ -0,0 +1,218 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Simple helpers for spreading independent jobs over several threads.
+ */
+
+#ifndef COMMON_PARALLEL_H
+#define COMMON_PARALLEL_H
+
+#include <vector>
+#include <functional>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/scopedptr.h"
+
+namespace Common {
+
+/** Return the number of threads the hardware can run concurrently, at least 1. */
+size_t getHardwareThreadCount();
+
+/** Resolve a user-requested thread count: 0 means as many as the hardware supports. */
+size_t getThreadCount(size_t requested);
+
+/** Call func(i) for every i in [0, count), spread over threadCount threads.
+ *
+ *  With a threadCount of 1 (or only one job), everything runs on the
+ *  calling thread. If any of the calls throws, the remaining jobs are
+ *  skipped and the first exception is rethrown on the calling thread.
+ */
+void parallelFor(size_t threadCount, size_t count, const std::function<void(size_t)> &func);
+
+/** The result of one job run by parallelOrdered(). */
+template<typename T>
+class ParallelResult : boost::noncopyable {
+public:
+	ParallelResult() : _ready(false) { }
+
+	/** Take ownership of the produced object.
+	 *
+	 *  If producing the object threw an exception, it is rethrown here.
+	 */
+	T *release() {
+		if (_error)
+			std::rethrow_exception(_error);
+
+		return _result.release();
+	}
+
+private:
+	ScopedPtr<T> _result;
+	std::exception_ptr _error;
+
+	bool _ready;
+
+	void reset() {
+		_result.reset();
+		_error = std::exception_ptr();
+		_ready = false;
+	}
+
+	template<typename U>
+	friend void parallelOrdered(size_t, size_t, const std::function<U *(size_t)> &,
+	                            const std::function<void(size_t, ParallelResult<U> &)> &);
+};
+
+/** Run produce(i) for every i in [0, count) on threadCount worker threads,
+ *  and hand the results to consume() on the calling thread, in order.
+ *
+ *  Workers only ever run ahead of the consumer by a bounded number of jobs,
+ *  so at most a handful of results are kept in memory at once. Exceptions
+ *  thrown by produce() are rethrown by ParallelResult::release() within the
+ *  consume() call for that job. Exceptions thrown by consume() stop all
+ *  workers and are passed through to the caller.
+ *
+ *  With a threadCount of 1, everything runs on the calling thread.
+ */
+template<typename T>
+void parallelOrdered(size_t threadCount, size_t count, const std::function<T *(size_t)> &produce,
+                     const std::function<void(size_t, ParallelResult<T> &)> &consume) {
+
+	if (threadCount <= 1) {
+		for (size_t i = 0; i < count; i++) {
+			ParallelResult<T> result;
+
+			try {
+				result._result.reset(produce(i));
+			} catch (...) {
+				result._error = std::current_exception();
+			}
+
+			consume(i, result);
+		}
+
+		return;
+	}
+
+	const size_t window = 2 * threadCount;
+
+	ScopedArray<ParallelResult<T> > results(new ParallelResult<T>[window]);
+
+	std::mutex mutex;
+	std::condition_variable produced, consumed;
+
+	size_t nextJob  = 0;
+	size_t nextDone = 0;
+	bool   abort    = false;
+
+	std::function<void()> worker = [&]() {
+		while (true) {
+			size_t i;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				consumed.wait(lock, [&]() { return abort || (nextJob >= count) || (nextJob < nextDone + window); });
+
+				if (abort || (nextJob >= count))
+					return;
+
+				i = nextJob++;
+			}
+
+			ScopedPtr<T> object;
+			std::exception_ptr error;
+
+			try {
+				object.reset(produce(i));
+			} catch (...) {
+				error = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				ParallelResult<T> &result = results[i % window];
+
+				result._result.reset(object.release());
+				result._error = error;
+				result._ready = true;
+			}
+
+			produced.notify_all();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+
+	std::exception_ptr consumeError;
+
+	try {
+		for (size_t t = 0; t < threadCount; t++)
+			threads.push_back(std::thread(worker));
+
+		for (size_t i = 0; i < count; i++) {
+			ParallelResult<T> &result = results[i % window];
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				produced.wait(lock, [&]() { return result._ready; });
+			}
+
+			consume(i, result);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				result.reset();
+				nextDone++;
+			}
+
+			consumed.notify_all();
+		}
+
+	} catch (...) {
+		consumeError = std::current_exception();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			abort = true;
+		}
+
+		consumed.notify_all();
+	}
+
+	for (std::vector<std::thread>::iterator t = threads.begin(); t != threads.end(); ++t)
+		t->join();
+
+	if (consumeError)
+		std::rethrow_exception(consumeError);
+}
+
+} // End of namespace Common
+
+#endif // COMMON_PARALLEL_H
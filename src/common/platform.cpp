@@ -34,13 +34,18 @@
 #if defined(UNIX)
 	#include <pwd.h>
 	#include <unistd.h>
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
 #endif
 
 #include <cassert>
 #include <cstdlib>
+#include <ctime>
 
 #include <boost/locale.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
 
 #include "src/common/platform.h"
 #include "src/common/error.h"
@@ -118,6 +123,170 @@ std::FILE *Platform::openFile(const UString &fileName, FileMode mode) {
 }
 // '--- openFile() ---'
 
+// .--- mapFile() ---.
+#if defined(WIN32)
+
+bool Platform::mapFile(const UString &fileName, const byte *&data, size_t &size) {
+	data = 0;
+	size = 0;
+
+	HANDLE file = CreateFileW(boost::filesystem::path(fileName.c_str()).c_str(), GENERIC_READ,
+	                          FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || ((uint64)fileSize.QuadPart > (uint64)SIZE_MAX)) {
+		CloseHandle(file);
+		return false;
+	}
+
+	if (fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, 0, PAGE_READONLY, 0, 0, 0);
+	CloseHandle(file);
+
+	if (!mapping)
+		return false;
+
+	// The view keeps the mapping alive, so we can close the handle right away
+	void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+
+	if (!view)
+		return false;
+
+	data = reinterpret_cast<const byte *>(view);
+	size = (size_t)fileSize.QuadPart;
+
+	return true;
+}
+
+void Platform::unmapFile(const byte *data, size_t UNUSED(size)) {
+	if (data)
+		UnmapViewOfFile(data);
+}
+
+#elif defined(UNIX)
+
+bool Platform::mapFile(const UString &fileName, const byte *&data, size_t &size) {
+	data = 0;
+	size = 0;
+
+	int fd = ::open(boost::filesystem::path(fileName.c_str()).c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat fileStat;
+	if ((fstat(fd, &fileStat) != 0) || !S_ISREG(fileStat.st_mode) ||
+	    ((uint64)fileStat.st_size > (uint64)SIZE_MAX)) {
+
+		::close(fd);
+		return false;
+	}
+
+	if (fileStat.st_size == 0) {
+		::close(fd);
+		return true;
+	}
+
+	// The mapping stays valid after the file descriptor is closed
+	void *view = mmap(0, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (view == MAP_FAILED)
+		return false;
+
+	data = reinterpret_cast<const byte *>(view);
+	size = (size_t)fileStat.st_size;
+
+	return true;
+}
+
+void Platform::unmapFile(const byte *data, size_t size) {
+	if (data)
+		munmap(const_cast<byte *>(data), size);
+}
+
+#else
+
+/* No memory mapping support on this platform. */
+bool Platform::mapFile(const UString &UNUSED(fileName), const byte *&data, size_t &size) {
+	data = 0;
+	size = 0;
+
+	return false;
+}
+
+void Platform::unmapFile(const byte *UNUSED(data), size_t UNUSED(size)) {
+}
+
+#endif
+// '--- mapFile() ---'
+
+// .--- getModificationTime() ---.
+#if defined(WIN32)
+
+bool Platform::getModificationTime(const UString &fileName, uint64 &time) {
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExW(boost::filesystem::path(fileName.c_str()).c_str(), GetFileExInfoStandard, &attributes))
+		return false;
+
+	// A FILETIME counts 100ns intervals since 1601-01-01
+	static const uint64 kEpochOffset = 116444736000000000ULL;
+
+	const uint64 fileTime = ((uint64)attributes.ftLastWriteTime.dwHighDateTime << 32) |
+	                         (uint64)attributes.ftLastWriteTime.dwLowDateTime;
+	if (fileTime < kEpochOffset)
+		return false;
+
+	time = (fileTime - kEpochOffset) * 100;
+	return true;
+}
+
+#elif defined(UNIX)
+
+bool Platform::getModificationTime(const UString &fileName, uint64 &time) {
+	struct stat fileStat;
+	if (stat(boost::filesystem::path(fileName.c_str()).c_str(), &fileStat) != 0)
+		return false;
+
+#if defined(__APPLE__)
+	const struct timespec &fileTime = fileStat.st_mtimespec;
+#else
+	const struct timespec &fileTime = fileStat.st_mtim;
+#endif
+
+	if (fileTime.tv_sec < 0)
+		return false;
+
+	time = (uint64)fileTime.tv_sec * 1000000000ULL + (uint64)fileTime.tv_nsec;
+	return true;
+}
+
+#else
+
+/* Only a resolution of seconds on this platform. */
+bool Platform::getModificationTime(const UString &fileName, uint64 &time) {
+	try {
+		const std::time_t fileTime = boost::filesystem::last_write_time(fileName.c_str());
+		if (fileTime < 0)
+			return false;
+
+		time = (uint64)fileTime * 1000000000ULL;
+		return true;
+	} catch (...) {
+	}
+
+	return false;
+}
+
+#endif
+// '--- getModificationTime() ---'
+
 // .--- Windows utility functions ---.
 #if defined(WIN32)
 
@@ -29,6 +29,7 @@
 
 #include <vector>
 
+#include "src/common/types.h"
 #include "src/common/ustring.h"
 
 namespace Common {
@@ -51,6 +52,27 @@ public:
 	/** Open a file with an UTF-8 encoded name. */
 	static std::FILE *openFile(const UString &fileName, FileMode mode);
 
+	/** Map a whole file with an UTF-8 encoded name read-only into memory.
+	 *
+	 *  On success, data points to the mapped file contents and size holds
+	 *  the size of the file. An empty file is mapped to a 0 pointer.
+	 *
+	 *  @return true if the file was mapped successfully, false otherwise.
+	 */
+	static bool mapFile(const UString &fileName, const byte *&data, size_t &size);
+
+	/** Unmap a file previously mapped with mapFile(). */
+	static void unmapFile(const byte *data, size_t size);
+
+	/** Get the last modification time of a file with an UTF-8 encoded name.
+	 *
+	 *  The time is given in nanoseconds since the epoch, in as fine a
+	 *  resolution as the OS and file system provide.
+	 *
+	 *  @return true if the time could be read, false otherwise.
+	 */
+	static bool getModificationTime(const UString &fileName, uint64 &time);
+
 	/** Return the OS-specific path of the user's home directory. */
 	static UString getHomeDirectory();
 	/** Return the OS-specific path of the config directory. */
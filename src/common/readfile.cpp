@@ -22,9 +22,17 @@
  *  Implementing the stream reading interfaces for files.
  */
 
+#include "src/common/system.h"
+
+#if defined(UNIX)
+	#include <unistd.h>
+	#include <cerrno>
+#endif
+
 #include <cassert>
 
 #include "src/common/readfile.h"
+#include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/ustring.h"
 #include "src/common/platform.h"
@@ -139,6 +147,48 @@ size_t ReadFile::read(void *dataPtr, size_t dataSize) {
 	return std::fread(dataPtr, 1, dataSize, _handle);
 }
 
+size_t ReadFile::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (!_handle || (offset > _size))
+		return 0;
+
+#if defined(UNIX)
+	assert(dataPtr || (dataSize == 0));
+
+	dataSize = MIN(dataSize, _size - offset);
+
+	const int fd = fileno(_handle);
+
+	byte  *data      = reinterpret_cast<byte *>(dataPtr);
+	size_t bytesRead = 0;
+	while (bytesRead < dataSize) {
+		const ssize_t n = pread(fd, data + bytesRead, dataSize - bytesRead, offset + bytesRead);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+
+			break;
+		}
+
+		if (n == 0)
+			break;
+
+		bytesRead += n;
+	}
+
+	return bytesRead;
+#else
+	return SeekableReadStream::readAt(offset, dataPtr, dataSize);
+#endif
+}
+
+bool ReadFile::canReadAtConcurrently() const {
+#if defined(UNIX)
+	return true;
+#else
+	return false;
+#endif
+}
+
 MemoryReadStream *ReadFile::readIntoMemory(const UString &fileName) {
 	ReadFile file(fileName);
 
@@ -68,6 +68,14 @@ public:
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 	size_t read(void *dataPtr, size_t dataSize);
 
+	/** Read data from a position in the file, without changing the file position.
+	 *
+	 *  On POSIX systems, this uses pread() and is safe to call from several
+	 *  threads at once. Elsewhere, this falls back to seeking and reading.
+	 */
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+	bool canReadAtConcurrently() const;
+
 	/** Read the whole file into memory and return a stream of its contents. */
 	static MemoryReadStream *readIntoMemory(const UString &fileName);
 
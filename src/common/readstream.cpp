@@ -80,6 +80,50 @@ SeekableReadStream::SeekableReadStream() {
 SeekableReadStream::~SeekableReadStream() {
 }
 
+size_t SeekableReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (offset > size())
+		return 0;
+
+	const size_t oldPos = seek(offset);
+
+	dataSize = read(dataPtr, dataSize);
+
+	seek(oldPos);
+
+	return dataSize;
+}
+
+bool SeekableReadStream::canReadAtConcurrently() const {
+	return false;
+}
+
+MemoryReadStream *SeekableReadStream::readStreamAt(size_t offset, size_t dataSize) {
+	ScopedArray<byte> buf(new byte[dataSize]);
+
+	if (readAt(offset, buf.get(), dataSize) != dataSize)
+		throw Exception(kReadError);
+
+	return new MemoryReadStream(buf.release(), dataSize, true);
+}
+
+const byte *SeekableReadStream::getData() const {
+	return 0;
+}
+
+SeekableReadStream *SeekableReadStream::getSubStream(size_t begin, size_t end) {
+	if ((begin > end) || (end > size()))
+		throw Exception(kReadError);
+
+	const byte *data = getData();
+	if (data)
+		return new MemoryReadStream(data + begin, end - begin);
+
+	if (canReadAtConcurrently())
+		return new PositionalSubReadStream(this, begin, end);
+
+	return new SeekableSubReadStream(this, begin, end);
+}
+
 size_t SeekableReadStream::evalSeek(ptrdiff_t offset, Origin whence, size_t pos, size_t begin, size_t size) {
 	switch (whence) {
 		case kOriginEnd:
@@ -162,6 +206,96 @@ size_t SeekableSubReadStream::seek(ptrdiff_t offset, Origin whence) {
 	return oldPos;
 }
 
+size_t SeekableSubReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (offset > size())
+		return 0;
+
+	dataSize = MIN(dataSize, size() - offset);
+
+	return _parentStream->readAt(_begin + offset, dataPtr, dataSize);
+}
+
+const byte *SeekableSubReadStream::getData() const {
+	const byte *data = _parentStream->getData();
+	if (!data)
+		return 0;
+
+	return data + _begin;
+}
+
+bool SeekableSubReadStream::canReadAtConcurrently() const {
+	return _parentStream->canReadAtConcurrently();
+}
+
+
+PositionalSubReadStream::PositionalSubReadStream(SeekableReadStream *parentStream, size_t begin,
+                                                 size_t end, bool disposeParentStream) :
+	_parentStream(parentStream, disposeParentStream), _begin(begin), _end(end), _pos(begin), _eos(false) {
+
+	assert(parentStream);
+	assert(_begin <= _end);
+}
+
+PositionalSubReadStream::~PositionalSubReadStream() {
+}
+
+bool PositionalSubReadStream::eos() const {
+	return _eos;
+}
+
+size_t PositionalSubReadStream::read(void *dataPtr, size_t dataSize) {
+	if (dataSize > (_end - _pos)) {
+		dataSize = _end - _pos;
+		_eos = true;
+	}
+
+	dataSize = _parentStream->readAt(_pos, dataPtr, dataSize);
+	_pos += dataSize;
+
+	return dataSize;
+}
+
+size_t PositionalSubReadStream::pos() const {
+	return _pos - _begin;
+}
+
+size_t PositionalSubReadStream::size() const {
+	return _end - _begin;
+}
+
+size_t PositionalSubReadStream::seek(ptrdiff_t offset, Origin whence) {
+	const size_t oldPos = _pos;
+	const size_t newPos = evalSeek(offset, whence, _pos, _begin, size());
+	if ((newPos < _begin) || (newPos > _end))
+		throw Exception(kSeekError);
+
+	_pos = newPos;
+	_eos = false;
+
+	return oldPos - _begin;
+}
+
+size_t PositionalSubReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (offset > size())
+		return 0;
+
+	dataSize = MIN(dataSize, size() - offset);
+
+	return _parentStream->readAt(_begin + offset, dataPtr, dataSize);
+}
+
+bool PositionalSubReadStream::canReadAtConcurrently() const {
+	return _parentStream->canReadAtConcurrently();
+}
+
+const byte *PositionalSubReadStream::getData() const {
+	const byte *data = _parentStream->getData();
+	if (!data)
+		return 0;
+
+	return data + _begin;
+}
+
 
 SeekableSubReadStreamEndian::SeekableSubReadStreamEndian(SeekableReadStream *parentStream,
 		size_t begin, size_t end, bool bigEndian, bool disposeParentStream) :
@@ -318,6 +318,59 @@ public:
 		return seek(offset, kOriginCurrent);
 	}
 
+	/** Read data from a position in the stream, without changing the
+	 *  stream's position indicator.
+	 *
+	 *  Streams that can do this without touching any shared state
+	 *  (MemoryReadStream, MappedReadFile, ReadFile on POSIX systems, and
+	 *  SeekableSubReadStreams of those) can be read this way from several
+	 *  threads at once. The default implementation seeks, reads and seeks
+	 *  back, and is therefore not safe to use concurrently.
+	 *
+	 *  @param  offset the position in the stream, in bytes, to read from.
+	 *  @param  dataPtr pointer to a buffer into which the data is read.
+	 *  @param  dataSize number of bytes to be read.
+	 *  @return the number of bytes which were actually read.
+	 */
+	virtual size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+
+	/** Can readAt() be called from several threads at once?
+	 *
+	 *  This is true for the streams listed with readAt(), and false for
+	 *  all streams relying on the default implementation.
+	 */
+	virtual bool canReadAtConcurrently() const;
+
+	/** Read the specified amount of data from a position in the stream into
+	 *  a new[]'ed buffer which then is wrapped into a MemoryReadStream. Like
+	 *  readAt(), this does not change the stream's position indicator.
+	 *
+	 *  When reading fails, a kReadError exception is thrown.
+	 */
+	MemoryReadStream *readStreamAt(size_t offset, size_t dataSize);
+
+	/** Return a pointer to the memory backing this stream, if any.
+	 *
+	 *  Streams directly wrapping a block of memory return a pointer to the
+	 *  beginning of that block. All other streams return 0.
+	 */
+	virtual const byte *getData() const;
+
+	/** Return a stream of the range [begin, end) of this stream.
+	 *
+	 *  If this stream is backed by memory (see getData()), the new stream
+	 *  aliases that memory directly, without copying, and it does not share
+	 *  the position of this stream. If this stream supports concurrent
+	 *  positional reads (see canReadAtConcurrently()), a PositionalSubReadStream
+	 *  is returned, which doesn't share the position either. Otherwise, a
+	 *  SeekableSubReadStream is returned, with all its caveats.
+	 *
+	 *  Either way, the new stream must not outlive this stream.
+	 *
+	 *  When the range lies outside this stream, a kReadError exception is thrown.
+	 */
+	SeekableReadStream *getSubStream(size_t begin, size_t end);
+
 	/** Evaluate the seek offset relative to whence into a position from the beginning. */
 	static size_t evalSeek(ptrdiff_t offset, Origin whence, size_t pos, size_t begin, size_t size);
 };
@@ -367,6 +420,11 @@ public:
 
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+	bool canReadAtConcurrently() const;
+
+	const byte *getData() const;
+
 protected:
 	SeekableReadStream *_parentStream;
 
@@ -374,6 +432,44 @@ protected:
 };
 
 
+/** PositionalSubReadStream provides access to a SeekableReadStream restricted
+ *  to the range [begin, end), reading through the parent stream's readAt().
+ *
+ *  This stream keeps its own position and never touches the position of the
+ *  parent stream. If the parent stream supports concurrent positional reads,
+ *  several of these substreams can be read from different threads at once.
+ */
+class PositionalSubReadStream : public SeekableReadStream {
+public:
+	PositionalSubReadStream(SeekableReadStream *parentStream, size_t begin, size_t end,
+	                        bool disposeParentStream = false);
+	~PositionalSubReadStream();
+
+	bool eos() const;
+
+	size_t read(void *dataPtr, size_t dataSize);
+
+	size_t pos() const;
+	size_t size() const;
+
+	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
+
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+	bool canReadAtConcurrently() const;
+
+	const byte *getData() const;
+
+private:
+	DisposablePtr<SeekableReadStream> _parentStream;
+
+	size_t _begin;
+	size_t _end;
+	size_t _pos;
+
+	bool _eos;
+};
+
+
 /** This is a wrapper around SeekableSubReadStream, but it adds non-endian
  *  read methods whose endianness is set on the stream creation.
  *
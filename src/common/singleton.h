@@ -50,6 +50,9 @@
 #ifndef COMMON_SINGLETON_H
 #define COMMON_SINGLETON_H
 
+#include <atomic>
+#include <mutex>
+
 #include <boost/noncopyable.hpp>
 
 namespace Common {
@@ -63,7 +66,14 @@ private:
 	Singleton<T>(const Singleton<T> &);
 	Singleton<T> &operator=(const Singleton<T> &);
 
-	static T *_singleton;
+	static std::atomic<T *> _singleton;
+
+	/** The mutex guarding the creation of the singleton. */
+	static std::mutex &getMutex() {
+		static std::mutex mutex;
+
+		return mutex;
+	}
 
 	/**
 	 * The default object factory used by the template class Singleton.
@@ -82,25 +92,29 @@ public:
 	}
 
 	static void destroyInstance() {
-		delete _singleton;
-		_singleton = 0;
+		delete _singleton.exchange(0);
 	}
 
 
 public:
 	static T& instance() {
-		// TODO: We aren't thread safe. For now we ignore it since the
-		// only thing using this singleton template is the config manager,
-		// and that is first instantiated long before any threads.
 		// TODO: We don't leak, but the destruction order is nevertheless
 		// semi-random. If we use multiple singletons, the destruction
 		// order might become an issue. There are various approaches
 		// to solve that problem, but for now this is sufficient
-		if (!_singleton)
-			_singleton = T::makeInstance();
-		return *_singleton;
+		T *singleton = _singleton.load();
+		if (!singleton) {
+			// Only lock when the singleton needs to be created, so that several threads can create it safely
+			std::lock_guard<std::mutex> lock(getMutex());
+
+			if (!(singleton = _singleton.load()))
+				_singleton.store(singleton = T::makeInstance());
+		}
+
+		return *singleton;
 	}
 
+	/** Destroy the singleton. This must not happen while other threads still use it. */
 	static void destroy() {
 		T::destroyInstance();
 	}
@@ -121,7 +135,7 @@ protected:
  */
 #define DECLARE_SINGLETON(T) \
 	namespace Common { \
-	template<> T *Singleton<T>::_singleton = 0; \
+	template<> std::atomic<T *> Singleton<T>::_singleton(0); \
 	} // End of namespace Common
 
 } // End of namespace Common
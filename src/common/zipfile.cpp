@@ -130,28 +130,30 @@ const ZipFile::IFile &ZipFile::getIFile(uint32 index) const {
 }
 
 void ZipFile::getFileProperties(SeekableReadStream &zip, const IFile &file,
-		uint16 &compMethod, uint32 &compSize, uint32 &realSize) const {
+		uint16 &compMethod, uint32 &compSize, uint32 &realSize, size_t &dataOffset) const {
 
-	zip.seek(file.offset);
+	// Read the fixed-size local file header without touching the stream position
+	static const size_t kLocalHeaderSize = 30;
 
-	uint32 tag = zip.readUint32LE();
+	ScopedPtr<MemoryReadStream> header(zip.readStreamAt(file.offset, kLocalHeaderSize));
+
+	uint32 tag = header->readUint32LE();
 	if (tag != 0x04034B50)
 		throw Exception("Unknown ZIP record %08X", tag);
 
-	zip.skip(4);
+	header->skip(4);
 
-	compMethod = zip.readUint16LE();
+	compMethod = header->readUint16LE();
 
-	zip.skip(8);
+	header->skip(8);
 
-	compSize = zip.readUint32LE();
-	realSize = zip.readUint32LE();
+	compSize = header->readUint32LE();
+	realSize = header->readUint32LE();
 
-	uint16 nameLength  = zip.readUint16LE();
-	uint16 extraLength = zip.readUint16LE();
+	uint16 nameLength  = header->readUint16LE();
+	uint16 extraLength = header->readUint16LE();
 
-	zip.skip(nameLength);
-	zip.skip(extraLength);
+	dataOffset = file.offset + kLocalHeaderSize + nameLength + extraLength;
 }
 
 size_t ZipFile::getFileSize(uint32 index) const {
@@ -159,18 +161,43 @@ size_t ZipFile::getFileSize(uint32 index) const {
 }
 
 SeekableReadStream *ZipFile::getFile(uint32 index, bool tryNoCopy) const {
+	return readFile(index, tryNoCopy, false);
+}
+
+SeekableReadStream *ZipFile::getFileStreamed(uint32 index) const {
+	return readFile(index, true, true);
+}
+
+SeekableReadStream *ZipFile::readFile(uint32 index, bool tryNoCopy, bool streamed) const {
 	const IFile &file = getIFile(index);
 
 	uint16 compMethod;
 	uint32 compSize;
 	uint32 realSize;
 
-	getFileProperties(*_zip, file, compMethod, compSize, realSize);
+	size_t dataOffset;
+
+	getFileProperties(*_zip, file, compMethod, compSize, realSize, dataOffset);
 
-	if (tryNoCopy && (compMethod == 0))
-		return new SeekableSubReadStream(_zip.get(), _zip->pos(), _zip->pos() + compSize);
+	if (compMethod == 0) {
+		if (tryNoCopy)
+			return _zip->getSubStream(dataOffset, dataOffset + compSize);
+
+		return _zip->readStreamAt(dataOffset, compSize);
+	}
+
+	// When asked to, large files are inflated on demand, while they're being read
+	if (streamed && (compMethod == 8) && (realSize >= kInflateStreamThreshold))
+		return new InflateReadStream(_zip->getSubStream(dataOffset, dataOffset + compSize), true,
+		                             realSize, kWindowBitsMaxRaw);
+
+	ScopedPtr<MemoryReadStream> compData(_zip->readStreamAt(dataOffset, compSize));
+
+	return decompressFile(*compData, compMethod, compSize, realSize);
+}
 
-	return decompressFile(*_zip, compMethod, compSize, realSize);
+bool ZipFile::canReadConcurrently() const {
+	return _zip->canReadAtConcurrently();
 }
 
 SeekableReadStream *ZipFile::decompressFile(SeekableReadStream &zip, uint32 method,
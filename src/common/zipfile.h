@@ -61,6 +61,15 @@ public:
 	/** Return a stream of the file's contents. */
 	SeekableReadStream *getFile(uint32 index, bool tryNoCopy = false) const;
 
+	/** Return a stream of the file's contents, inflating large files on demand.
+	 *
+	 *  The returned stream reads out of the ZIP, so it must not outlive it.
+	 */
+	SeekableReadStream *getFileStreamed(uint32 index) const;
+
+	/** Can getFile() be called from several threads at once? */
+	bool canReadConcurrently() const;
+
 private:
 	/** Internal file information. */
 	struct IFile {
@@ -84,8 +93,9 @@ private:
 			uint32 compSize, uint32 realSize);
 
 	const IFile &getIFile(uint32 index) const;
+	SeekableReadStream *readFile(uint32 index, bool tryNoCopy, bool streamed) const;
 	void getFileProperties(SeekableReadStream &zip, const IFile &file,
-			uint16 &compMethod, uint32 &compSize, uint32 &realSize) const;
+			uint16 &compMethod, uint32 &compSize, uint32 &realSize, size_t &dataOffset) const;
 };
 
 } // End of namespace Common
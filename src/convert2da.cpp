@@ -38,6 +38,7 @@
 #include "src/common/encoding.h"
 #include "src/common/platform.h"
 #include "src/common/cli.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/aurorafile.h"
 #include "src/aurora/2dafile.h"
@@ -52,7 +53,8 @@ enum Format {
 };
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      std::vector<Common::UString> &files, Common::UString &outFile, Format &format);
+                      std::vector<Common::UString> &files, Common::UString &outFile, Format &format,
+                      bool &batch, uint32 &jobs);
 
 void write2DA(Aurora::TwoDAFile &twoDA, Format format);
 
@@ -69,14 +71,39 @@ int main(int argc, char **argv) {
 
 		Format format = kFormat2DA;
 
+		bool batch = false;
+		uint32 jobs = 1;
+
 		int returnValue = 1;
 		std::vector<Common::UString> files;
 		Common::UString outFile;
 
-		if (!parseCommandLine(args, returnValue, files, outFile, format))
+		if (!parseCommandLine(args, returnValue, files, outFile, format, batch, jobs))
 			return returnValue;
 
-		convert2DA(files, outFile, format);
+		if (!batch) {
+			convert2DA(files, outFile, format);
+			return 0;
+		}
+
+		if (files.size() != 1)
+			throw Common::Exception("Batch mode takes exactly one list of files");
+		if (!outFile.empty())
+			throw Common::Exception("No output file can be given in batch mode");
+
+		std::vector<BatchJob> batchJobs;
+		readBatchJobs(files[0], batchJobs);
+
+		const Common::UString extension = (format == kFormatCSV) ? ".csv" : ".2da";
+
+		const size_t failed = runBatchJobs(batchJobs, Common::getThreadCount(jobs), [&](const BatchJob &job) {
+			convert2DA(job.inFile, job.outFile.empty() ? (job.inFile + extension) : job.outFile, format);
+		});
+
+		if (failed > 0) {
+			status("Failed to convert %u of %u files", (uint) failed, (uint) batchJobs.size());
+			return 1;
+		}
 	} catch (...) {
 		Common::exceptionDispatcherError();
 	}
@@ -86,7 +113,7 @@ int main(int argc, char **argv) {
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       std::vector<Common::UString> &files, Common::UString &outFile,
-                      Format &format) {
+                      Format &format, bool &batch, uint32 &jobs) {
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
 	using Common::CLI::Parser;
@@ -100,7 +127,11 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	Parser parser(argv[0], "BioWare 2DA/GDA to 2DA/CSV converter\n",
 	              "If several files are given, they must all be GDA and use the same\n"
 	              "column layout. They will be pasted together and printed as one GDA.\n\n"
-	              "If no output file is given, the output is written to stdout.",
+	              "If no output file is given, the output is written to stdout.\n\n"
+	              "In batch mode, the only file given is a list of files to convert, \"-\" to\n"
+	              "read it from stdin. Each line holds one 2DA or GDA file, optionally followed\n"
+	              "by a tab and the file to write. Without a file to write, \".2da\" or \".csv\"\n"
+	              "is appended to the name of the 2DA or GDA file.",
 	              returnValue,
 	              makeEndArgs(&filesOpt));
 
@@ -119,6 +150,11 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	parser.addOption("cvs", "Convert to CSV", kContinueParsing,
 	                 makeAssigners(new ValAssigner<Format>(kFormatCSV,
 	                 format)));
+	parser.addSpace();
+	parser.addOption("batch", "Convert all files listed in the input file", kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, batch)));
+	parser.addOption("jobs", 'j', "Number of threads to convert with in batch mode (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
 	return parser.process(argv);
 }
 
@@ -23,6 +23,7 @@
  */
 
 #include <set>
+#include <vector>
 
 #include "src/common/error.h"
 #include "src/common/platform.h"
@@ -30,6 +31,7 @@
 #include "src/common/readfile.h"
 #include "src/common/writefile.h"
 #include "src/common/filepath.h"
+#include "src/common/deflate.h"
 
 #include "src/aurora/erfwriter.h"
 #include "src/aurora/util.h"
@@ -44,6 +46,7 @@ static const uint32 kSAVID = MKTAG('S', 'A', 'V', ' ');
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &archive, std::set<Common::UString> &files,
                       Aurora::ERFWriter::Version &version, Aurora::ERFWriter::Compression &compression,
+                      uint32 &level, uint32 &jobs,
                       uint32 id, Aurora::GameID &game);
 
 int main(int argc, char **argv) {
@@ -61,29 +64,50 @@ int main(int argc, char **argv) {
 		Aurora::ERFWriter::Version version = Aurora::ERFWriter::kERFVersion10;
 		Aurora::ERFWriter::Compression compression = Aurora::ERFWriter::kCompressionNone;
 		std::set<Common::UString> files;
+		uint32 level = 0xFFFFFFFF;
+		uint32 jobs = 0xFFFFFFFF;
 
-		if (!parseCommandLine(args, returnValue, archive, files, version, compression, id, game))
+		if (!parseCommandLine(args, returnValue, archive, files, version, compression,
+		                      level, jobs, id, game))
 			return returnValue;
 
 		if (compression != Aurora::ERFWriter::kCompressionNone && version != Aurora::ERFWriter::kERFVersion22)
 			throw Common::Exception("Compression is only allowed in ERF V2.2");
 
+		if (compression == Aurora::ERFWriter::kCompressionNone && (level != 0xFFFFFFFF || jobs != 0xFFFFFFFF))
+			throw Common::Exception("--level and --jobs are only allowed with --bzlib or --zlib");
+
+		if (level == 0xFFFFFFFF)
+			level = Common::kCompressionLevelMax;
+		if (jobs == 0xFFFFFFFF)
+			jobs = 1;
+
+		std::vector<Aurora::ERFWriter::Resource> resources;
+		resources.reserve(files.size());
+
+		for (std::set<Common::UString>::const_iterator iter = files.begin(); iter != files.end(); ++iter) {
+			const Common::UString file = *iter;
+
+			Aurora::ERFWriter::Resource resource;
+
+			resource.resRef  = Common::FilePath::getStem(file);
+			resource.resType = TypeMan.unaliasFileType(TypeMan.getFileType(file), game);
+			resource.open    = [file]() { return new Common::ReadFile(file); };
+
+			resources.push_back(resource);
+		}
+
 		Common::WriteFile writeFile(archive);
 
-		size_t i = 1;
 		Aurora::ERFWriter erfWriter(id, files.size(), writeFile, version, compression);
-		for (std::set<Common::UString>::const_iterator iter = files.begin(); iter != files.end(); ++iter, ++i) {
-			std::printf("Packing %u/%u: %s ... ", (uint)i, (uint)files.size(), iter->c_str());
-			std::fflush(stdout);
 
-			Common::UString file = *iter;
-			Common::ReadFile fileStream(file);
+		erfWriter.setCompressionLevel(level);
 
-			const Aurora::FileType type = TypeMan.unaliasFileType(TypeMan.getFileType(file), game);
+		const std::vector<Common::UString> fileList(files.begin(), files.end());
 
-			erfWriter.add(Common::FilePath::getStem(file), type, fileStream);
-			std::printf("Done\n");
-		}
+		erfWriter.addAll(resources, jobs, [&](size_t i) {
+			std::printf("Packed %u/%u: %s\n", (uint)(i + 1), (uint)fileList.size(), fileList[i].c_str());
+		});
 	} catch (...) {
 		Common::exceptionDispatcherError();
 	}
@@ -94,6 +118,7 @@ int main(int argc, char **argv) {
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &archive, std::set<Common::UString> &files,
                       Aurora::ERFWriter::Version &version, Aurora::ERFWriter::Compression &compression,
+                      uint32 &level, uint32 &jobs,
                       uint32 id, Aurora::GameID &game) {
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
@@ -143,6 +168,10 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	parser.addOption("zlib", "Compress using headerless zlib method",
 	                 kContinueParsing,
 	                 makeAssigners(new ValAssigner<Aurora::ERFWriter::Compression>(Aurora::ERFWriter::kCompressionHeaderlessZlib, compression)));
+	parser.addOption("level", 'l', "Compression level, from 0 (store only) to 9 (best, default); needs --bzlib or --zlib",
+	                 kContinueParsing, new ValGetter<uint32_t &>(level, "level"));
+	parser.addOption("jobs", 'j', "Number of threads to compress with (0: one per CPU core); needs --bzlib or --zlib",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
 	parser.addSpace();
 	parser.addOption("jade", "Unalias file types according to Jade Empire rules",
 	                 kContinueParsing,
@@ -25,6 +25,8 @@
 #include <cstring>
 #include <cstdio>
 
+#include <vector>
+
 #include "src/version/version.h"
 
 #include "src/common/scopedptr.h"
@@ -33,11 +35,12 @@
 #include "src/common/strutil.h"
 #include "src/common/error.h"
 #include "src/common/platform.h"
-#include "src/common/readfile.h"
+#include "src/common/mappedreadfile.h"
 #include "src/common/writefile.h"
 #include "src/common/stdoutstream.h"
 #include "src/common/encoding.h"
 #include "src/common/cli.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/language.h"
@@ -51,7 +54,8 @@ typedef std::map<uint32, Common::Encoding> EncodingOverrides;
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
                       Common::Encoding &encoding, Aurora::GameID &game,
-                      EncodingOverrides &encOverrides, bool &nwnPremium, bool &sacFile);
+                      EncodingOverrides &encOverrides, bool &nwnPremium, bool &sacFile,
+                      bool &batch, uint32 &jobs);
 
 bool parseEncodingOverride(const Common::UString &arg, EncodingOverrides &encOverrides);
 
@@ -73,10 +77,14 @@ int main(int argc, char **argv) {
 		bool nwnPremium = false;
 		bool sacFile = false;
 
+		bool batch = false;
+		uint32 jobs = 1;
+
 		int returnValue = 1;
 		Common::UString inFile, outFile;
 
-		if (!parseCommandLine(args, returnValue, inFile, outFile, encoding, game, encOverrides, nwnPremium, sacFile))
+		if (!parseCommandLine(args, returnValue, inFile, outFile, encoding, game, encOverrides, nwnPremium, sacFile,
+		                      batch, jobs))
 			return returnValue;
 
 		LangMan.declareLanguages(game);
@@ -84,7 +92,26 @@ int main(int argc, char **argv) {
 		for (EncodingOverrides::const_iterator e = encOverrides.begin(); e != encOverrides.end(); ++e)
 			LangMan.overrideEncoding(e->first, e->second);
 
-		dumpGFF(inFile, outFile, encoding, nwnPremium, sacFile);
+		if (!batch) {
+			dumpGFF(inFile, outFile, encoding, nwnPremium, sacFile);
+			return 0;
+		}
+
+		if (!outFile.empty())
+			throw Common::Exception("No output file can be given in batch mode");
+
+		std::vector<BatchJob> batchJobs;
+		readBatchJobs(inFile, batchJobs);
+
+		const size_t failed = runBatchJobs(batchJobs, Common::getThreadCount(jobs), [&](const BatchJob &job) {
+			dumpGFF(job.inFile, job.outFile.empty() ? (job.inFile + ".xml") : job.outFile,
+			        encoding, nwnPremium, sacFile);
+		});
+
+		if (failed > 0) {
+			status("Failed to convert %u of %u files", (uint) failed, (uint) batchJobs.size());
+			return 1;
+		}
 	} catch (...) {
 		Common::exceptionDispatcherError();
 	}
@@ -119,7 +146,8 @@ bool parseEncodingOverride(const Common::UString &arg, EncodingOverrides &encOve
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
                       Common::Encoding &encoding, Aurora::GameID &game,
-                      EncodingOverrides &encOverrides, bool &nwnPremium, bool &sacFile) {
+                      EncodingOverrides &encOverrides, bool &nwnPremium, bool &sacFile,
+                      bool &batch, uint32 &jobs) {
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
 	using Common::CLI::Parser;
@@ -142,7 +170,11 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	              "for a specific language ID. The string has to be of the form n=encoding,\n"
 	              "for example 0=cp-1252 to override the encoding of the (ungendered) language\n"
 	              "ID 0 to be Windows codepage 1252. To override several encodings, specify\n"
-	              "the --encoding parameter multiple times.\n",
+	              "the --encoding parameter multiple times.\n\n"
+	              "In batch mode, the input file is a list of files to convert, \"-\" to read\n"
+	              "it from stdin. Each line holds one GFF file, optionally followed by a tab and\n"
+	              "the XML file to write. Without an XML file, \".xml\" is appended to the name\n"
+	              "of the GFF file.\n",
 	              returnValue,
 	              makeEndArgs(&inFileOpt, &outFileOpt));
 
@@ -177,6 +209,11 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	                 new Callback<EncodingOverrides &>("str", parseEncodingOverride, encOverrides));
 	parser.addOption("sac", "Read the extra sac file header", kContinueParsing,
 	                 makeAssigners(new ValAssigner<bool>(true, sacFile)));
+	parser.addSpace();
+	parser.addOption("batch", "Convert all files listed in the input file", kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, batch)));
+	parser.addOption("jobs", 'j', "Number of threads to convert with in batch mode (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
 
 	return parser.process(argv);
 }
@@ -185,7 +222,7 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 void dumpGFF(const Common::UString &inFile, const Common::UString &outFile, Common::Encoding encoding, bool nwnPremium,
              bool sacFile) {
 
-	Common::ScopedPtr<Common::SeekableReadStream> gff(new Common::ReadFile(inFile));
+	Common::ScopedPtr<Common::SeekableReadStream> gff(Common::mapOrReadFile(inFile));
 
 	Common::ScopedPtr<XML::GFFDumper> dumper(XML::GFFDumper::identify(*gff, nwnPremium, sacFile));
 
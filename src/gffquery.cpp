@@ -0,0 +1,310 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Tool to query fields out of GFF files.
+ */
+
+#include <vector>
+
+#include "src/version/version.h"
+
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/util.h"
+#include "src/common/strutil.h"
+#include "src/common/error.h"
+#include "src/common/platform.h"
+#include "src/common/mappedreadfile.h"
+#include "src/common/stdoutstream.h"
+#include "src/common/encoding.h"
+#include "src/common/cli.h"
+#include "src/common/parallel.h"
+
+#include "src/aurora/types.h"
+#include "src/aurora/util.h"
+#include "src/aurora/language.h"
+#include "src/aurora/archive.h"
+#include "src/aurora/erffile.h"
+#include "src/aurora/rimfile.h"
+#include "src/aurora/zipfile.h"
+#include "src/aurora/gff3file.h"
+#include "src/aurora/gff4file.h"
+#include "src/aurora/gffquery.h"
+
+#include "src/util.h"
+
+static const uint32 kVersion32 = MKTAG('V', '3', '.', '2');
+static const uint32 kVersion33 = MKTAG('V', '3', '.', '3');
+static const uint32 kVersion40 = MKTAG('V', '4', '.', '0');
+static const uint32 kVersion41 = MKTAG('V', '4', '.', '1');
+
+bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
+                      Common::UString &query, std::vector<Common::UString> &files,
+                      Common::Encoding &encoding, Aurora::GameID &game,
+                      Common::UString &typeFilter, uint32 &jobs);
+
+Aurora::Archive *openArchive(const Common::UString &file, Aurora::FileType type);
+
+Aurora::GFFQuery::Results *queryGFF(const Aurora::GFFQuery &query, Common::SeekableReadStream *stream,
+                                    Common::Encoding encoding, bool needGFF);
+
+void printResults(Common::WriteStream &out, const Common::UString &source, const Aurora::GFFQuery::Results &results);
+
+bool queryFile(const Aurora::GFFQuery &query, const Common::UString &file, Common::WriteStream &out,
+               Common::Encoding encoding, Aurora::GameID game, const Common::UString &typeFilter, size_t threads);
+
+int main(int argc, char **argv) {
+	initPlatform();
+
+	try {
+		std::vector<Common::UString> args;
+		Common::Platform::getParameters(argc, argv, args);
+
+		Common::Encoding encoding = Common::kEncodingInvalid;
+		Aurora::GameID   game     = Aurora::kGameIDUnknown;
+
+		Common::UString typeFilter;
+		uint32 jobs = 1;
+
+		int returnValue = 1;
+		Common::UString queryString;
+		std::vector<Common::UString> files;
+
+		if (!parseCommandLine(args, returnValue, queryString, files, encoding, game, typeFilter, jobs))
+			return returnValue;
+
+		LangMan.declareLanguages(game);
+
+		const Aurora::GFFQuery query(queryString);
+		const size_t threads = Common::getThreadCount(jobs);
+
+		Common::StdOutStream out;
+
+		bool failed = false;
+		for (std::vector<Common::UString>::const_iterator f = files.begin(); f != files.end(); ++f)
+			if (!queryFile(query, *f, out, encoding, game, typeFilter, threads))
+				failed = true;
+
+		out.flush();
+
+		if (failed)
+			return 1;
+
+	} catch (...) {
+		Common::exceptionDispatcherError();
+	}
+
+	return 0;
+}
+
+bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
+                      Common::UString &query, std::vector<Common::UString> &files,
+                      Common::Encoding &encoding, Aurora::GameID &game,
+                      Common::UString &typeFilter, uint32 &jobs) {
+	using Common::CLI::NoOption;
+	using Common::CLI::kContinueParsing;
+	using Common::CLI::Parser;
+	using Common::CLI::ValGetter;
+	using Common::CLI::ValAssigner;
+	using Common::CLI::makeEndArgs;
+	using Common::CLI::makeAssigners;
+	using Aurora::GameID;
+
+	NoOption queryOpt(false, new ValGetter<Common::UString &>(query, "query"));
+	NoOption filesOpt(false, new ValGetter<std::vector<Common::UString> &>(files, "files[...]"));
+	Parser parser(argv[0], "BioWare GFF field query tool",
+	              "The query is a path of field labels, separated by \"/\" or \".\".\n"
+	              "A list element is selected by an index in square brackets. A \"*\"\n"
+	              "as label or index matches all fields or list elements. Examples:\n"
+	              "  ItemList[*].Tag\n"
+	              "  \"/Creature List[3]/Appearance_Type\"\n\n"
+	              "GFF4 field labels are numbers.\n\n"
+	              "Every match is printed as one line: the file, the path of the field,\n"
+	              "its type and its value, separated by tabs. Backslashes, tabs and\n"
+	              "line breaks within paths and values are written as \"\\\\\", \"\\t\",\n"
+	              "\"\\n\" and \"\\r\".\n\n"
+	              "Input files can be GFFs or ERF, MOD, HAK, SAV, NWM, RIM or ZIP archives.\n"
+	              "For archives, all GFFs within the archive are queried, optionally only\n"
+	              "those with the extension given by --type.\n",
+	              returnValue,
+	              makeEndArgs(&queryOpt, &filesOpt));
+
+	parser.addSpace();
+	parser.addOption("type", 't', "Only query resources with this extension within archives",
+	                 kContinueParsing, new ValGetter<Common::UString &>(typeFilter, "ext"));
+	parser.addOption("jobs", 'j', "Number of threads to query archives with (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
+	parser.addSpace();
+	parser.addOption("cp1252", "Read GFF4 strings as Windows CP-1252", kContinueParsing,
+	                 makeAssigners(new ValAssigner<Common::Encoding>(Common::kEncodingCP1252,
+	                 encoding)));
+	parser.addSpace();
+	parser.addOption("nwn", "Use Neverwinter Nights encodings", kContinueParsing,
+	                 makeAssigners(new ValAssigner<GameID>(Aurora::kGameIDNWN, game)));
+	parser.addOption("nwn2", "Use Neverwinter Nights 2 encodings", kContinueParsing,
+	                 makeAssigners(new ValAssigner<GameID>(Aurora::kGameIDNWN2, game)));
+	parser.addOption("kotor", "Use Knights of the Old Republic encodings", kContinueParsing,
+	                 makeAssigners(new ValAssigner<GameID>(Aurora::kGameIDKotOR, game)));
+	parser.addOption("kotor2", "Use Knights of the Old Republic II encodings", kContinueParsing,
+	                 makeAssigners(new ValAssigner<GameID>(Aurora::kGameIDKotOR2, game)));
+	parser.addOption("jade", "Use Jade Empire encodings", kContinueParsing,
+	                 makeAssigners(new ValAssigner<GameID>(Aurora::kGameIDJade, game)));
+	parser.addOption("witcher", "Use The Witcher encodings", kContinueParsing,
+	                 makeAssigners(new ValAssigner<GameID>(Aurora::kGameIDWitcher, game)));
+	parser.addOption("dragonage", "Use Dragon Age encodings", kContinueParsing,
+	                 makeAssigners(new ValAssigner<GameID>(Aurora::kGameIDDragonAge, game)));
+	parser.addOption("dragonage2", "Use Dragon Age II encodings", kContinueParsing,
+	                 makeAssigners(new ValAssigner<GameID>(Aurora::kGameIDDragonAge2, game)));
+
+	return parser.process(argv);
+}
+
+Aurora::Archive *openArchive(const Common::UString &file, Aurora::FileType type) {
+	switch (type) {
+		case Aurora::kFileTypeERF:
+		case Aurora::kFileTypeMOD:
+		case Aurora::kFileTypeHAK:
+		case Aurora::kFileTypeSAV:
+		case Aurora::kFileTypeNWM:
+			return new Aurora::ERFFile(Common::mapOrReadFile(file));
+
+		case Aurora::kFileTypeRIM:
+		case Aurora::kFileTypeRIMP:
+			return new Aurora::RIMFile(Common::mapOrReadFile(file));
+
+		case Aurora::kFileTypeZIP:
+			return new Aurora::ZIPFile(Common::mapOrReadFile(file));
+
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+/** Evaluate the query against a GFF3 or GFF4 in this stream.
+ *
+ *  If the stream doesn't hold a GFF, throw if needGFF is set, otherwise return 0.
+ */
+Aurora::GFFQuery::Results *queryGFF(const Aurora::GFFQuery &query, Common::SeekableReadStream *stream,
+                                    Common::Encoding encoding, bool needGFF) {
+
+	Common::ScopedPtr<Common::SeekableReadStream> gff(stream);
+
+	uint32 id = 0xFFFFFFFF, version = 0xFFFFFFFF;
+	if (gff->size() >= 8) {
+		id      = gff->readUint32BE();
+		version = gff->readUint32BE();
+	}
+
+	gff->seek(0);
+
+	Common::ScopedPtr<Aurora::GFFQuery::Results> results(new Aurora::GFFQuery::Results);
+
+	if        ((version == kVersion32) || (version == kVersion33)) {
+		const Aurora::GFF3File gff3(gff.release(), 0xFFFFFFFF, false, true);
+
+		query.evaluate(gff3.getTopLevel(), *results);
+
+	} else if ((version == kVersion40) || (version == kVersion41)) {
+		const Aurora::GFF4File gff4(gff.release());
+
+		query.evaluate(gff4.getTopLevel(), *results, encoding);
+
+	} else if (needGFF) {
+		throw Common::Exception("Not a GFF file (%s, %s)",
+		                        Common::debugTag(id).c_str(), Common::debugTag(version).c_str());
+	} else
+		return 0;
+
+	return results.release();
+}
+
+void printResults(Common::WriteStream &out, const Common::UString &source, const Aurora::GFFQuery::Results &results) {
+	for (Aurora::GFFQuery::Results::const_iterator r = results.begin(); r != results.end(); ++r)
+		out.writeString(source + "\t" + Aurora::GFFQuery::escape(r->path) + "\t" + r->type + "\t" +
+		                Aurora::GFFQuery::escape(r->value) + "\n");
+}
+
+/** Query a GFF file, or all GFFs within an archive. Return false if anything failed. */
+bool queryFile(const Aurora::GFFQuery &query, const Common::UString &file, Common::WriteStream &out,
+               Common::Encoding encoding, Aurora::GameID game, const Common::UString &typeFilter, size_t threads) {
+
+	try {
+		Common::ScopedPtr<Aurora::Archive> archive(openArchive(file, TypeMan.getFileType(file)));
+		if (!archive) {
+			Common::ScopedPtr<Aurora::GFFQuery::Results>
+				results(queryGFF(query, Common::mapOrReadFile(file), encoding, true));
+
+			printResults(out, file, *results);
+			return true;
+		}
+
+		const Common::UString filterExt = "." + typeFilter;
+
+		// Collect the resources to query, with their full names
+		std::vector<uint32> indices;
+		std::vector<Common::UString> names;
+
+		const Aurora::Archive::ResourceList &resources = archive->getResources();
+		for (Aurora::Archive::ResourceList::const_iterator r = resources.begin(); r != resources.end(); ++r) {
+			const Aurora::FileType type = TypeMan.aliasFileType(r->type, game);
+
+			if (!typeFilter.empty() && !TypeMan.setFileType("", type).equalsIgnoreCase(filterExt))
+				continue;
+
+			indices.push_back(r->index);
+			names.push_back(TypeMan.addFileType(r->name, type));
+		}
+
+		if (!archive->canReadConcurrently())
+			threads = 1;
+
+		bool failed = false;
+
+		Common::parallelOrdered<Aurora::GFFQuery::Results>(threads, indices.size(), [&](size_t i) {
+			return queryGFF(query, archive->getResource(indices[i]), encoding, !typeFilter.empty());
+
+		}, [&](size_t i, Common::ParallelResult<Aurora::GFFQuery::Results> &result) {
+			const Common::UString source = file + ":" + names[i];
+
+			try {
+				Common::ScopedPtr<Aurora::GFFQuery::Results> results(result.release());
+				if (results)
+					printResults(out, source, *results);
+
+			} catch (Common::Exception &e) {
+				e.add("Failed querying \"%s\"", source.c_str());
+				Common::printException(e, "WARNING: ");
+
+				failed = true;
+			}
+		});
+
+		return !failed;
+
+	} catch (Common::Exception &e) {
+		e.add("Failed querying \"%s\"", file.c_str());
+		Common::printException(e, "WARNING: ");
+	}
+
+	return false;
+}
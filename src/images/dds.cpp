@@ -44,8 +44,12 @@ static const uint32 kPixelFlagsIsRGB     = 0x00000040;
 
 namespace Images {
 
-DDS::DDS(Common::SeekableReadStream &dds) {
+DDS::DDS(Common::SeekableReadStream &dds, bool keepCompressed) {
 	load(dds);
+
+	// In xoreos-tools, we usually want decompressed images
+	if (!keepCompressed)
+		decompress();
 }
 
 DDS::~DDS() {
@@ -77,9 +81,6 @@ void DDS::load(Common::SeekableReadStream &dds) {
 		e.add("Failed reading DDS file");
 		throw;
 	}
-
-	// In xoreos-tools, we always want decompressed images
-	decompress();
 }
 
 void DDS::readHeader(Common::SeekableReadStream &dds, DataType &dataType) {
@@ -43,7 +43,8 @@ namespace Images {
  */
 class DDS : public Decoder {
 public:
-	DDS(Common::SeekableReadStream &dds);
+	/** Read the image. Compressed image data is decompressed, unless keepCompressed is true. */
+	DDS(Common::SeekableReadStream &dds, bool keepCompressed = false);
 	~DDS();
 
 	/** Return true if the data within this stream is a DDS image. */
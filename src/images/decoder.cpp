@@ -23,19 +23,26 @@
  */
 
 #include <cassert>
+#include <vector>
+#include <atomic>
 
-#include "src/common/scopedptr.h"
 #include "src/common/util.h"
 #include "src/common/error.h"
-#include "src/common/memreadstream.h"
+#include "src/common/parallel.h"
 
 #include "src/images/decoder.h"
 #include "src/images/util.h"
 #include "src/images/s3tc.h"
 #include "src/images/dumptga.h"
+#include "src/images/dumpdds.h"
 
 namespace Images {
 
+/** Number of rows of pixels decompressed in one go, when running in parallel. */
+static const int kDecompressRows = 64;
+
+static std::atomic<size_t> decompressThreadCount(1);
+
 Decoder::MipMap::MipMap() : width(0), height(0), size(0) {
 }
 
@@ -136,7 +143,7 @@ const Decoder::MipMap &Decoder::getMipMap(size_t mipMap, size_t layer) const {
 	return *_mipMaps[index];
 }
 
-void Decoder::decompress(MipMap &out, const MipMap &in, PixelFormat format) {
+void Decoder::createDecompressed(MipMap &out, const MipMap &in, PixelFormat format) {
 	if ((format != kPixelFormatDXT1) &&
 	    (format != kPixelFormatDXT3) &&
 	    (format != kPixelFormatDXT5))
@@ -152,29 +159,84 @@ void Decoder::decompress(MipMap &out, const MipMap &in, PixelFormat format) {
 	out.size   = MAX(out.width * out.height * 4, 64);
 
 	out.data.reset(new byte[out.size]);
+}
+
+void Decoder::decompressRows(MipMap &out, const MipMap &in, PixelFormat format, int y, int height) {
+	const byte *src     = in.data.get();
+	size_t      srcSize = in.size;
+
+	byte *dest = out.data.get();
+
+	if ((y > 0) || (height < in.height)) {
+		// Only full rows of blocks can be decompressed separately
+		assert(((y % 4) == 0) && ((height % 4) == 0));
 
-	Common::ScopedPtr<Common::MemoryReadStream> stream(new Common::MemoryReadStream(in.data.get(), in.size));
+		const size_t blockSize = (format == kPixelFormatDXT1) ? 8 : 16;
+		const size_t offset    = (y / 4) * ((in.width + 3) / 4) * blockSize;
+
+		if (offset > srcSize)
+			throw Common::Exception(Common::kReadError);
+
+		src     += offset;
+		srcSize -= offset;
+
+		dest += y * out.width * 4;
+	}
 
 	if      (format == kPixelFormatDXT1)
-		decompressDXT1(out.data.get(), *stream, out.width, out.height, out.width * 4);
+		decompressDXT1(dest, src, srcSize, out.width, height, out.width * 4);
 	else if (format == kPixelFormatDXT3)
-		decompressDXT3(out.data.get(), *stream, out.width, out.height, out.width * 4);
+		decompressDXT3(dest, src, srcSize, out.width, height, out.width * 4);
 	else if (format == kPixelFormatDXT5)
-		decompressDXT5(out.data.get(), *stream, out.width, out.height, out.width * 4);
+		decompressDXT5(dest, src, srcSize, out.width, height, out.width * 4);
+}
+
+void Decoder::decompress(MipMap &out, const MipMap &in, PixelFormat format) {
+	createDecompressed(out, in, format);
+	decompressRows(out, in, format, 0, in.height);
+}
+
+void Decoder::setThreadCount(size_t threadCount) {
+	decompressThreadCount = Common::getThreadCount(threadCount);
 }
 
 void Decoder::decompress() {
 	if (!isCompressed())
 		return;
 
-	for (MipMaps::iterator m = _mipMaps.begin(); m != _mipMaps.end(); ++m) {
-		MipMap decompressed;
+	struct Job {
+		size_t mipMap;
+		int y;
+		int height;
+	};
+
+	MipMaps decompressed;
+	std::vector<Job> jobs;
+
+	for (size_t i = 0; i < _mipMaps.size(); i++) {
+		const MipMap &in = *_mipMaps[i];
 
-		decompress(decompressed, **m, _format);
+		decompressed.push_back(new MipMap);
+		createDecompressed(*decompressed.back(), in, _format);
 
-		decompressed.swap(**m);
+		// Large mip maps are split into several jobs of whole block rows each
+		const int rows = ((in.height % 4) == 0) ? kDecompressRows : in.height;
+
+		for (int y = 0; y < in.height; y += rows) {
+			const Job job = { i, y, MIN(rows, in.height - y) };
+			jobs.push_back(job);
+		}
 	}
 
+	Common::parallelFor(decompressThreadCount, jobs.size(), [&](size_t i) {
+		const Job &job = jobs[i];
+
+		decompressRows(*decompressed[job.mipMap], *_mipMaps[job.mipMap], _format, job.y, job.height);
+	});
+
+	for (size_t i = 0; i < _mipMaps.size(); i++)
+		decompressed[i]->swap(*_mipMaps[i]);
+
 	_format = kPixelFormatR8G8B8A8;
 }
 
@@ -193,6 +255,13 @@ void Decoder::dumpTGA(const Common::UString &fileName) const {
 	Images::dumpTGA(fileName, decoder);
 }
 
+void Decoder::dumpDDS(const Common::UString &fileName) const {
+	if (_mipMaps.size() < 1)
+		throw Common::Exception("Image contains no mip maps");
+
+	Images::dumpDDS(fileName, *this);
+}
+
 void Decoder::flipHorizontally() {
 	decompress();
 
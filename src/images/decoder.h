@@ -87,6 +87,16 @@ public:
 
 	/** Dump the image into a TGA. */
 	void dumpTGA(const Common::UString &fileName) const;
+	/** Dump the image into a DDS, keeping compressed image data as it is. */
+	void dumpDDS(const Common::UString &fileName) const;
+
+	/** Set the number of threads used to decompress images.
+	 *
+	 *  Mip maps, layers and rows of blocks of large mip maps are then all
+	 *  decompressed in parallel. 0 means one thread per CPU core. The
+	 *  default is 1, decompressing everything on the calling thread.
+	 */
+	static void setThreadCount(size_t threadCount);
 
 	/** Flip the whole image horizontally. */
 	void flipHorizontally();
@@ -112,6 +122,12 @@ protected:
 	void decompress();
 
 	static void decompress(MipMap &out, const MipMap &in, PixelFormat format);
+
+private:
+	/** Check the dimensions of a compressed mip map and allocate its decompressed version. */
+	static void createDecompressed(MipMap &out, const MipMap &in, PixelFormat format);
+	/** Decompress the rows [y, y + height) of a compressed mip map. */
+	static void decompressRows(MipMap &out, const MipMap &in, PixelFormat format, int y, int height);
 };
 
 } // End of namespace Images
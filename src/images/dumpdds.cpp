@@ -0,0 +1,199 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A simple DDS image dumper.
+ */
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/ustring.h"
+#include "src/common/writefile.h"
+
+#include "src/images/dumpdds.h"
+#include "src/images/decoder.h"
+#include "src/images/util.h"
+
+static const uint32 kDDSID  = MKTAG('D', 'D', 'S', ' ');
+static const uint32 kDXT1ID = MKTAG('D', 'X', 'T', '1');
+static const uint32 kDXT3ID = MKTAG('D', 'X', 'T', '3');
+static const uint32 kDXT5ID = MKTAG('D', 'X', 'T', '5');
+
+static const uint32 kHeaderFlagsCaps        = 0x00000001;
+static const uint32 kHeaderFlagsHeight      = 0x00000002;
+static const uint32 kHeaderFlagsWidth       = 0x00000004;
+static const uint32 kHeaderFlagsPitch       = 0x00000008;
+static const uint32 kHeaderFlagsPixelFormat = 0x00001000;
+static const uint32 kHeaderFlagsHasMipMaps  = 0x00020000;
+static const uint32 kHeaderFlagsLinearSize  = 0x00080000;
+
+static const uint32 kPixelFlagsHasAlpha  = 0x00000001;
+static const uint32 kPixelFlagsHasFourCC = 0x00000004;
+static const uint32 kPixelFlagsIsRGB     = 0x00000040;
+
+static const uint32 kCapsComplex = 0x00000008;
+static const uint32 kCapsTexture = 0x00001000;
+static const uint32 kCapsMipMap  = 0x00400000;
+
+static const uint32 kCaps2CubeMap         = 0x00000200;
+static const uint32 kCaps2CubeMapAllFaces = 0x0000FC00;
+
+namespace Images {
+
+struct DDSPixelFormat {
+	uint32 flags;
+	uint32 fourCC;
+	uint32 bitCount;
+	uint32 rBitMask;
+	uint32 gBitMask;
+	uint32 bBitMask;
+	uint32 aBitMask;
+};
+
+static DDSPixelFormat getDDSPixelFormat(PixelFormat format) {
+	static const DDSPixelFormat kFormats[] = {
+		{ kPixelFlagsIsRGB                      , 0, 24, 0x000000FF, 0x0000FF00, 0x00FF0000, 0x00000000 },
+		{ kPixelFlagsIsRGB                      , 0, 24, 0x00FF0000, 0x0000FF00, 0x000000FF, 0x00000000 },
+		{ kPixelFlagsIsRGB | kPixelFlagsHasAlpha, 0, 32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000 },
+		{ kPixelFlagsIsRGB | kPixelFlagsHasAlpha, 0, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000 },
+		{ kPixelFlagsIsRGB | kPixelFlagsHasAlpha, 0, 16, 0x00007C00, 0x000003E0, 0x0000001F, 0x00008000 },
+		{ kPixelFlagsIsRGB                      , 0, 16, 0x0000F800, 0x000007E0, 0x0000001F, 0x00000000 },
+		{ kPixelFlagsHasFourCC, kDXT1ID, 0, 0, 0, 0, 0 },
+		{ kPixelFlagsHasFourCC, kDXT3ID, 0, 0, 0, 0, 0 },
+		{ kPixelFlagsHasFourCC, kDXT5ID, 0, 0, 0, 0, 0 }
+	};
+
+	switch (format) {
+		case kPixelFormatR8G8B8:
+			return kFormats[0];
+		case kPixelFormatB8G8R8:
+			return kFormats[1];
+		case kPixelFormatR8G8B8A8:
+			return kFormats[2];
+		case kPixelFormatB8G8R8A8:
+			return kFormats[3];
+		case kPixelFormatA1R5G5B5:
+			return kFormats[4];
+		case kPixelFormatR5G6B5:
+			return kFormats[5];
+		case kPixelFormatDXT1:
+			return kFormats[6];
+		case kPixelFormatDXT3:
+			return kFormats[7];
+		case kPixelFormatDXT5:
+			return kFormats[8];
+
+		default:
+			break;
+	}
+
+	throw Common::Exception("Unsupported pixel format: %d", (int) format);
+}
+
+static void writeHeader(Common::WriteStream &stream, const Decoder &image, const DDSPixelFormat &format) {
+	const Decoder::MipMap &mipMap = image.getMipMap(0);
+
+	const bool compressed = (format.flags & kPixelFlagsHasFourCC) != 0;
+	const bool hasMipMaps = image.getMipMapCount() > 1;
+
+	uint32 flags = kHeaderFlagsCaps | kHeaderFlagsHeight | kHeaderFlagsWidth | kHeaderFlagsPixelFormat;
+
+	flags |= compressed ? kHeaderFlagsLinearSize : kHeaderFlagsPitch;
+	if (hasMipMaps)
+		flags |= kHeaderFlagsHasMipMaps;
+
+	const uint32 pitchOrLinearSize = compressed ?
+		getDataSize(image.getFormat(), mipMap.width, mipMap.height) :
+		getDataSize(image.getFormat(), mipMap.width, 1);
+
+	uint32 caps1 = kCapsTexture, caps2 = 0;
+	if (hasMipMaps)
+		caps1 |= kCapsComplex | kCapsMipMap;
+	if (image.isCubeMap()) {
+		caps1 |= kCapsComplex;
+		caps2 |= kCaps2CubeMap | kCaps2CubeMapAllFaces;
+	}
+
+	stream.writeUint32BE(kDDSID);
+
+	stream.writeUint32LE(124); // Header size
+	stream.writeUint32LE(flags);
+	stream.writeUint32LE(mipMap.height);
+	stream.writeUint32LE(mipMap.width);
+	stream.writeUint32LE(pitchOrLinearSize);
+	stream.writeUint32LE(0); // Depth
+	stream.writeUint32LE(hasMipMaps ? image.getMipMapCount() : 0);
+
+	for (size_t i = 0; i < 11; i++)
+		stream.writeUint32LE(0); // Reserved
+
+	stream.writeUint32LE(32); // Pixel format size
+	stream.writeUint32LE(format.flags);
+	stream.writeUint32BE(format.fourCC);
+	stream.writeUint32LE(format.bitCount);
+	stream.writeUint32LE(format.rBitMask);
+	stream.writeUint32LE(format.gBitMask);
+	stream.writeUint32LE(format.bBitMask);
+	stream.writeUint32LE(format.aBitMask);
+
+	stream.writeUint32LE(caps1);
+	stream.writeUint32LE(caps2);
+	stream.writeUint32LE(0); // Caps3
+	stream.writeUint32LE(0); // Caps4
+	stream.writeUint32LE(0); // Reserved
+}
+
+void dumpDDS(Common::WriteStream &stream, const Decoder &image) {
+	if ((image.getLayerCount() < 1) || (image.getMipMapCount() < 1))
+		throw Common::Exception("No image");
+
+	// Without the DX10 extension, DDS can only hold several layers as the 6 sides of a cube map
+	if ((image.getLayerCount() > 1) && !image.isCubeMap())
+		throw Common::Exception("dumpDDS(): Unsupported image with %u layers", (uint) image.getLayerCount());
+
+	const DDSPixelFormat format = getDDSPixelFormat(image.getFormat());
+
+	writeHeader(stream, image, format);
+
+	// All mip maps of the first layer, then all mip maps of the second layer, etc.
+	for (size_t i = 0; i < image.getLayerCount(); i++) {
+		for (size_t j = 0; j < image.getMipMapCount(); j++) {
+			const Decoder::MipMap &mipMap = image.getMipMap(j, i);
+
+			// Some formats pad tiny mip maps, which DDS doesn't
+			const uint32 size = getDataSize(image.getFormat(), mipMap.width, mipMap.height);
+			if (mipMap.size < size)
+				throw Common::Exception("dumpDDS(): Mip map %u of layer %u is too small (%u < %u)",
+				                        (uint) j, (uint) i, mipMap.size, size);
+
+			stream.write(mipMap.data.get(), size);
+		}
+	}
+}
+
+void dumpDDS(const Common::UString &fileName, const Decoder &image) {
+	Common::WriteFile file(fileName);
+
+	dumpDDS(file, image);
+
+	file.flush();
+}
+
+} // End of namespace Images
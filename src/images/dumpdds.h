@@ -0,0 +1,53 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A simple DDS image dumper.
+ */
+
+#ifndef IMAGES_DUMPDDS_H
+#define IMAGES_DUMPDDS_H
+
+#include "src/common/types.h"
+
+#include "src/images/types.h"
+
+namespace Common {
+	class UString;
+	class WriteStream;
+}
+
+namespace Images {
+
+class Decoder;
+
+/** Dump image into a standard DDS file.
+ *
+ *  The image data is written as it is, including all mip maps and the
+ *  sides of cube maps. Compressed DXTn data stays compressed.
+ */
+void dumpDDS(const Common::UString &fileName, const Decoder &image);
+
+/** Write an image as a standard DDS into a stream. */
+void dumpDDS(Common::WriteStream &stream, const Decoder &image);
+
+} // End of namespace Images
+
+#endif // IMAGES_DUMPDDS_H
@@ -23,98 +23,166 @@
  */
 
 #include <cstdio>
+#include <cstring>
 
+#include "src/common/util.h"
 #include "src/common/scopedptr.h"
 #include "src/common/error.h"
 #include "src/common/ustring.h"
 #include "src/common/writefile.h"
 
+#include "src/images/dumptga.h"
 #include "src/images/decoder.h"
 
 namespace Images {
 
-static void writePixel(Common::WriteStream &file, const byte *&data, PixelFormat format) {
-	if (format == kPixelFormatR8G8B8) {
-		file.writeByte(data[2]);
-		file.writeByte(data[1]);
-		file.writeByte(data[0]);
-		file.writeByte(0xFF);
-		data += 3;
-	} else if (format == kPixelFormatB8G8R8) {
-		file.writeByte(data[0]);
-		file.writeByte(data[1]);
-		file.writeByte(data[2]);
-		file.writeByte(0xFF);
-		data += 3;
-	} else if (format == kPixelFormatR8G8B8A8) {
-		file.writeByte(data[2]);
-		file.writeByte(data[1]);
-		file.writeByte(data[0]);
-		file.writeByte(data[3]);
-		data += 4;
-	} else if (format == kPixelFormatB8G8R8A8) {
-		file.writeByte(data[0]);
-		file.writeByte(data[1]);
-		file.writeByte(data[2]);
-		file.writeByte(data[3]);
-		data += 4;
-	} else if (format == kPixelFormatR5G6B5) {
-		uint16 color = READ_LE_UINT16(data);
-		file.writeByte( color & 0x001F);
-		file.writeByte((color & 0x07E0) >>  5);
-		file.writeByte((color & 0xF800) >> 11);
-		file.writeByte(0xFF);
-		data += 2;
-	} else if (format == kPixelFormatA1R5G5B5) {
-		uint16 color = READ_LE_UINT16(data);
-		file.writeByte( color & 0x001F);
-		file.writeByte((color & 0x03E0) >>  5);
-		file.writeByte((color & 0x7C00) >> 10);
-		file.writeByte((color & 0x8000) ? 0xFF : 0x00);
-		data += 2;
-	} else if (format == kPixelFormatDepth16) {
-		uint16 color = READ_LE_UINT16(data);
-		file.writeByte(color / 128);
-		file.writeByte(color / 128);
-		file.writeByte(color / 128);
-		file.writeByte((color >= 0x7FFF) ? 0x00 : 0xFF);
-
-		data += 2;
-	} else
-		throw Common::Exception("Unsupported pixel format: %d", (int) format);
-
+/** Convert a row of width pixels into 32-bit BGRA. */
+static void convertRow(byte *dest, const byte *src, uint32 width, PixelFormat format) {
+	switch (format) {
+		case kPixelFormatR8G8B8:
+			for (uint32 i = 0; i < width; i++, dest += 4, src += 3) {
+				dest[0] = src[2];
+				dest[1] = src[1];
+				dest[2] = src[0];
+				dest[3] = 0xFF;
+			}
+			break;
+
+		case kPixelFormatB8G8R8:
+			for (uint32 i = 0; i < width; i++, dest += 4, src += 3) {
+				dest[0] = src[0];
+				dest[1] = src[1];
+				dest[2] = src[2];
+				dest[3] = 0xFF;
+			}
+			break;
+
+		case kPixelFormatR8G8B8A8:
+			for (uint32 i = 0; i < width; i++, dest += 4, src += 4) {
+				dest[0] = src[2];
+				dest[1] = src[1];
+				dest[2] = src[0];
+				dest[3] = src[3];
+			}
+			break;
+
+		case kPixelFormatB8G8R8A8:
+			std::memcpy(dest, src, width * 4);
+			break;
+
+		case kPixelFormatR5G6B5:
+			for (uint32 i = 0; i < width; i++, dest += 4, src += 2) {
+				const uint16 color = READ_LE_UINT16(src);
+
+				dest[0] =  color & 0x001F;
+				dest[1] = (color & 0x07E0) >>  5;
+				dest[2] = (color & 0xF800) >> 11;
+				dest[3] = 0xFF;
+			}
+			break;
+
+		case kPixelFormatA1R5G5B5:
+			for (uint32 i = 0; i < width; i++, dest += 4, src += 2) {
+				const uint16 color = READ_LE_UINT16(src);
+
+				dest[0] =  color & 0x001F;
+				dest[1] = (color & 0x03E0) >>  5;
+				dest[2] = (color & 0x7C00) >> 10;
+				dest[3] = (color & 0x8000) ? 0xFF : 0x00;
+			}
+			break;
+
+		case kPixelFormatDepth16:
+			for (uint32 i = 0; i < width; i++, dest += 4, src += 2) {
+				const uint16 color = READ_LE_UINT16(src);
+
+				dest[0] = color / 128;
+				dest[1] = color / 128;
+				dest[2] = color / 128;
+				dest[3] = (color >= 0x7FFF) ? 0x00 : 0xFF;
+			}
+			break;
+
+		default:
+			throw Common::Exception("Unsupported pixel format: %d", (int) format);
+	}
 }
 
-static Common::WriteStream *openTGA(const Common::UString &fileName, int width, int height) {
-	Common::WriteFile *file = new Common::WriteFile(fileName);
+/** Return the number of bytes a pixel takes up in the source data. */
+static uint32 getSourceBPP(PixelFormat format) {
+	switch (format) {
+		case kPixelFormatR8G8B8:
+		case kPixelFormatB8G8R8:
+			return 3;
+
+		case kPixelFormatR8G8B8A8:
+		case kPixelFormatB8G8R8A8:
+			return 4;
+
+		case kPixelFormatR5G6B5:
+		case kPixelFormatA1R5G5B5:
+		case kPixelFormatDepth16:
+			return 2;
+
+		default:
+			break;
+	}
 
-	file->writeByte(0);     // ID Length
-	file->writeByte(0);     // Palette size
-	file->writeByte(2);     // Unmapped RGB
-	file->writeUint32LE(0); // Color map
-	file->writeByte(0);     // Color map
-	file->writeUint16LE(0); // X
-	file->writeUint16LE(0); // Y
+	throw Common::Exception("Unsupported pixel format: %d", (int) format);
+}
 
-	file->writeUint16LE(width);
-	file->writeUint16LE(height);
+static void writeTGAHeader(Common::WriteStream &stream, int width, int height) {
+	stream.writeByte(0);     // ID Length
+	stream.writeByte(0);     // Palette size
+	stream.writeByte(2);     // Unmapped RGB
+	stream.writeUint32LE(0); // Color map
+	stream.writeByte(0);     // Color map
+	stream.writeUint16LE(0); // X
+	stream.writeUint16LE(0); // Y
 
-	file->writeByte(32); // Pixel depths
+	stream.writeUint16LE(width);
+	stream.writeUint16LE(height);
 
-	file->writeByte(0);
+	stream.writeByte(32); // Pixel depths
 
-	return file;
+	stream.writeByte(0);
 }
 
+/** Size of the buffer the converted pixels are collected in before writing. */
+static const size_t kBufferSize = 256 * 1024;
+
 static void writeMipMap(Common::WriteStream &stream, const Decoder::MipMap &mipMap, PixelFormat format) {
+	if ((mipMap.width <= 0) || (mipMap.height <= 0))
+		return;
+
+	const uint32 srcPitch  = mipMap.width * getSourceBPP(format);
+	const uint32 destPitch = mipMap.width * 4;
+
+	const uint32 rowsPerChunk = MIN<uint32>(MAX<uint32>(kBufferSize / destPitch, 1), mipMap.height);
+
+	Common::ScopedArray<byte> buffer(new byte[rowsPerChunk * destPitch]);
+
 	const byte *data = mipMap.data.get();
 
-	uint32 count = mipMap.width * mipMap.height;
-	while (count-- > 0)
-		writePixel(stream, data, format);
+	for (uint32 y = 0; y < (uint32) mipMap.height; y += rowsPerChunk) {
+		const uint32 rows = MIN<uint32>(rowsPerChunk, mipMap.height - y);
+
+		for (uint32 i = 0; i < rows; i++, data += srcPitch)
+			convertRow(buffer.get() + i * destPitch, data, mipMap.width, format);
+
+		stream.write(buffer.get(), rows * destPitch);
+	}
 }
 
 void dumpTGA(const Common::UString &fileName, const Decoder &image) {
+	Common::WriteFile file(fileName);
+
+	dumpTGA(file, image);
+
+	file.flush();
+}
+
+void dumpTGA(Common::WriteStream &stream, const Decoder &image) {
 	if ((image.getLayerCount() < 1) || (image.getMipMapCount() < 1))
 		throw Common::Exception("No image");
 
@@ -130,12 +198,10 @@ void dumpTGA(const Common::UString &fileName, const Decoder &image) {
 		height += mipMap.height;
 	}
 
-	Common::ScopedPtr<Common::WriteStream> file(openTGA(fileName, width, height));
+	writeTGAHeader(stream, width, height);
 
 	for (size_t i = 0; i < image.getLayerCount(); i++)
-		writeMipMap(*file, image.getMipMap(0, i), image.getFormat());
-
-	file->flush();
+		writeMipMap(stream, image.getMipMap(0, i), image.getFormat());
 }
 
 } // End of namespace Images
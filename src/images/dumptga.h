@@ -31,6 +31,7 @@
 
 namespace Common {
 	class UString;
+	class WriteStream;
 }
 
 namespace Images {
@@ -40,6 +41,9 @@ class Decoder;
 /** Dump image into a TGA file. */
 void dumpTGA(const Common::UString &fileName, const Decoder &image);
 
+/** Write an image as a TGA into a stream. */
+void dumpTGA(Common::WriteStream &stream, const Decoder &image);
+
 } // End of namespace Images
 
 #endif // IMAGES_DUMPTGA_H
@@ -28,6 +28,7 @@ src_images_libimages_la_SOURCES += \
     src/images/s3tc.h \
     src/images/decoder.h \
     src/images/dumptga.h \
+    src/images/dumpdds.h \
     src/images/winiconimage.h \
     src/images/tga.h \
     src/images/dds.h \
@@ -48,6 +49,7 @@ src_images_libimages_la_SOURCES += \
     src/images/s3tc.cpp \
     src/images/decoder.cpp \
     src/images/dumptga.cpp \
+    src/images/dumpdds.cpp \
     src/images/winiconimage.cpp \
     src/images/tga.cpp \
     src/images/dds.cpp \
@@ -22,7 +22,10 @@
  *  Manual S3TC DXTn decompression methods.
  */
 
+#include <cstring>
+
 #include "src/common/util.h"
+#include "src/common/error.h"
 #include "src/common/readstream.h"
 
 #include "src/images/s3tc.h"
@@ -216,4 +219,201 @@ void decompressDXT5(byte *dest, Common::SeekableReadStream &src, uint32 width, u
 	}
 }
 
+/* Block decoders working directly on a raw buffer.
+ *
+ * These produce exactly the same output as the stream-based decoders above,
+ * which are kept as the reference implementation. Instead of going through
+ * the stream and doing floating point math for every block, the colour
+ * interpolation is looked up in small tables built once from interpolate32(),
+ * and a whole decoded block is written out row by row. */
+
+enum InterpolationWeight {
+	kWeightOneThird  = 0,
+	kWeightTwoThirds    ,
+	kWeightHalf         ,
+	kWeightMAX
+};
+
+static const double kInterpolationWeights[kWeightMAX] = { 0.333333f, 0.666666f, 0.5f };
+
+/** Interpolation results for all possible 565 channel values. */
+struct InterpolationTables {
+	byte redBlue[kWeightMAX][32][32];
+	byte green  [kWeightMAX][64][64];
+	byte opaque [kWeightMAX]; ///< Interpolated alpha between two opaque colors.
+
+	InterpolationTables() {
+		for (size_t w = 0; w < kWeightMAX; w++) {
+			const double weight = kInterpolationWeights[w];
+
+			for (uint32 i = 0; i < 32; i++)
+				for (uint32 j = 0; j < 32; j++)
+					redBlue[w][i][j] = interpolate32(weight, (i << 3) << 24, (j << 3) << 24) >> 24;
+
+			for (uint32 i = 0; i < 64; i++)
+				for (uint32 j = 0; j < 64; j++)
+					green[w][i][j] = (interpolate32(weight, (i << 2) << 16, (j << 2) << 16) >> 16) & 0xFF;
+
+			opaque[w] = interpolate32(weight, 0xFF, 0xFF) & 0xFF;
+		}
+	}
+};
+
+static const InterpolationTables &getInterpolationTables() {
+	static const InterpolationTables tables;
+
+	return tables;
+}
+
+/** Build the 4-color palette of a block, as R, G, B, A bytes. */
+static void buildPalette(byte palette[4][4], uint16 color_0, uint16 color_1, bool dxt1) {
+	const InterpolationTables &tables = getInterpolationTables();
+
+	const uint32 r0 = color_0 >> 11, g0 = (color_0 >> 5) & 0x3F, b0 = color_0 & 0x1F;
+	const uint32 r1 = color_1 >> 11, g1 = (color_1 >> 5) & 0x3F, b1 = color_1 & 0x1F;
+
+	const byte alpha = dxt1 ? 0xFF : 0x00;
+
+	palette[0][0] = r0 << 3;
+	palette[0][1] = g0 << 2;
+	palette[0][2] = b0 << 3;
+	palette[0][3] = alpha;
+
+	palette[1][0] = r1 << 3;
+	palette[1][1] = g1 << 2;
+	palette[1][2] = b1 << 3;
+	palette[1][3] = alpha;
+
+	if (!dxt1 || (color_0 > color_1)) {
+		for (size_t i = 0; i < 2; i++) {
+			const InterpolationWeight w = (i == 0) ? kWeightOneThird : kWeightTwoThirds;
+
+			palette[2 + i][0] = tables.redBlue[w][r0][r1];
+			palette[2 + i][1] = tables.green  [w][g0][g1];
+			palette[2 + i][2] = tables.redBlue[w][b0][b1];
+			palette[2 + i][3] = dxt1 ? tables.opaque[w] : 0x00;
+		}
+
+		return;
+	}
+
+	palette[2][0] = tables.redBlue[kWeightHalf][r0][r1];
+	palette[2][1] = tables.green  [kWeightHalf][g0][g1];
+	palette[2][2] = tables.redBlue[kWeightHalf][b0][b1];
+	palette[2][3] = tables.opaque [kWeightHalf];
+
+	std::memset(palette[3], 0, 4);
+}
+
+/** Decode the color indices of a block into bw * bh pixels. */
+static void decodeColors(byte block[4][16], const byte *src, bool dxt1, uint32 bw, uint32 bh) {
+	byte palette[4][4];
+	buildPalette(palette, READ_LE_UINT16(src), READ_LE_UINT16(src + 2), dxt1);
+
+	uint32 cpx = READ_BE_UINT32(src + 4);
+
+	for (uint32 y = 0; y < bh; y++)
+		for (uint32 x = 0; x < bw; x++, cpx >>= 2)
+			std::memcpy(block[y] + x * 4, palette[cpx & 3], 4);
+}
+
+static void decodeAlphaDXT3(byte block[4][16], const byte *src, uint32 bw, uint32 bh) {
+	for (uint32 y = 0; y < bh; y++) {
+		const uint16 alpha = READ_LE_UINT16(src + y * 2);
+
+		for (uint32 x = 0; x < bw; x++)
+			block[y][x * 4 + 3] = ((alpha >> (x * 4)) & 0xF) << 4;
+	}
+}
+
+static void decodeAlphaDXT5(byte block[4][16], const byte *src, uint32 bw, uint32 bh) {
+	const uint32 alpha_0 = src[0];
+	const uint32 alpha_1 = src[1];
+
+	byte alphab[8];
+
+	alphab[0] = alpha_0;
+	alphab[1] = alpha_1;
+
+	if (alpha_0 > alpha_1) {
+		for (uint32 i = 1; i < 7; i++)
+			alphab[1 + i] = ((7 - i) * alpha_0 + i * alpha_1 + 3) / 7;
+	} else {
+		for (uint32 i = 1; i < 5; i++)
+			alphab[1 + i] = ((5 - i) * alpha_0 + i * alpha_1 + 2) / 5;
+
+		alphab[6] = 0;
+		alphab[7] = 255;
+	}
+
+	const uint64 alphabl = READ_LE_UINT32(src + 2) | ((uint64) READ_LE_UINT16(src + 6) << 32);
+
+	for (uint32 y = 0; y < bh; y++)
+		for (uint32 x = 0; x < bw; x++)
+			block[y][x * 4 + 3] = alphab[(alphabl >> (3 * (4 * (3 - y) + x))) & 7];
+}
+
+enum DXTFormat {
+	kDXT1,
+	kDXT3,
+	kDXT5
+};
+
+static void decompressDXT(byte *dest, const byte *src, size_t srcSize,
+                          uint32 width, uint32 height, uint32 pitch, DXTFormat format) {
+
+	const size_t blockSize = (format == kDXT1) ? 8 : 16;
+	const size_t blockCount = ((width + 3) / 4) * (size_t) ((height + 3) / 4);
+
+	if ((srcSize / blockSize) < blockCount)
+		throw Common::Exception(Common::kReadError);
+
+	const uint32 bw = MIN<uint32>(width , 4);
+	const uint32 bh = MIN<uint32>(height, 4);
+
+	byte block[4][16];
+
+	for (int32 ty = height; ty > 0; ty -= 4) {
+		for (uint32 tx = 0; tx < width; tx += 4, src += blockSize) {
+			switch (format) {
+				case kDXT1:
+					decodeColors(block, src, true, bw, bh);
+					break;
+
+				case kDXT3:
+					decodeColors(block, src + 8, false, bw, bh);
+					decodeAlphaDXT3(block, src, bw, bh);
+					break;
+
+				case kDXT5:
+					decodeColors(block, src + 8, false, bw, bh);
+					decodeAlphaDXT5(block, src, bw, bh);
+					break;
+			}
+
+			const uint32 rowWidth = MIN<uint32>(bw, width - tx);
+
+			for (uint32 y = 0; y < bh; y++) {
+				const uint32 destY = height - 1 - (ty - bh + y);
+				if (destY >= height)
+					continue;
+
+				std::memcpy(dest + destY * pitch + tx * 4, block[y], rowWidth * 4);
+			}
+		}
+	}
+}
+
+void decompressDXT1(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch) {
+	decompressDXT(dest, src, srcSize, width, height, pitch, kDXT1);
+}
+
+void decompressDXT3(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch) {
+	decompressDXT(dest, src, srcSize, width, height, pitch, kDXT3);
+}
+
+void decompressDXT5(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch) {
+	decompressDXT(dest, src, srcSize, width, height, pitch, kDXT5);
+}
+
 } // End of namespace Images
@@ -37,6 +37,13 @@ void decompressDXT1(byte *dest, Common::SeekableReadStream &src, uint32 width, u
 void decompressDXT3(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch);
 void decompressDXT5(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch);
 
+/* Faster versions of the above, decoding directly from a buffer of srcSize bytes.
+ * The output is identical to that of the stream-based functions. */
+
+void decompressDXT1(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch);
+void decompressDXT3(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch);
+void decompressDXT5(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch);
+
 } // End of namespace Images
 
 #endif // IMAGES_S3TC_H
@@ -40,8 +40,12 @@ static const byte kEncodingSwizzledBGRA = 0x0C;
 
 namespace Images {
 
-TPC::TPC(Common::SeekableReadStream &tpc) : _txiDataSize(0) {
+TPC::TPC(Common::SeekableReadStream &tpc, bool keepCompressed) : _txiDataSize(0) {
 	load(tpc);
+
+	// In xoreos-tools, we usually want decompressed images
+	if (!keepCompressed)
+		decompress();
 }
 
 TPC::~TPC() {
@@ -61,9 +65,6 @@ void TPC::load(Common::SeekableReadStream &tpc) {
 		e.add("Failed reading TPC file");
 		throw;
 	}
-
-	// In xoreos-tools, we always want decompressed images
-	decompress();
 }
 
 Common::SeekableReadStream *TPC::getTXI() const {
@@ -288,19 +289,6 @@ bool TPC::checkAnimated(uint32 &width, uint32 &height, uint32 &dataSize) {
 	return true;
 }
 
-void TPC::deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height) {
-	for (uint32 y = 0; y < height; y++) {
-		for (uint32 x = 0; x < width; x++) {
-			const uint32 offset = deSwizzleOffset(x, y, width, height) * 4;
-
-			*dst++ = src[offset + 0];
-			*dst++ = src[offset + 1];
-			*dst++ = src[offset + 2];
-			*dst++ = src[offset + 3];
-		}
-	}
-}
-
 void TPC::readData(Common::SeekableReadStream &tpc, byte encoding) {
 	for (MipMaps::iterator mipMap = _mipMaps.begin(); mipMap != _mipMaps.end(); ++mipMap) {
 
@@ -316,7 +304,7 @@ void TPC::readData(Common::SeekableReadStream &tpc, byte encoding) {
 			if (tpc.read(&tmp[0], (*mipMap)->size) != (*mipMap)->size)
 				throw Common::Exception(Common::kReadError);
 
-			deSwizzle((*mipMap)->data.get(), &tmp[0], (*mipMap)->width, (*mipMap)->height);
+			deSwizzle((*mipMap)->data.get(), &tmp[0], (*mipMap)->width, (*mipMap)->height, 4);
 
 		} else {
 			if (tpc.read((*mipMap)->data.get(), (*mipMap)->size) != (*mipMap)->size)
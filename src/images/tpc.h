@@ -43,7 +43,8 @@ namespace Images {
  */
 class TPC : public Decoder {
 public:
-	TPC(Common::SeekableReadStream &tpc);
+	/** Read the image. Compressed image data is decompressed, unless keepCompressed is true. */
+	TPC(Common::SeekableReadStream &tpc, bool keepCompressed = false);
 	~TPC();
 
 	/** Return the enclosed TXI data. */
@@ -67,8 +68,6 @@ private:
 	bool checkAnimated(uint32 &width, uint32 &height, uint32 &dataSize);
 	bool checkCubeMap(uint32 &width, uint32 &height);
 	void fixupCubeMap();
-
-	static void deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height);
 };
 
 } // End of namespace Images
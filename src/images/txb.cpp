@@ -36,11 +36,12 @@ static const byte kEncodingDXT5 = 0x0C;
 
 namespace Images {
 
-TXB::TXB(Common::SeekableReadStream &txb) : _dataSize(0), _txiDataSize(0) {
+TXB::TXB(Common::SeekableReadStream &txb, bool keepCompressed) : _dataSize(0), _txiDataSize(0) {
 	load(txb);
 
-	// In xoreos-tools, we always want decompressed images
-	decompress();
+	// In xoreos-tools, we usually want decompressed images
+	if (!keepCompressed)
+		decompress();
 }
 
 TXB::~TXB() {
@@ -159,17 +160,6 @@ void TXB::readHeader(Common::SeekableReadStream &txb, byte &encoding) {
 		throw Common::Exception("Couldn't read any mip maps");
 }
 
-void TXB::deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height, uint8 bpp) {
-	for (uint32 y = 0; y < height; y++) {
-		for (uint32 x = 0; x < width; x++) {
-			const uint32 offset = deSwizzleOffset(x, y, width, height) * bpp;
-
-			for (uint8 p = 0; p < bpp; p++)
-				*dst++ = src[offset + p];
-		}
-	}
-}
-
 void TXB::readData(Common::SeekableReadStream &txb, byte encoding) {
 	for (MipMaps::iterator mipMap = _mipMaps.begin(); mipMap != _mipMaps.end(); ++mipMap) {
 		const bool needDeSwizzle = (encoding == kEncodingBGRA) || (encoding == kEncodingGray);
@@ -45,7 +45,8 @@ namespace Images {
  */
 class TXB : public Decoder {
 public:
-	TXB(Common::SeekableReadStream &txb);
+	/** Read the image. Compressed image data is decompressed, unless keepCompressed is true. */
+	TXB(Common::SeekableReadStream &txb, bool keepCompressed = false);
 	~TXB();
 
 	/** Return the enclosed TXI data. */
@@ -62,8 +63,6 @@ private:
 	void readHeader(Common::SeekableReadStream &txb, byte &encoding);
 	void readData(Common::SeekableReadStream &txb, byte encoding);
 	void readTXIData(Common::SeekableReadStream &txb);
-
-	static void deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height, uint8 bpp);
 };
 
 } // End of namespace Images
@@ -233,6 +233,43 @@ static inline uint32 deSwizzleOffset(uint32 x, uint32 y, uint32 width, uint32 he
 	return offset;
 }
 
+/** De-"swizzle" a whole texture with bpp bytes per pixel.
+ *
+ *  The result is the same as copying every pixel from its deSwizzleOffset().
+ *  But since the bits of x and y are interleaved independently of each other,
+ *  the offsets are split into a table per axis, and the offset of a pixel is
+ *  then just the combination of the two. Runs of pixels that are contiguous
+ *  in the swizzled source are copied in one go.
+ */
+static inline void deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height, uint32 bpp) {
+	if ((width == 0) || (height == 0) || (bpp == 0))
+		return;
+
+	Common::ScopedArray<uint32> xOffsets(new uint32[width]);
+	Common::ScopedArray<uint32> yOffsets(new uint32[height]);
+
+	for (uint32 x = 0; x < width; x++)
+		xOffsets[x] = deSwizzleOffset(x, 0, width, height) * bpp;
+	for (uint32 y = 0; y < height; y++)
+		yOffsets[y] = deSwizzleOffset(0, y, width, height) * bpp;
+
+	/* The lowest bits of x might occupy the lowest bits of the offset, making
+	 * runs of pixels contiguous. Find the largest power-of-two run length that
+	 * evenly divides the width. */
+	uint32 run = 1;
+	while (((run * 2) <= width) && ((width % (run * 2)) == 0) && (xOffsets[run] == (run * bpp)))
+		run *= 2;
+
+	const uint32 runSize = run * bpp;
+
+	for (uint32 y = 0; y < height; y++) {
+		const byte *srcRow = src + yOffsets[y];
+
+		for (uint32 x = 0; x < width; x += run, dst += runSize)
+			std::memcpy(dst, srcRow + xOffsets[x], runSize);
+	}
+}
+
 } // End of namespace Images
 
 #endif // IMAGES_UTIL_H
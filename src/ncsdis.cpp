@@ -39,6 +39,7 @@
 #include "src/common/writefile.h"
 #include "src/common/stdoutstream.h"
 #include "src/common/cli.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/types.h"
 
@@ -57,7 +58,7 @@ enum Command {
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
                       Aurora::GameID &game, Command &command,
-                      bool &printStack, bool &printControlTypes);
+                      bool &printStack, bool &printControlTypes, bool &batch, uint32 &jobs);
 
 void disNCS(const Common::UString &inFile, const Common::UString &outFile,
             Aurora::GameID &game, Command &command, bool printStack, bool printControlTypes);
@@ -75,12 +76,37 @@ int main(int argc, char **argv) {
 		Command command = kCommandNone;
 		bool printStack = false;
 		bool printControlTypes = false;
+		bool batch = false;
+		uint32 jobs = 1;
 		Common::UString inFile, outFile;
 
-		if (!parseCommandLine(args, returnValue, inFile, outFile, game, command, printStack, printControlTypes))
+		if (!parseCommandLine(args, returnValue, inFile, outFile, game, command, printStack, printControlTypes,
+		                      batch, jobs))
 			return returnValue;
 
-		disNCS(inFile, outFile, game, command, printStack, printControlTypes);
+		if (!batch) {
+			disNCS(inFile, outFile, game, command, printStack, printControlTypes);
+			return 0;
+		}
+
+		if (!outFile.empty())
+			throw Common::Exception("No output file can be given in batch mode");
+
+		std::vector<BatchJob> batchJobs;
+		readBatchJobs(inFile, batchJobs);
+
+		static const char * const kExtensions[kCommandMAX] = { ".lst", ".asm", ".dot" };
+		const Common::UString extension = kExtensions[(command == kCommandNone) ? kCommandListing : command];
+
+		const size_t failed = runBatchJobs(batchJobs, Common::getThreadCount(jobs), [&](const BatchJob &job) {
+			disNCS(job.inFile, job.outFile.empty() ? (job.inFile + extension) : job.outFile,
+			       game, command, printStack, printControlTypes);
+		});
+
+		if (failed > 0) {
+			status("Failed to disassemble %u of %u files", (uint) failed, (uint) batchJobs.size());
+			return 1;
+		}
 	} catch (...) {
 		Common::exceptionDispatcherError();
 	}
@@ -91,7 +117,7 @@ int main(int argc, char **argv) {
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
                       Aurora::GameID &game, Command &command,
-                      bool &printStack, bool &printControlTypes) {
+                      bool &printStack, bool &printControlTypes, bool &batch, uint32 &jobs) {
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
 	using Common::CLI::Parser;
@@ -106,7 +132,11 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	NoOption inFileOpt(false, new ValGetter<Common::UString &>(inFile, "input files"));
 	NoOption outFileOpt(true, new ValGetter<Common::UString &>(outFile, "output files"));
 	Parser parser(argv[0], "BioWare NWScript bytecode disassembler",
-	              "\nIf no output file is given, the output is written to stdout.",
+	              "\nIf no output file is given, the output is written to stdout.\n\n"
+	              "In batch mode, the input file is a list of files to disassemble, \"-\" to\n"
+	              "read it from stdin. Each line holds one NCS file, optionally followed by a\n"
+	              "tab and the file to write. Without a file to write, \".lst\", \".asm\" or\n"
+	              "\".dot\" is appended to the name of the NCS file.",
 	              returnValue,
 	              makeEndArgs(&inFileOpt, &outFileOpt));
 
@@ -143,6 +173,11 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	                 " (Only available in list or assembly mode)",
 	                 kContinueParsing,
 	                 makeAssigners(new ValAssigner<bool>(true, printControlTypes)));
+	parser.addSpace();
+	parser.addOption("batch", "Disassemble all files listed in the input file", kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, batch)));
+	parser.addOption("jobs", 'j', "Number of threads to disassemble with in batch mode (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
 	return parser.process(argv);
 }
 
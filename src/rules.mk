@@ -52,6 +52,18 @@ src_gff2xml_LDADD = \
     $(LDADD) \
     $(EMPTY)
 
+bin_PROGRAMS += src/gffquery
+src_gffquery_SOURCES = \
+    src/gffquery.cpp \
+    src/util.cpp \
+    $(EMPTY)
+src_gffquery_LDADD = \
+    src/aurora/libaurora.la \
+    src/common/libcommon.la \
+    src/version/libversion.la \
+    $(LDADD) \
+    $(EMPTY)
+
 bin_PROGRAMS += src/tlk2xml
 src_tlk2xml_SOURCES = \
     src/tlk2xml.cpp \
@@ -38,6 +38,7 @@
 #include "src/common/stdoutstream.h"
 #include "src/common/encoding.h"
 #include "src/common/cli.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/language.h"
@@ -48,7 +49,7 @@
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
-                      Common::Encoding &encoding, Aurora::GameID &game);
+                      Common::Encoding &encoding, Aurora::GameID &game, bool &batch, uint32 &jobs);
 
 void dumpTLK(const Common::UString &inFile, const Common::UString &outFile, Common::Encoding encoding);
 
@@ -62,15 +63,36 @@ int main(int argc, char **argv) {
 		Common::Encoding encoding = Common::kEncodingInvalid;
 		Aurora::GameID   game     = Aurora::kGameIDUnknown;
 
+		bool batch = false;
+		uint32 jobs = 1;
+
 		int returnValue = 1;
 		Common::UString inFile, outFile;
 
-		if (!parseCommandLine(args, returnValue, inFile, outFile, encoding, game))
+		if (!parseCommandLine(args, returnValue, inFile, outFile, encoding, game, batch, jobs))
 			return returnValue;
 
 		LangMan.declareLanguages(game);
 
-		dumpTLK(inFile, outFile, encoding);
+		if (!batch) {
+			dumpTLK(inFile, outFile, encoding);
+			return 0;
+		}
+
+		if (!outFile.empty())
+			throw Common::Exception("No output file can be given in batch mode");
+
+		std::vector<BatchJob> batchJobs;
+		readBatchJobs(inFile, batchJobs);
+
+		const size_t failed = runBatchJobs(batchJobs, Common::getThreadCount(jobs), [&](const BatchJob &job) {
+			dumpTLK(job.inFile, job.outFile.empty() ? (job.inFile + ".xml") : job.outFile, encoding);
+		});
+
+		if (failed > 0) {
+			status("Failed to convert %u of %u files", (uint) failed, (uint) batchJobs.size());
+			return 1;
+		}
 	} catch (...) {
 		Common::exceptionDispatcherError();
 	}
@@ -80,7 +102,7 @@ int main(int argc, char **argv) {
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
-                      Common::Encoding &encoding, Aurora::GameID &game) {
+                      Common::Encoding &encoding, Aurora::GameID &game, bool &batch, uint32 &jobs) {
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
 	using Common::CLI::Parser;
@@ -98,7 +120,11 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	              "There is no way to autodetect the encoding of strings in TLK files,\n"
 	              "so an encoding must be specified. Alternatively, the game this TLK\n"
 	              "is from can be given, and an appropriate encoding according to that\n"
-	              "game and the language ID found in the TLK is used.\n",
+	              "game and the language ID found in the TLK is used.\n\n"
+	              "In batch mode, the input file is a list of files to convert, \"-\" to read\n"
+	              "it from stdin. Each line holds one TLK file, optionally followed by a tab and\n"
+	              "the XML file to write. Without an XML file, \".xml\" is appended to the name\n"
+	              "of the TLK file.\n",
 	              returnValue,
 	              makeEndArgs(&inFileOpt, &outFileOpt));
 
@@ -158,6 +184,11 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	parser.addOption("dragonage2", "Use Dragon Age II encodings", kContinueParsing,
 	                 makeAssigners(new ValAssigner<Encoding>(Common::kEncodingInvalid, encoding),
 	                 new ValAssigner<GameID>(Aurora::kGameIDDragonAge2, game)));
+	parser.addSpace();
+	parser.addOption("batch", "Convert all files listed in the input file", kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, batch)));
+	parser.addOption("jobs", 'j', "Number of threads to convert with in batch mode (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
 
 	return parser.process(argv);
 }
@@ -31,14 +31,18 @@
 #include "src/version/version.h"
 
 #include "src/common/ustring.h"
+#include "src/common/scopedptr.h"
 #include "src/common/strutil.h"
 #include "src/common/error.h"
 #include "src/common/platform.h"
 #include "src/common/readfile.h"
+#include "src/common/mappedreadfile.h"
 #include "src/common/md5.h"
 #include "src/common/cli.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/util.h"
+#include "src/aurora/archive.h"
 #include "src/aurora/erffile.h"
 
 #include "src/archives/util.h"
@@ -59,7 +63,8 @@ const char *kCommandChar[kCommandMAX] = { "i", "l", "v", "e", "x" };
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Command &command, Common::UString &archive, std::set<Common::UString> &files,
-                      Aurora::GameID &game, std::vector<byte> &password);
+                      Aurora::GameID &game, std::vector<byte> &password, uint32 &jobs,
+                      Common::UString &indexCache);
 
 bool parsePassword(const Common::UString &arg, std::vector<byte> &password);
 bool readNWMMD5   (const Common::UString &arg, std::vector<byte> &password);
@@ -80,23 +85,33 @@ int main(int argc, char **argv) {
 		Common::UString archive;
 		std::set<Common::UString> files;
 		std::vector<byte> password;
+		uint32 jobs = 1;
+		Common::UString indexCache;
 
-		if (!parseCommandLine(args, returnValue, command, archive, files, game, password))
+		if (!parseCommandLine(args, returnValue, command, archive, files, game, password, jobs, indexCache))
 			return returnValue;
 
-		Aurora::ERFFile erf(new Common::ReadFile(archive), password);
 		files = Archives::fixPathSeparator(files);
 
-		if      (command == kCommandInfo)
+		if (command == kCommandInfo) {
+			// The meta-information isn't cached, so we always need to parse the ERF itself
+			Aurora::ERFFile erf(Common::mapOrReadFile(archive), password);
 			displayInfo(erf);
-		else if (command == kCommandList)
-			Archives::listFiles(erf, game, false);
+
+			return 0;
+		}
+
+		Common::ScopedPtr<Aurora::Archive> erf(Archives::openArchive(archive, Aurora::kFileTypeERF,
+		                                                             indexCache, password));
+
+		if      (command == kCommandList)
+			Archives::listFiles(*erf, game, false);
 		else if (command == kCommandListVerbose)
-			Archives::listFiles(erf, game, true);
+			Archives::listFiles(*erf, game, true);
 		else if (command == kCommandExtract)
-			Archives::extractFiles(erf, game, false, files);
+			Archives::extractFiles(*erf, game, false, files, Common::getThreadCount(jobs));
 		else if (command == kCommandExtractDir)
-			Archives::extractFiles(erf, game, true, files);
+			Archives::extractFiles(*erf, game, true, files, Common::getThreadCount(jobs));
 
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -162,7 +177,8 @@ int ValGetter<Command &>::get(const std::vector<Common::UString> &args, int i, i
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Command &command, Common::UString &archive, std::set<Common::UString> &files,
-                      Aurora::GameID &game, std::vector<byte> &password) {
+                      Aurora::GameID &game, std::vector<byte> &password, uint32 &jobs,
+                      Common::UString &indexCache) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
@@ -203,6 +219,12 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	                 kContinueParsing,
 	                 new Callback<std::vector<byte> &>("file", readNWMMD5, password));
 
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Number of threads to extract with (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
+	parser.addOption("index-cache", "Read and update the archive's index in this cache file",
+	                 kContinueParsing, new ValGetter<Common::UString &>(indexCache, "file"));
+
 	return parser.process(argv);
 }
 
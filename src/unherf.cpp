@@ -29,13 +29,14 @@
 #include "src/version/version.h"
 
 #include "src/common/ustring.h"
+#include "src/common/scopedptr.h"
 #include "src/common/error.h"
 #include "src/common/platform.h"
-#include "src/common/readfile.h"
 #include "src/common/cli.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/util.h"
-#include "src/aurora/herffile.h"
+#include "src/aurora/archive.h"
 
 #include "src/archives/util.h"
 
@@ -51,7 +52,8 @@ enum Command {
 const char *kCommandChar[kCommandMAX] = { "l", "e" };
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Command &command, Common::UString &archive, std::set<Common::UString> &files);
+                      Command &command, Common::UString &archive, std::set<Common::UString> &files,
+                      uint32 &jobs, Common::UString &indexCache);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -64,17 +66,19 @@ int main(int argc, char **argv) {
 		Command command = kCommandNone;
 		Common::UString archive;
 		std::set<Common::UString> files;
+		uint32 jobs = 1;
+		Common::UString indexCache;
 
-		if (!parseCommandLine(args, returnValue, command, archive, files))
+		if (!parseCommandLine(args, returnValue, command, archive, files, jobs, indexCache))
 			return returnValue;
 
-		Aurora::HERFFile herf(new Common::ReadFile(archive));
+		Common::ScopedPtr<Aurora::Archive> herf(Archives::openArchive(archive, Aurora::kFileTypeHERF, indexCache));
 		files = Archives::fixPathSeparator(files);
 
 		if      (command == kCommandList)
-			Archives::listFiles(herf, Aurora::kGameIDUnknown, false);
+			Archives::listFiles(*herf, Aurora::kGameIDUnknown, false);
 		else if (command == kCommandExtract)
-			Archives::extractFiles(herf, Aurora::kGameIDUnknown, false, files);
+			Archives::extractFiles(*herf, Aurora::kGameIDUnknown, false, files, Common::getThreadCount(jobs));
 
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -100,7 +104,8 @@ int ValGetter<Command &>::get(const std::vector<Common::UString> &args, int i, i
 }
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Command &command, Common::UString &archive, std::set<Common::UString> &files) {
+                      Command &command, Common::UString &archive, std::set<Common::UString> &files,
+                      uint32 &jobs, Common::UString &indexCache) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::Parser;
@@ -117,5 +122,11 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	              returnValue,
 	              makeEndArgs(&cmdOpt, &archiveOpt, &filesOpt));
 
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Number of threads to extract with (0: one per CPU core)",
+	                 Common::CLI::kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
+	parser.addOption("index-cache", "Read and update the archive's index in this cache file",
+	                 Common::CLI::kContinueParsing, new ValGetter<Common::UString &>(indexCache, "file"));
+
 	return parser.process(argv);
 }
@@ -27,6 +27,9 @@
 
 #include <list>
 #include <vector>
+#include <utility>
+
+#include <boost/unordered/unordered_map.hpp>
 
 #include "src/version/version.h"
 
@@ -37,14 +40,17 @@
 #include "src/common/error.h"
 #include "src/common/platform.h"
 #include "src/common/readfile.h"
+#include "src/common/mappedreadfile.h"
 #include "src/common/filepath.h"
 #include "src/common/cli.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/util.h"
 #include "src/aurora/keyfile.h"
 #include "src/aurora/keydatafile.h"
 #include "src/aurora/biffile.h"
 #include "src/aurora/bzffile.h"
+#include "src/aurora/indexcache.h"
 
 #include "src/archives/util.h"
 
@@ -60,7 +66,8 @@ enum Command {
 const char *kCommandChar[kCommandMAX] = { "l", "e" };
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Command &command, std::list<Common::UString> &files, Aurora::GameID &game);
+                      Command &command, std::list<Common::UString> &files, Aurora::GameID &game, uint32 &jobs,
+                      Common::UString &indexCache);
 
 uint32 getFileID(const Common::UString &fileName);
 void identifyFiles(const std::list<Common::UString> &files, std::vector<Common::UString> &keyFiles,
@@ -72,8 +79,82 @@ void openKEYDataFiles(const std::vector<Common::UString> &dataFiles, Common::Ptr
 void mergeKEYDataFiles(Common::PtrVector<Aurora::KEYFile> &keys, Common::PtrVector<Aurora::KEYDataFile> &keyData,
                        const std::vector<Common::UString> &dataFiles);
 
+bool openCachedKEYDataFiles(const Aurora::IndexCache &indexCache, const std::vector<Common::UString> &keyFiles,
+                            const std::vector<Common::UString> &dataFiles, Common::PtrVector<Aurora::Archive> &keyData,
+                            std::vector<uint32> &resourceCounts);
+void updateIndexCache(const Common::UString &indexCacheFile, Aurora::IndexCache &indexCache,
+                      const std::vector<Common::UString> &keyFiles, const Common::PtrVector<Aurora::KEYDataFile> &keyData,
+                      const std::vector<Common::UString> &dataFiles);
+
+/** Open all BIFs/BZFs through their index cache entries, with their resources named by the KEYs.
+ *
+ *  Only if all BIFs/BZFs have current entries, recorded with the same KEYs, the
+ *  archives are opened and true is returned. Otherwise, nothing is opened.
+ */
+bool openCachedKEYDataFiles(const Aurora::IndexCache &indexCache, const std::vector<Common::UString> &keyFiles,
+                            const std::vector<Common::UString> &dataFiles, Common::PtrVector<Aurora::Archive> &keyData,
+                            std::vector<uint32> &resourceCounts) {
+
+	std::vector<const Aurora::IndexCache::Entry *> entries;
+	entries.reserve(dataFiles.size());
+
+	for (std::vector<Common::UString>::const_iterator f = dataFiles.begin(); f != dataFiles.end(); ++f) {
+		const Aurora::IndexCache::Entry *entry = indexCache.find(Common::FilePath::canonicalize(*f));
+		if (!entry || entry->file.locations.empty() || (entry->dataFiles.size() != keyFiles.size()))
+			return false;
+
+		for (size_t k = 0; k < keyFiles.size(); k++)
+			if (entry->dataFiles[k].path != Common::FilePath::canonicalize(keyFiles[k]))
+				return false;
+
+		entries.push_back(entry);
+	}
+
+	keyData.reserve(entries.size());
+	resourceCounts.reserve(entries.size());
+
+	for (std::vector<const Aurora::IndexCache::Entry *>::const_iterator e = entries.begin(); e != entries.end(); ++e) {
+		keyData.push_back(Aurora::IndexCache::openCachedArchive(**e));
+		resourceCounts.push_back((*e)->file.locations.size());
+	}
+
+	return true;
+}
+
+/** Record the resources of all BIFs/BZFs, as named by the KEYs, and their locations in the index cache. */
+void updateIndexCache(const Common::UString &indexCacheFile, Aurora::IndexCache &indexCache,
+                      const std::vector<Common::UString> &keyFiles, const Common::PtrVector<Aurora::KEYDataFile> &keyData,
+                      const std::vector<Common::UString> &dataFiles) {
+
+	std::vector<Aurora::IndexCache::File> keyCacheFiles;
+	keyCacheFiles.reserve(keyFiles.size());
+
+	for (std::vector<Common::UString>::const_iterator k = keyFiles.begin(); k != keyFiles.end(); ++k)
+		keyCacheFiles.push_back(Aurora::IndexCache::File(Common::FilePath::canonicalize(*k)));
+
+	for (size_t i = 0; i < keyData.size(); i++) {
+		Aurora::IndexCache::Entry entry;
+		Aurora::IndexCache::createEntry(entry, Common::FilePath::canonicalize(dataFiles[i]), *keyData[i]);
+
+		// The resources are indexed by their position within the whole BIF/BZF, not just the named ones
+		Aurora::IndexCache::getLocations(*keyData[i], keyData[i]->getInternalResourceCount(), entry.file.locations);
+
+		entry.dataFiles = keyCacheFiles;
+
+		indexCache.add(entry);
+	}
+
+	try {
+		indexCache.save(indexCacheFile);
+	} catch (...) {
+		Common::exceptionDispatcherWarnAndIgnore(Common::UString::format("Failed writing index cache \"%s\"",
+		                                                                 indexCacheFile.c_str()));
+	}
+}
+
 void listFiles(const Common::PtrVector<Aurora::KEYFile> &keys, const std::vector<Common::UString> &keyFiles, Aurora::GameID game);
-void extractFiles(const Common::PtrVector<Aurora::KEYDataFile> &keyData, const std::vector<Common::UString> &dataFiles, Aurora::GameID game);
+void extractFiles(const std::vector<const Aurora::Archive *> &keyData, const std::vector<uint32> &resourceCounts,
+                  const std::vector<Common::UString> &dataFiles, Aurora::GameID game, size_t threadCount);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -87,25 +168,51 @@ int main(int argc, char **argv) {
 		int returnValue = 1;
 		Command command = kCommandNone;
 		std::list<Common::UString> files;
+		uint32 jobs = 1;
+		Common::UString indexCacheFile;
 
-		if (!parseCommandLine(args, returnValue, command, files, game))
+		if (!parseCommandLine(args, returnValue, command, files, game, jobs, indexCacheFile))
 			return returnValue;
 
 		std::vector<Common::UString> keyFiles, dataFiles;
 		identifyFiles(files, keyFiles, dataFiles);
 
+		Aurora::IndexCache indexCache;
+		if (!indexCacheFile.empty())
+			indexCache.load(indexCacheFile);
+
 		Common::PtrVector<Aurora::KEYFile> keys;
 		Common::PtrVector<Aurora::KEYDataFile> keyData;
+		Common::PtrVector<Aurora::Archive> cachedKeyData;
+
+		std::vector<const Aurora::Archive *> archives;
+		std::vector<uint32> resourceCounts;
+
+		// If all BIFs/BZFs to extract are in the index cache, neither they nor the KEYs need to be read
+		if ((command == kCommandExtract) && !indexCacheFile.empty() &&
+		    openCachedKEYDataFiles(indexCache, keyFiles, dataFiles, cachedKeyData, resourceCounts)) {
+
+			archives.assign(cachedKeyData.begin(), cachedKeyData.end());
 
-		openKEYs(keyFiles, keys);
-		openKEYDataFiles(dataFiles, keyData);
+		} else {
+			openKEYs(keyFiles, keys);
+			openKEYDataFiles(dataFiles, keyData);
 
-		mergeKEYDataFiles(keys, keyData, dataFiles);
+			mergeKEYDataFiles(keys, keyData, dataFiles);
+
+			for (Common::PtrVector<Aurora::KEYDataFile>::const_iterator d = keyData.begin(); d != keyData.end(); ++d) {
+				archives.push_back(*d);
+				resourceCounts.push_back((*d)->getInternalResourceCount());
+			}
+
+			if ((command == kCommandExtract) && !indexCacheFile.empty())
+				updateIndexCache(indexCacheFile, indexCache, keyFiles, keyData, dataFiles);
+		}
 
 		if      (command == kCommandList)
 			listFiles(keys, keyFiles, game);
 		else if (command == kCommandExtract)
-			extractFiles(keyData, dataFiles, game);
+			extractFiles(archives, resourceCounts, dataFiles, game, Common::getThreadCount(jobs));
 
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -131,7 +238,8 @@ int ValGetter<Command &>::get(const std::vector<Common::UString> &args, int i, i
 }
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Command &command, std::list<Common::UString> &files, Aurora::GameID &game) {
+                      Command &command, std::list<Common::UString> &files, Aurora::GameID &game, uint32 &jobs,
+                      Common::UString &indexCache) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::Parser;
@@ -162,6 +270,12 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	                 Common::CLI::kContinueParsing,
 	                 makeAssigners(new ValAssigner<Aurora::GameID>(Aurora::kGameIDJade, game)));
 
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Number of threads to extract with (0: one per CPU core)",
+	                 Common::CLI::kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
+	parser.addOption("index-cache", "Read and update the indices of the BIFs/BZFs in this cache file",
+	                 Common::CLI::kContinueParsing, new ValGetter<Common::UString &>(indexCache, "file"));
+
 	return parser.process(argv);
 }
 
@@ -204,15 +318,24 @@ void openKEYDataFiles(const std::vector<Common::UString> &dataFiles, Common::Ptr
 
 	for (std::vector<Common::UString>::const_iterator f = dataFiles.begin(); f != dataFiles.end(); ++f) {
 		if (Common::FilePath::getExtension(*f).equalsIgnoreCase(".bzf"))
-			keyData.push_back(new Aurora::BZFFile(new Common::ReadFile(*f)));
+			keyData.push_back(new Aurora::BZFFile(Common::mapOrReadFile(*f)));
 		else
-			keyData.push_back(new Aurora::BIFFile(new Common::ReadFile(*f)));
+			keyData.push_back(new Aurora::BIFFile(Common::mapOrReadFile(*f)));
 	}
 }
 
 void mergeKEYDataFiles(Common::PtrVector<Aurora::KEYFile> &keys, Common::PtrVector<Aurora::KEYDataFile> &keyData,
                        const std::vector<Common::UString> &dataFiles) {
 
+	// Map the lowercased stems of all BIFs/BZFs to their indices
+	typedef boost::unordered_multimap<Common::UString, size_t, Common::hashUStringCaseSensitive> StemMap;
+
+	StemMap dataFileStems;
+	dataFileStems.reserve(dataFiles.size());
+
+	for (size_t b = 0; b < dataFiles.size(); b++)
+		dataFileStems.insert(std::make_pair(Common::FilePath::getStem(dataFiles[b]).toLower(), b));
+
 	// Go over all KEYs
 	for (Common::PtrVector<Aurora::KEYFile>::iterator k = keys.begin(); k != keys.end(); ++k) {
 
@@ -220,14 +343,12 @@ void mergeKEYDataFiles(Common::PtrVector<Aurora::KEYFile> &keys, Common::PtrVect
 		const Aurora::KEYFile::BIFList &keyBifs = (*k)->getBIFs();
 		for (size_t kb = 0; kb < keyBifs.size(); kb++) {
 
-			// Go over all BIFs
-			for (size_t b = 0; b < dataFiles.size(); b++) {
+			// Merge with all BIFs/BZFs of the same name
+			std::pair<StemMap::const_iterator, StemMap::const_iterator> b =
+				dataFileStems.equal_range(Common::FilePath::getStem(keyBifs[kb]).toLower());
 
-				// If they match, merge
-				if (Common::FilePath::getStem(keyBifs[kb]).equalsIgnoreCase(Common::FilePath::getStem(dataFiles[b])))
-					keyData[b]->mergeKEY(**k, kb);
-
-			}
+			for (StemMap::const_iterator d = b.first; d != b.second; ++d)
+				keyData[d->second]->mergeKEY(**k, kb);
 
 		}
 
@@ -246,15 +367,15 @@ void listFiles(const Common::PtrVector<Aurora::KEYFile> &keys,
 	}
 }
 
-void extractFiles(const Common::PtrVector<Aurora::KEYDataFile> &keyData,
-                  const std::vector<Common::UString> &dataFiles, Aurora::GameID game) {
+void extractFiles(const std::vector<const Aurora::Archive *> &keyData, const std::vector<uint32> &resourceCounts,
+                  const std::vector<Common::UString> &dataFiles, Aurora::GameID game, size_t threadCount) {
 
 	for (size_t i = 0; i < keyData.size(); i++) {
 		std::printf("%s: %s indexed files (of %u)\n\n", dataFiles[i].c_str(),
 		            Common::composeString(keyData[i]->getResources().size()).c_str(),
-                keyData[i]->getInternalResourceCount());
+                resourceCounts[i]);
 
-		Archives::extractFiles(*keyData[i], game, false, std::set<Common::UString>());
+		Archives::extractFiles(*keyData[i], game, false, std::set<Common::UString>(), threadCount);
 
 		if (i < (keyData.size() - 1))
 			std::printf("\n");
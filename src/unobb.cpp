@@ -32,7 +32,8 @@
 #include "src/common/error.h"
 #include "src/common/platform.h"
 #include "src/common/cli.h"
-#include "src/common/readfile.h"
+#include "src/common/parallel.h"
+#include "src/common/mappedreadfile.h"
 #include "src/common/scopedptr.h"
 
 #include "src/aurora/obbfile.h"
@@ -54,7 +55,8 @@ enum Command {
 const char *kCommandChar[kCommandMAX] = { "l", "v", "e", "x" };
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Command &command, Common::UString &archive, std::set<Common::UString> &files);
+                      Command &command, Common::UString &archive, std::set<Common::UString> &files,
+                      uint32 &jobs);
 
 bool isPKZIP(Common::SeekableReadStream &stream);
 
@@ -69,11 +71,12 @@ int main(int argc, char **argv) {
 		Command command = kCommandNone;
 		Common::UString archive;
 		std::set<Common::UString> files;
+		uint32 jobs = 1;
 
-		if (!parseCommandLine(args, returnValue, command, archive, files))
+		if (!parseCommandLine(args, returnValue, command, archive, files, jobs))
 			return returnValue;
 
-		Common::ScopedPtr<Common::SeekableReadStream> stream(new Common::ReadFile(archive));
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::mapOrReadFile(archive));
 
 		Common::ScopedPtr<Aurora::Archive> arc;
 		if (isPKZIP(*stream))
@@ -88,9 +91,9 @@ int main(int argc, char **argv) {
 		else if (command == kCommandListVerbose)
 			Archives::listFiles(*arc, Aurora::kGameIDUnknown, true);
 		else if (command == kCommandExtract)
-			Archives::extractFiles(*arc, Aurora::kGameIDUnknown, false, files);
+			Archives::extractFiles(*arc, Aurora::kGameIDUnknown, false, files, Common::getThreadCount(jobs));
 		else if (command == kCommandExtractDir)
-			Archives::extractFiles(*arc, Aurora::kGameIDUnknown, true, files);
+			Archives::extractFiles(*arc, Aurora::kGameIDUnknown, true, files, Common::getThreadCount(jobs));
 
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -116,7 +119,8 @@ int ValGetter<Command &>::get(const std::vector<Common::UString> &args, int i, i
 }
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Command &command, Common::UString &archive, std::set<Common::UString> &files) {
+                      Command &command, Common::UString &archive, std::set<Common::UString> &files,
+                      uint32 &jobs) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::Parser;
@@ -135,6 +139,10 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	              returnValue,
 	              makeEndArgs(&cmdOpt, &archiveOpt, &filesOpt));
 
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Number of threads to extract with (0: one per CPU core)",
+	                 Common::CLI::kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
+
 	return parser.process(argv);
 }
 
@@ -27,13 +27,14 @@
 #include "src/version/version.h"
 
 #include "src/common/ustring.h"
+#include "src/common/scopedptr.h"
 #include "src/common/error.h"
 #include "src/common/platform.h"
-#include "src/common/readfile.h"
 #include "src/common/cli.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/util.h"
-#include "src/aurora/rimfile.h"
+#include "src/aurora/archive.h"
 
 #include "src/archives/util.h"
 
@@ -50,7 +51,8 @@ const char *kCommandChar[kCommandMAX] = { "l", "e" };
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Command &command, Common::UString &archive,
-                      Aurora::GameID &game, std::set<Common::UString> &files);
+                      Aurora::GameID &game, std::set<Common::UString> &files,
+                      uint32 &jobs, Common::UString &indexCache);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -65,17 +67,19 @@ int main(int argc, char **argv) {
 		Command command = kCommandNone;
 		Common::UString archive;
 		std::set<Common::UString> files;
+		uint32 jobs = 1;
+		Common::UString indexCache;
 
-		if (!parseCommandLine(args, returnValue, command, archive, game, files))
+		if (!parseCommandLine(args, returnValue, command, archive, game, files, jobs, indexCache))
 			return returnValue;
 
-		Aurora::RIMFile rim(new Common::ReadFile(archive));
+		Common::ScopedPtr<Aurora::Archive> rim(Archives::openArchive(archive, Aurora::kFileTypeRIM, indexCache));
 		files = Archives::fixPathSeparator(files);
 
 		if      (command == kCommandList)
-			Archives::listFiles(rim, game, false);
+			Archives::listFiles(*rim, game, false);
 		else if (command == kCommandExtract)
-			Archives::extractFiles(rim, game, false, files);
+			Archives::extractFiles(*rim, game, false, files, Common::getThreadCount(jobs));
 
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -102,7 +106,8 @@ int ValGetter<Command &>::get(const std::vector<Common::UString> &args, int i, i
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Command &command, Common::UString &archive,
-                      Aurora::GameID &game, std::set<Common::UString> &files) {
+                      Aurora::GameID &game, std::set<Common::UString> &files,
+                      uint32 &jobs, Common::UString &indexCache) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
@@ -130,5 +135,11 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	                 kContinueParsing,
 	                 makeAssigners(new ValAssigner<Aurora::GameID>(Aurora::kGameIDJade, game)));
 
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Number of threads to extract with (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
+	parser.addOption("index-cache", "Read and update the archive's index in this cache file",
+	                 kContinueParsing, new ValGetter<Common::UString &>(indexCache, "file"));
+
 	return parser.process(argv);
 }
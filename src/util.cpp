@@ -22,7 +22,11 @@
  *  General tool utility functions.
  */
 
+#include <atomic>
+#include <mutex>
+
 #include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
 #include "src/common/platform.h"
 #include "src/common/readstream.h"
@@ -30,6 +34,10 @@
 #include "src/common/writefile.h"
 #include "src/common/stdinstream.h"
 #include "src/common/stdoutstream.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/encoding.h"
+#include "src/common/parallel.h"
 
 #include "src/util.h"
 
@@ -65,3 +73,69 @@ Common::ReadStream *openFileOrStdIn(const Common::UString &file) {
 
 	return new Common::StdInStream;
 }
+
+void readBatchJobs(const Common::UString &jobList, std::vector<BatchJob> &jobs) {
+	Common::ScopedPtr<Common::ReadStream> list(openFileOrStdIn((jobList == "-") ? "" : jobList));
+
+	// Stdin can't seek, so read the whole list into memory first
+	Common::MemoryWriteStreamDynamic listData(true);
+	listData.writeStream(*list);
+
+	Common::MemoryReadStream listStream(listData.getData(), listData.size());
+
+	while (!listStream.eos()) {
+		const Common::UString line = Common::readStringLine(listStream, Common::kEncodingUTF8);
+		if (line.empty())
+			continue;
+
+		BatchJob job;
+
+		Common::UString::iterator tab = line.findFirst('\t');
+		if (tab != line.end()) {
+			job.inFile  = line.substr(line.begin(), tab);
+			job.outFile = line.substr(++tab, line.end());
+		} else
+			job.inFile = line;
+
+		jobs.push_back(job);
+	}
+}
+
+size_t runBatchJobs(size_t count, size_t threadCount,
+                    const std::function<Common::UString(size_t)> &describe,
+                    const std::function<void(size_t)> &run) {
+
+	std::atomic<size_t> failed(0);
+	std::mutex errorMutex;
+
+	Common::parallelFor(threadCount, count, [&](size_t i) {
+		try {
+			run(i);
+		} catch (Common::Exception &e) {
+			std::lock_guard<std::mutex> lock(errorMutex);
+
+			e.add("Failed converting \"%s\"", describe(i).c_str());
+			Common::printException(e, "WARNING: ");
+
+			failed++;
+		} catch (std::exception &e) {
+			std::lock_guard<std::mutex> lock(errorMutex);
+
+			Common::Exception se(e);
+			se.add("Failed converting \"%s\"", describe(i).c_str());
+			Common::printException(se, "WARNING: ");
+
+			failed++;
+		}
+	});
+
+	return failed;
+}
+
+size_t runBatchJobs(const std::vector<BatchJob> &jobs, size_t threadCount,
+                    const std::function<void(const BatchJob &)> &run) {
+
+	return runBatchJobs(jobs.size(), threadCount,
+	                    [&](size_t i) { return jobs[i].inFile; },
+	                    [&](size_t i) { run(jobs[i]); });
+}
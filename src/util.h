@@ -25,8 +25,13 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <vector>
+#include <functional>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+
 namespace Common {
-	class UString;
 	class ReadStream;
 	class SeekableReadStream;
 	class WriteStream;
@@ -39,4 +44,40 @@ void dumpStream(Common::SeekableReadStream &stream, const Common::UString &fileN
 Common::WriteStream *openFileOrStdOut(const Common::UString &file);
 Common::ReadStream  *openFileOrStdIn (const Common::UString &file);
 
+/** A single job of a batch run: converting one input file into one output file. */
+struct BatchJob {
+	Common::UString inFile;
+	Common::UString outFile; ///< Empty if the job list didn't specify an output file.
+};
+
+/** Read a list of batch jobs.
+ *
+ *  Every line of the job list specifies one job: an input file, optionally
+ *  followed by a tab and an output file. Empty lines are ignored.
+ *
+ *  @param jobList The file to read the job list from. "-" reads from stdin.
+ *  @param jobs The jobs are appended to this list.
+ */
+void readBatchJobs(const Common::UString &jobList, std::vector<BatchJob> &jobs);
+
+/** Run a list of batch jobs, spread over threadCount threads.
+ *
+ *  A job failing with an exception is reported, but doesn't stop the other jobs.
+ *
+ *  @return The number of jobs that failed.
+ */
+size_t runBatchJobs(const std::vector<BatchJob> &jobs, size_t threadCount,
+                    const std::function<void(const BatchJob &)> &run);
+
+/** Run count batch jobs, given by their index, spread over threadCount threads.
+ *
+ *  Like the above, for jobs that aren't simply an input and an output file.
+ *  describe() names a job in the report of its failure.
+ *
+ *  @return The number of jobs that failed.
+ */
+size_t runBatchJobs(size_t count, size_t threadCount,
+                    const std::function<Common::UString(size_t)> &describe,
+                    const std::function<void(size_t)> &run);
+
 #endif // UTIL_H
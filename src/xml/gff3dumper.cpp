@@ -56,7 +56,7 @@ void GFF3Dumper::dump(Common::WriteStream &output, Common::SeekableReadStream *i
 	if (_sacFile) {
 		_gff3.reset(new Aurora::SACFile(input));
 	} else {
-		_gff3.reset(new Aurora::GFF3File(input, 0xFFFFFFFF, allowNWNPremium));
+		_gff3.reset(new Aurora::GFF3File(input, 0xFFFFFFFF, allowNWNPremium, true));
 	}
 
 	_xml.reset(new XMLWriter(output));
@@ -65,7 +65,9 @@ void GFF3Dumper::dump(Common::WriteStream &output, Common::SeekableReadStream *i
 	_xml->addProperty("type", Common::tagToString(_gff3->getType(), true));
 	_xml->breakLine();
 
-	dumpStruct(_gff3->getTopLevel());
+	// Walk the GFF3 depth-first, only holding the structs along the current path
+	Common::ScopedPtr<Aurora::GFF3Struct> topLevel(_gff3->readStruct(0));
+	dumpStruct(*topLevel);
 
 	_xml->closeTag();
 	_xml->breakLine();
@@ -187,11 +189,19 @@ void GFF3Dumper::dumpField(const Aurora::GFF3Struct &strct, const Common::UStrin
 			break;
 
 		case Aurora::GFF3Struct::kFieldTypeStruct:
-			dumpStruct(strct.getStruct(field), label);
+			{
+				Common::ScopedPtr<Aurora::GFF3Struct> child(_gff3->readStruct(strct.getStructIndex(field)));
+				dumpStruct(*child, label);
+			}
 			break;
 
 		case Aurora::GFF3Struct::kFieldTypeList:
-			dumpList(strct.getList(field));
+			{
+				std::vector<uint32> list;
+				strct.getListIndices(field, list);
+
+				dumpList(list);
+			}
 			break;
 
 		case Aurora::GFF3Struct::kFieldTypeOrientation:
@@ -286,12 +296,14 @@ void GFF3Dumper::dumpStruct(const Aurora::GFF3Struct &strct, bool hasLabel, cons
 	_xml->breakLine();
 }
 
-void GFF3Dumper::dumpList(const Aurora::GFF3List &list) {
+void GFF3Dumper::dumpList(const std::vector<uint32> &list) {
 	if (!list.empty())
 		_xml->breakLine();
 
-	for (Aurora::GFF3List::const_iterator e = list.begin(); e != list.end(); ++e)
-		dumpStruct(**e);
+	for (std::vector<uint32>::const_iterator e = list.begin(); e != list.end(); ++e) {
+		Common::ScopedPtr<Aurora::GFF3Struct> strct(_gff3->readStruct(*e));
+		dumpStruct(*strct);
+	}
 }
 
 } // End of namespace XML
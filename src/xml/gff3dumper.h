@@ -25,6 +25,9 @@
 #ifndef XML_GFF3DUMPER_H
 #define XML_GFF3DUMPER_H
 
+#include <vector>
+
+#include "src/common/types.h"
 #include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
 
@@ -60,7 +63,7 @@ private:
 	void dumpField(const Aurora::GFF3Struct &strct, const Common::UString &field);
 	void dumpStruct(const Aurora::GFF3Struct &strct, const Common::UString &label);
 	void dumpStruct(const Aurora::GFF3Struct &strct);
-	void dumpList(const Aurora::GFF3List &list);
+	void dumpList(const std::vector<uint32> &list);
 
 	void dumpStruct(const Aurora::GFF3Struct &strct, bool hasLabel, const Common::UString &label = "");
 };
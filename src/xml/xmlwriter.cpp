@@ -22,6 +22,9 @@
  *  Utility class for writing XML files.
  */
 
+#include <cstring>
+
+#include "src/common/util.h"
 #include "src/common/ustring.h"
 #include "src/common/memreadstream.h"
 #include "src/common/writestream.h"
@@ -31,7 +34,14 @@
 
 namespace XML {
 
-XMLWriter::XMLWriter(Common::WriteStream &stream) : _stream(&stream), _needIndent(false) {
+static const char kIndent[] = "                                                                ";
+
+/** Number of bytes of binary data in one line of base64 contents. */
+static const size_t kBase64LineData = 48;
+
+XMLWriter::XMLWriter(Common::WriteStream &stream) : _stream(&stream),
+	_buffer(new byte[kBufferSize]), _bufferFill(0), _tagOpen(false), _needIndent(false) {
+
 	writeHeader();
 }
 
@@ -46,187 +56,202 @@ void XMLWriter::flush() {
 	while (!_openTags.empty())
 		closeTag();
 
+	flushBuffer();
 	_stream->flush();
 }
 
+void XMLWriter::flushBuffer() {
+	if (_bufferFill == 0)
+		return;
+
+	const size_t fill = _bufferFill;
+	_bufferFill = 0;
+
+	_stream->write(_buffer.get(), fill);
+}
+
+void XMLWriter::write(const char *data, size_t size) {
+	if ((_bufferFill + size) > kBufferSize) {
+		flushBuffer();
+
+		if (size > kBufferSize) {
+			_stream->write(data, size);
+			return;
+		}
+	}
+
+	std::memcpy(_buffer.get() + _bufferFill, data, size);
+	_bufferFill += size;
+}
+
+void XMLWriter::write(const char *str) {
+	write(str, std::strlen(str));
+}
+
+void XMLWriter::write(const Common::UString &str) {
+	write(str.c_str(), std::strlen(str.c_str()));
+}
+
 void XMLWriter::writeHeader() {
-	_stream->writeString("<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n");
+	write("<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n");
 	flush();
 }
 
 void XMLWriter::openTag(const Common::UString &name) {
-	if (!_openTags.empty()) {
-		_openTags.back().empty = false;
-
-		indent(_openTags.size());
-		writeTag();
-	}
+	finishTag();
+	indent(_openTags.size());
 
-	_openTags.push_back(Tag());
+	_openTags.push_back(name);
 
-	Tag &tag = _openTags.back();
+	write("<");
+	write(name);
 
-	tag.name  = name;
-	tag.empty = true;
+	_tagOpen = true;
 }
 
 void XMLWriter::closeTag() {
 	if (_openTags.empty())
 		return;
 
-	writeTag();
-
-	const Tag &tag = _openTags.back();
-
-	if (!tag.empty) {
+	if (_tagOpen) {
+		write("/>");
+		_tagOpen = false;
+	} else {
 		indent(_openTags.size() - 1);
-		_stream->writeString("</" + tag.name + ">");
+
+		write("</");
+		write(_openTags.back());
+		write(">");
 	}
 
 	_openTags.pop_back();
 }
 
-void XMLWriter::writeTag() {
-	if (_openTags.empty() || _openTags.back().written)
+void XMLWriter::finishTag() {
+	if (!_tagOpen)
 		return;
 
-	Tag &tag = _openTags.back();
-
-	tag.written = true;
-
-	_stream->writeString("<" + tag.name);
-
-	for (std::list<Property>::const_iterator p = tag.properties.begin(); p != tag.properties.end(); ++p)
-		_stream->writeString(" " + p->name + "=\"" + escape(p->value) + "\"");
-
-	if (tag.empty)
-		_stream->writeString("/");
-
-	_stream->writeString(">");
-
-	if (!tag.empty) {
-		if (!tag.base64.empty()) {
-
-			if (tag.base64.size() == 1) {
-
-				_stream->writeString(tag.base64.front());
-				tag.base64.pop_front();
-
-			} else {
-
-				while (!tag.base64.empty()) {
-					breakLine();
-					indent(_openTags.size());
-					_stream->writeString(tag.base64.front());
-					tag.base64.pop_front();
-				}
-				breakLine();
-
-			}
-
-		} else
-			_stream->writeString(escape(tag.contents));
-	}
+	write(">");
+	_tagOpen = false;
 }
 
 void XMLWriter::indent(size_t level) {
 	if (!_needIndent)
 		return;
 
-	while (level-- > 0)
-		_stream->writeString("  ");
+	for (size_t n = level * 2; n > 0; ) {
+		const size_t chunk = MIN(n, sizeof(kIndent) - 1);
+
+		write(kIndent, chunk);
+		n -= chunk;
+	}
 
 	_needIndent = false;
 }
 
-Common::UString XMLWriter::escape(const Common::UString &str) {
-	Common::UString escaped;
+void XMLWriter::writeEscaped(const Common::UString &str) {
+	/* Only ASCII characters need escaping, and those never appear within
+	 * a multi-byte UTF-8 sequence. So we can scan the raw UTF-8 data. */
+
+	const char *s     = str.c_str();
+	const char *start = s;
 
-	for (Common::UString::iterator s = str.begin(); s != str.end(); ++s) {
-		uint32 c = *s;
+	for (; *s; s++) {
+		const char *escaped = 0;
 
-		if      (c == '\"')
-			escaped += "&quot;";
-		else if (c == '\'')
-			escaped += "&apos;";
-		else if (c == '&')
-			escaped += "&amp;";
-		else if (c == '<')
-			escaped += "&lt;";
-		else if (c == '>')
-			escaped += "&gt;";
-		else if (c == '\r')
-			escaped += "&#13;";
-		else
-			escaped += c;
+		if      (*s == '\"')
+			escaped = "&quot;";
+		else if (*s == '\'')
+			escaped = "&apos;";
+		else if (*s == '&')
+			escaped = "&amp;";
+		else if (*s == '<')
+			escaped = "&lt;";
+		else if (*s == '>')
+			escaped = "&gt;";
+		else if (*s == '\r')
+			escaped = "&#13;";
 
+		if (!escaped)
+			continue;
+
+		write(start, s - start);
+		write(escaped);
+
+		start = s + 1;
 	}
 
-	return escaped;
+	write(start, s - start);
 }
 
 void XMLWriter::addProperty(const Common::UString &name, const Common::UString &value) {
-	if (_openTags.empty())
+	if (_openTags.empty() || !_tagOpen)
 		return;
 
-	Tag &tag = _openTags.back();
-
-	tag.properties.push_back(Property());
-
-	Property &property = tag.properties.back();
-
-	property.name  = name;
-	property.value = value;
+	write(" ");
+	write(name);
+	write("=\"");
+	writeEscaped(value);
+	write("\"");
 }
 
 void XMLWriter::setContents(const Common::UString &contents) {
-	if (_openTags.empty())
+	if (_openTags.empty() || !_tagOpen)
 		return;
 
-	Tag &tag = _openTags.back();
+	finishTag();
+	writeEscaped(contents);
+}
 
-	tag.base64.clear();
+void XMLWriter::setContents(const byte *data, size_t size) {
+	Common::MemoryReadStream stream(data, size);
 
-	tag.contents = contents;
-	tag.empty    = false;
+	setContents(stream);
 }
 
-void XMLWriter::setContents(const byte *data, size_t size) {
-	if (_openTags.empty())
+void XMLWriter::setContents(Common::SeekableReadStream &stream) {
+	if (_openTags.empty() || !_tagOpen)
 		return;
 
-	Tag &tag = _openTags.back();
+	finishTag();
+	writeContents(stream);
+}
 
-	tag.base64.clear();
-	tag.contents.clear();
+void XMLWriter::writeContents(Common::ReadStream &data) {
+	/* Data that fits into one line of base64 is written directly after the
+	 * start tag. Otherwise, every line is written on its own, indented one
+	 * level deeper than the tag. */
 
-	Common::MemoryReadStream stream(data, size);
-	Common::encodeBase64(stream, tag.base64, 64);
+	byte input[2][kBase64LineData];
+	char line[(kBase64LineData / 3) * 4];
 
-	tag.empty = false;
-}
+	size_t size     = data.read(input[0], kBase64LineData);
+	size_t nextSize = (size == kBase64LineData) ? data.read(input[1], kBase64LineData) : 0;
 
-void XMLWriter::setContents(Common::SeekableReadStream &stream) {
-	if (_openTags.empty())
+	if (nextSize == 0) {
+		write(line, Common::encodeBase64(input[0], size, line));
 		return;
+	}
 
-	Tag &tag = _openTags.back();
+	for (size_t i = 0; size > 0; i ^= 1) {
+		write("\n");
+		_needIndent = true;
+		indent(_openTags.size());
 
-	tag.base64.clear();
-	tag.contents.clear();
+		write(line, Common::encodeBase64(input[i], size, line));
 
-	Common::encodeBase64(stream, tag.base64, 64);
+		size     = nextSize;
+		nextSize = (size == kBase64LineData) ? data.read(input[i], kBase64LineData) : 0;
+	}
 
-	tag.empty = false;
+	write("\n");
+	_needIndent = true;
 }
 
 void XMLWriter::breakLine() {
-	if (!_openTags.empty()) {
-		_openTags.back().empty = false;
-		writeTag();
-	}
+	finishTag();
 
-	_stream->writeString("\n");
+	write("\n");
 	_needIndent = true;
 }
 
@@ -25,19 +25,28 @@
 #ifndef XML_XMLWRITER_H
 #define XML_XMLWRITER_H
 
-#include <list>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 
+#include "src/common/types.h"
+#include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
 
 namespace Common {
+	class ReadStream;
 	class SeekableReadStream;
 	class WriteStream;
 }
 
 namespace XML {
 
+/** Write an XML file.
+ *
+ *  The XML is written out while it's being built, through an internal
+ *  buffer. Only the names of the currently open tags are kept. Properties
+ *  need to be added to a tag before its contents or its first child.
+ */
 class XMLWriter : boost::noncopyable {
 public:
 	XMLWriter(Common::WriteStream &stream);
@@ -64,35 +73,37 @@ public:
 	void breakLine();
 
 private:
-	struct Property {
-		Common::UString name;
-		Common::UString value;
-	};
-
-	struct Tag {
-		Common::UString name;
-
-		std::list<Property> properties;
+	static const size_t kBufferSize = 65536;
 
-		Common::UString contents;
-		std::list<Common::UString> base64;
+	Common::WriteStream *_stream;
 
-		bool written;
-		bool empty;
-	};
+	/** Output not yet written to the stream. */
+	Common::ScopedArray<byte> _buffer;
+	size_t _bufferFill;
 
-	Common::WriteStream *_stream;
+	/** The names of all open tags. */
+	std::vector<Common::UString> _openTags;
 
-	std::list<Tag> _openTags;
+	/** Is the start tag of the innermost open tag still missing its closing '>'? */
+	bool _tagOpen;
 	bool _needIndent;
 
 
 	void writeHeader();
 
 	void indent(size_t level);
-	void writeTag();
+	/** Finish the start tag of the innermost open tag, if that hasn't happened yet. */
+	void finishTag();
+
+	void writeContents(Common::ReadStream &data);
+
+	void write(const char *data, size_t size);
+	void write(const char *str);
+	void write(const Common::UString &str);
+	/** Write a string, escaping all characters special to XML. */
+	void writeEscaped(const Common::UString &str);
 
-	Common::UString escape(const Common::UString &str);
+	void flushBuffer();
 };
 
 } // End of namespace XML
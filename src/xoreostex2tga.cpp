@@ -24,6 +24,9 @@
 
 #include <cstring>
 #include <cstdio>
+#include <map>
+#include <mutex>
+#include <chrono>
 
 #include "src/version/version.h"
 
@@ -35,10 +38,13 @@
 #include "src/common/platform.h"
 #include "src/common/readstream.h"
 #include "src/common/readfile.h"
+#include "src/common/filepath.h"
+#include "src/common/parallel.h"
 #include "src/common/cli.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/util.h"
+#include "src/aurora/resman.h"
 
 #include "src/images/decoder.h"
 #include "src/images/dds.h"
@@ -51,10 +57,15 @@
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
-                      Aurora::FileType &type, bool &flip, bool &deswizzle);
+                      Aurora::FileType &type, bool &flip, bool &deswizzle, bool &toDDS,
+                      bool &batch, uint32 &jobs, Common::UString &indexCache);
 
 void convert(const Common::UString &inFile, const Common::UString &outFile,
-             Aurora::FileType type, bool flip, bool deswizzle);
+             Aurora::FileType type, bool flip, bool deswizzle, bool toDDS);
+
+size_t convertBatch(const Common::UString &inPath, const Common::UString &outDirectory,
+                    Aurora::FileType type, bool flip, bool deswizzle, bool toDDS, size_t threadCount,
+                    const Common::UString &indexCache);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -66,12 +77,28 @@ int main(int argc, char **argv) {
 		int returnValue = 1;
 		Common::UString inFile, outFile;
 		Aurora::FileType type = Aurora::kFileTypeNone;
-		bool flip = false, deswizzle = false;
+		bool flip = false, deswizzle = false, toDDS = false, batch = false;
+		uint32 jobs = 1;
+		Common::UString indexCache;
 
-		if (!parseCommandLine(args, returnValue, inFile, outFile, type, flip, deswizzle))
+		if (!parseCommandLine(args, returnValue, inFile, outFile, type, flip, deswizzle, toDDS, batch, jobs,
+		                      indexCache))
 			return returnValue;
 
-		convert(inFile, outFile, type, flip, deswizzle);
+		if (!batch) {
+			if (outFile.empty())
+				throw Common::Exception("No output file given");
+
+			Images::Decoder::setThreadCount(jobs);
+
+			convert(inFile, outFile, type, flip, deswizzle, toDDS);
+			return 0;
+		}
+
+		// In batch mode, the jobs are whole textures instead
+		if (convertBatch(inFile, outFile.empty() ? "." : outFile, type, flip, deswizzle, toDDS,
+		                 Common::getThreadCount(jobs), indexCache) > 0)
+			return 1;
 	} catch (...) {
 		Common::exceptionDispatcherError();
 	}
@@ -81,7 +108,8 @@ int main(int argc, char **argv) {
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Common::UString &inFile, Common::UString &outFile,
-                      Aurora::FileType &type, bool &flip, bool &deswizzle) {
+                      Aurora::FileType &type, bool &flip, bool &deswizzle, bool &toDDS,
+                      bool &batch, uint32 &jobs, Common::UString &indexCache) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
@@ -95,7 +123,11 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	NoOption inFileOpt(false, new ValGetter<Common::UString &>(inFile, "input files"));
 	NoOption outFileOpt(true, new ValGetter<Common::UString &>(outFile, "output files"));
 	Parser parser(argv[0], "BioWare textures to TGA converter",
-	              "",
+	              "In batch mode, the input file is an archive (ERF, RIM, ZIP, HERF), a KEY\n"
+	              "file or a directory, and the output file is the directory to write the\n"
+	              "TGA files into (default: the current directory). All textures in the\n"
+	              "input are converted; use the input type options to only convert textures\n"
+	              "of one type. By default, all but TGA files are converted.",
 	              returnValue,
 	              makeEndArgs(&inFileOpt, &outFileOpt));
 
@@ -118,6 +150,15 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	parser.addSpace();
 	parser.addOption("deswizzle", 'd', "Input file is an Xbox SBM that needs deswizzling",
 	                 kContinueParsing, makeAssigners(new ValAssigner<bool>(true, deswizzle)));
+	parser.addOption("todds", "Write a DDS instead of a TGA, without decompressing", kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, toDDS)));
+	parser.addSpace();
+	parser.addOption("batch", "Convert all textures within an archive or directory", kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, batch)));
+	parser.addOption("jobs", 'j', "Number of threads to convert with (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(jobs, "n"));
+	parser.addOption("index-cache", "In batch mode, read and update the input's index in this cache file",
+	                 kContinueParsing, new ValGetter<Common::UString &>(indexCache, "file"));
 	return parser.process(argv);
 }
 
@@ -152,16 +193,17 @@ static Aurora::FileType detectType(const Common::UString &file) {
 	return Aurora::kFileTypeNone;
 }
 
-static Images::Decoder *openImage(Common::SeekableReadStream &stream, Aurora::FileType type, bool deswizzle) {
+static Images::Decoder *openImage(Common::SeekableReadStream &stream, Aurora::FileType type,
+                                  bool deswizzle, bool keepCompressed) {
 	switch (type) {
 		case Aurora::kFileTypeDDS:
-			return new Images::DDS(stream);
+			return new Images::DDS(stream, keepCompressed);
 		case Aurora::kFileTypeSBM:
 			return new Images::SBM(stream, deswizzle);
 		case Aurora::kFileTypeTPC:
-			return new Images::TPC(stream);
+			return new Images::TPC(stream, keepCompressed);
 		case Aurora::kFileTypeTXB:
-			return new Images::TXB(stream);
+			return new Images::TXB(stream, keepCompressed);
 		case Aurora::kFileTypeTGA:
 			return new Images::TGA(stream);
 
@@ -170,8 +212,18 @@ static Images::Decoder *openImage(Common::SeekableReadStream &stream, Aurora::Fi
 	}
 }
 
+static void writeImage(Images::Decoder &image, const Common::UString &outFile, bool flip, bool toDDS) {
+	if (flip)
+		image.flipVertically();
+
+	if (toDDS)
+		image.dumpDDS(outFile);
+	else
+		image.dumpTGA(outFile);
+}
+
 void convert(const Common::UString &inFile, const Common::UString &outFile,
-             Aurora::FileType type, bool flip, bool deswizzle) {
+             Aurora::FileType type, bool flip, bool deswizzle, bool toDDS) {
 
 	Common::ReadFile in(inFile);
 
@@ -188,9 +240,183 @@ void convert(const Common::UString &inFile, const Common::UString &outFile,
 		}
 	}
 
-	Common::ScopedPtr<Images::Decoder> image(openImage(in, type, deswizzle));
-	if (flip)
-		image->flipVertically();
+	Common::ScopedPtr<Images::Decoder> image(openImage(in, type, deswizzle, toDDS));
+	writeImage(*image, outFile, flip, toDDS);
+}
+
+/** Throughput statistics of one texture type in batch mode. */
+struct BatchStats {
+	size_t count;
+	size_t failed;
+
+	uint64 bytes;  ///< Size of the input textures.
+	uint64 pixels; ///< Pixels written into TGAs.
+
+	double seconds; ///< Time spent converting, summed over all threads.
+
+	BatchStats() : count(0), failed(0), bytes(0), pixels(0), seconds(0.0) {
+	}
+};
+
+/** One texture to convert in batch mode. */
+struct TextureJob {
+	const Aurora::ResourceManager::Resource *texture;
+
+	Common::UString outFile;
+
+	TextureJob() : texture(0) {
+	}
+};
+
+/** Make sure that no output file would overwrite a file we read from. */
+static void checkOverwrite(const Aurora::ResourceManager &resources, const std::vector<TextureJob> &jobs,
+                           const Common::UString &inPath, Aurora::FileType outType) {
+
+	const Common::UString inFile = Common::FilePath::canonicalize(inPath);
+
+	for (std::vector<TextureJob>::const_iterator j = jobs.begin(); j != jobs.end(); ++j) {
+		const Common::UString outFile = Common::FilePath::canonicalize(j->outFile);
+
+		bool overwrite = outFile == inFile;
+
+		// A loose file the output would replace, by the name it's indexed under
+		const Common::UString outName = TypeMan.setFileType(Common::FilePath::getFile(outFile), Aurora::kFileTypeNone);
+		const Aurora::ResourceManager::Resource *source = resources.findResource(outName, outType);
+		if (source && !source->path.empty())
+			overwrite = overwrite || (Common::FilePath::canonicalize(source->path) == outFile);
+
+		if (overwrite)
+			throw Common::Exception("Output file \"%s\" would overwrite an input file", j->outFile.c_str());
+	}
+}
+
+static void addResources(Aurora::ResourceManager &resources, const Common::UString &inPath) {
+	if (Common::FilePath::isDirectory(inPath)) {
+		resources.addDirectory(inPath, 0, true);
+		return;
+	}
+
+	const Aurora::FileType type = TypeMan.getFileType(inPath);
+
+	if (type == Aurora::kFileTypeKEY) {
+		resources.addKEY(inPath, Common::FilePath::getDirectory(inPath), 0);
+		return;
+	}
+
+	if ((type == Aurora::kFileTypeBIF) || (type == Aurora::kFileTypeBZF))
+		throw Common::Exception("BIF and BZF files can only be read through their KEY file");
+
+	resources.addArchive(inPath, 0);
+}
+
+size_t convertBatch(const Common::UString &inPath, const Common::UString &outDirectory,
+                    Aurora::FileType type, bool flip, bool deswizzle, bool toDDS, size_t threadCount,
+                    const Common::UString &indexCache) {
+
+	Aurora::ResourceManager resources;
+	if (!indexCache.empty())
+		resources.loadIndexCache(indexCache);
+
+	addResources(resources, inPath);
+
+	static const Aurora::FileType kTypes[] = {
+		Aurora::kFileTypeDDS, Aurora::kFileTypeSBM, Aurora::kFileTypeTPC, Aurora::kFileTypeTXB
+	};
+
+	std::vector<const Aurora::ResourceManager::Resource *> textures;
+	if (type != Aurora::kFileTypeNone)
+		resources.getResources(type, textures);
+	else
+		for (size_t i = 0; i < ARRAYSIZE(kTypes); i++)
+			resources.getResources(kTypes[i], textures);
+
+	const Aurora::FileType outType = toDDS ? Aurora::kFileTypeDDS : Aurora::kFileTypeTGA;
+
+	/* Textures of the same name but different types would be written into the
+	 * same output file. Those keep their type in the output name, foo.tpc.tga. */
+	std::map<Common::UString, size_t> nameCount;
+	for (size_t i = 0; i < textures.size(); i++)
+		nameCount[textures[i]->name.toLower()]++;
+
+	std::vector<TextureJob> jobs(textures.size());
+	for (size_t i = 0; i < textures.size(); i++) {
+		const Aurora::ResourceManager::Resource &texture = *textures[i];
+
+		Common::UString outName = texture.name;
+		if (nameCount[texture.name.toLower()] > 1)
+			outName = TypeMan.addFileType(outName, texture.type);
+
+		jobs[i].texture = &texture;
+		jobs[i].outFile = outDirectory + "/" + TypeMan.addFileType(outName, outType);
+	}
+
+	checkOverwrite(resources, jobs, inPath, outType);
+
+	Common::FilePath::createDirectories(outDirectory);
+
+	std::map<Aurora::FileType, BatchStats> stats;
+	std::mutex statsMutex;
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	const size_t failed = runBatchJobs(jobs.size(), threadCount, [&](size_t i) {
+		return TypeMan.addFileType(jobs[i].texture->name, jobs[i].texture->type);
+	}, [&](size_t i) {
+		const TextureJob &job = jobs[i];
+		const Aurora::FileType textureType = job.texture->type;
+
+		const std::chrono::steady_clock::time_point jobStart = std::chrono::steady_clock::now();
+
+		uint64 bytes = 0, pixels = 0;
+
+		try {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(resources.getResource(*job.texture));
+
+			bytes = stream->size();
+
+			Common::ScopedPtr<Images::Decoder> image(openImage(*stream, textureType, deswizzle, toDDS));
+			writeImage(*image, job.outFile, flip, toDDS);
+
+			for (size_t layer = 0; layer < image->getLayerCount(); layer++)
+				pixels += image->getMipMap(0, layer).width * image->getMipMap(0, layer).height;
+		} catch (...) {
+			// Count the failure, then let runBatchJobs() report it
+			std::lock_guard<std::mutex> lock(statsMutex);
+			stats[textureType].failed++;
+
+			throw;
+		}
+
+		const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - jobStart;
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+
+		BatchStats &typeStats = stats[textureType];
+
+		typeStats.count   += 1;
+		typeStats.bytes   += bytes;
+		typeStats.pixels  += pixels;
+		typeStats.seconds += duration.count();
+	});
+
+	const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+	for (std::map<Aurora::FileType, BatchStats>::const_iterator s = stats.begin(); s != stats.end(); ++s) {
+		const BatchStats &typeStats = s->second;
+		const double seconds = MAX(typeStats.seconds, 0.000001);
+
+		status("%s: %u converted, %u failed, %s read, %.1f MPixels written; %.1f textures/s, %.1f MPixels/s per thread",
+		       TypeMan.setFileType("*", s->first).c_str(), (uint) typeStats.count, (uint) typeStats.failed,
+		       Common::FilePath::getHumanReadableSize(typeStats.bytes).c_str(), typeStats.pixels / 1000000.0,
+		       typeStats.count / seconds, typeStats.pixels / 1000000.0 / seconds);
+	}
+
+	status("Converted %u of %u textures with %u threads in %.2fs",
+	       (uint) (textures.size() - failed), (uint) textures.size(), (uint) threadCount, duration.count());
+
+	// BIFs and BZFs opened while converting recorded where their resources are
+	if (!indexCache.empty() && resources.isIndexCacheModified())
+		resources.saveIndexCache(indexCache);
 
-	image->dumpTGA(outFile);
+	return failed;
 }
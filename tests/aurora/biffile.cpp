@@ -183,6 +183,21 @@ GTEST_TEST(BIFFile10, mergeKEY) {
 	EXPECT_EQ(resource.index, 0);
 }
 
+GTEST_TEST(BIFFile10, findResourceAfterMergeKEY) {
+	Common::MemoryReadStream *stream = new Common::MemoryReadStream(kBIF10File);
+	Aurora::BIFFile bif(stream);
+
+	EXPECT_EQ(bif.findResource("ozymandias", Aurora::kFileTypeTXT), 0xFFFFFFFF);
+
+	Common::MemoryReadStream keyStream(kKEYFile);
+	Aurora::KEYFile key(keyStream);
+
+	bif.mergeKEY(key, 0);
+
+	EXPECT_EQ(bif.findResource("ozymandias", Aurora::kFileTypeTXT), 0);
+	EXPECT_EQ(bif.findResource("ozymandias", Aurora::kFileTypeBMP), 0xFFFFFFFF);
+}
+
 // --- BIF V1.1 ---
 
 // Percy Bysshe Shelley's "Ozymandias", within a BIF V1.1 file
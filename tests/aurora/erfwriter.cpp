@@ -22,9 +22,14 @@
  *  Unit tests for our ERF file archive writer class.
  */
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 
+#include "src/common/scopedptr.h"
+#include "src/common/memreadstream.h"
 #include "src/common/memwritestream.h"
+#include "src/common/deflate.h"
 
 #include "src/aurora/erfwriter.h"
 #include "src/aurora/erffile.h"
@@ -904,3 +909,99 @@ GTEST_TEST(ERFWriter, WriteMultipleFilesV22HeaderlessZlib) {
 	delete readStream2;
 	delete readStream3;
 }
+
+GTEST_TEST(ERFWriter, WriteAllV22BiowareZlibParallel) {
+	static const size_t kFileCount = 16;
+
+	// Alternating text, which compresses well, and random data, which doesn't at all
+	byte kRandomData[512];
+	uint32 seed = 0x12345678;
+	for (size_t i = 0; i < sizeof(kRandomData); i++) {
+		seed = seed * 1103515245 + 12345;
+		kRandomData[i] = seed >> 24;
+	}
+
+	const size_t kFileDataSize = Common::MemoryReadStream(kFileData, true).size();
+
+	std::vector<Aurora::ERFWriter::Resource> resources(kFileCount);
+	for (size_t i = 0; i < kFileCount; i++) {
+		resources[i].resRef  = Common::UString::format("file%02u", (uint)i);
+		resources[i].resType = Aurora::kFileTypeTXT;
+
+		if (i % 2)
+			resources[i].open = [&]() { return new Common::MemoryReadStream(kRandomData, sizeof(kRandomData)); };
+		else
+			resources[i].open = []() { return new Common::MemoryReadStream(kFileData, true); };
+	}
+
+	Common::MemoryWriteStreamDynamic writeStream;
+	Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), kFileCount, writeStream,
+	                            Aurora::ERFWriter::kERFVersion22, Aurora::ERFWriter::kCompressionBiowareZlib);
+
+	erfWriter.setCompressionLevel(1);
+
+	size_t packed = 0;
+	erfWriter.addAll(resources, 4, [&](size_t i) { EXPECT_EQ(i, packed++); });
+
+	EXPECT_EQ(packed, kFileCount);
+
+	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
+	ASSERT_EQ(erf.getResources().size(), kFileCount);
+
+	for (size_t i = 0; i < kFileCount; i++) {
+		EXPECT_EQ(erf.findResource(resources[i].resRef, Aurora::kFileTypeTXT), i);
+
+		const byte  *data = (i % 2) ? kRandomData : reinterpret_cast<const byte *>(kFileData);
+		const size_t size = (i % 2) ? sizeof(kRandomData) : kFileDataSize;
+
+		Common::ScopedPtr<Common::SeekableReadStream> readStream(erf.getResource(i));
+		ASSERT_EQ(readStream->size(), size);
+
+		Common::ScopedArray<byte> fileData(new byte[size]);
+		readStream->read(fileData.get(), size);
+
+		for (size_t j = 0; j < size; ++j)
+			EXPECT_EQ(fileData[j], data[j]) << "At file " << i << ", index " << j;
+	}
+}
+
+GTEST_TEST(ERFWriter, WriteInvalidCompressionLevel) {
+	Common::MemoryWriteStreamDynamic writeStream;
+	Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), 0, writeStream,
+	                            Aurora::ERFWriter::kERFVersion22, Aurora::ERFWriter::kCompressionBiowareZlib);
+
+	EXPECT_THROW(erfWriter.setCompressionLevel(10), Common::Exception);
+	EXPECT_THROW(erfWriter.setCompressionLevel(-1), Common::Exception);
+}
+
+GTEST_TEST(ERFWriter, WriteLargeV22BiowareZlib) {
+	static const size_t kLargeSize = 2 * Common::kInflateStreamThreshold;
+
+	Common::ScopedArray<byte> largeData(new byte[kLargeSize]);
+	for (size_t i = 0; i < kLargeSize; i++)
+		largeData[i] = (i * 7) ^ (i >> 12);
+
+	Common::MemoryWriteStreamDynamic writeStream;
+	Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), 1, writeStream,
+	                            Aurora::ERFWriter::kERFVersion22, Aurora::ERFWriter::kCompressionBiowareZlib);
+
+	Common::MemoryReadStream largeStream(largeData.get(), kLargeSize);
+	erfWriter.add("large", Aurora::kFileTypeTXT, largeStream);
+
+	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
+	ASSERT_EQ(erf.getResources().size(), 1);
+
+	// A plain copy, and a stream that is inflated while it's read
+	Common::ScopedPtr<Common::SeekableReadStream> copy(erf.getResource(0));
+	Common::ScopedPtr<Common::SeekableReadStream> streamed(erf.getResourceStreamed(0));
+
+	ASSERT_EQ(copy->size(), kLargeSize);
+	ASSERT_EQ(streamed->size(), kLargeSize);
+
+	ASSERT_NE(copy->getData(), static_cast<const byte *>(0));
+	EXPECT_EQ(std::memcmp(copy->getData(), largeData.get(), kLargeSize), 0);
+
+	Common::ScopedArray<byte> streamedData(new byte[kLargeSize]);
+	ASSERT_EQ(streamed->read(streamedData.get(), kLargeSize), kLargeSize);
+	EXPECT_EQ(std::memcmp(streamedData.get(), largeData.get(), kLargeSize), 0);
+}
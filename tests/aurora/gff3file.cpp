@@ -28,7 +28,9 @@
 
 #include "src/common/util.h"
 #include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/memreadstream.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/locstring.h"
 #include "src/aurora/language.h"
@@ -157,6 +159,40 @@ GTEST_TEST(GFF3Struct, getFieldNames) {
 		EXPECT_STREQ(fieldNames[i].c_str(), kFieldNamesSingle[i]) << "At index " << i;
 }
 
+GTEST_TEST(GFF3Struct, getFieldNamesDuplicate) {
+	// One struct with the fields FieldA = 1, FieldB = 2 and FieldA = 3
+	static const byte kGFF3Duplicate[] = {
+		0x47,0x46,0x46,0x20,0x56,0x33,0x2E,0x32,0x38,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+		0x44,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x68,0x00,0x00,0x00,0x03,0x00,0x00,0x00,
+		0x98,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x98,0x00,0x00,0x00,0x0C,0x00,0x00,0x00,
+		0xA4,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,0x00,0x00,
+		0x03,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+		0x04,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
+		0x02,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x41,0x00,0x00,
+		0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x42,0x00,0x00,
+		0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x41,0x00,0x00,
+		0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+		0x02,0x00,0x00,0x00
+	};
+
+	const Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3Duplicate));
+	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
+
+	// All field names are listed, in file order, duplicates included
+	const std::vector<Common::UString> fieldNames = strct.getFieldNames();
+	ASSERT_EQ(fieldNames.size(), 3);
+
+	EXPECT_STREQ(fieldNames[0].c_str(), "FieldA");
+	EXPECT_STREQ(fieldNames[1].c_str(), "FieldB");
+	EXPECT_STREQ(fieldNames[2].c_str(), "FieldA");
+
+	// But there are only two distinct fields, and the last FieldA wins
+	EXPECT_EQ(strct.getFieldCount(), 2);
+
+	EXPECT_EQ(strct.getUint("FieldA"), 3);
+	EXPECT_EQ(strct.getUint("FieldB"), 2);
+}
+
 GTEST_TEST(GFF3Struct, getFieldType) {
 	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3SingleStruct));
 	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
@@ -271,6 +307,22 @@ GTEST_TEST(GFF3Struct, getString) {
 	Aurora::LanguageManager::destroy();
 }
 
+GTEST_TEST(GFF3Struct, getStringParallel) {
+	static const size_t kCount = 1000;
+
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3SingleStruct));
+	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
+
+	std::vector<Common::UString> values(kCount);
+
+	Common::parallelFor(4, kCount, [&](size_t i) {
+		values[i] = strct.getString((i % 2) ? "FieldExoString" : "FieldResRef");
+	});
+
+	for (size_t i = 0; i < kCount; i++)
+		EXPECT_STREQ(values[i].c_str(), (i % 2) ? "Foobar" : "Barfoo") << "At index " << i;
+}
+
 GTEST_TEST(GFF3Struct, getLocString) {
 	LangMan.addLanguage(Aurora::kLanguageEnglish, 0, Common::kEncodingUTF8);
 
@@ -520,43 +572,47 @@ GTEST_TEST(GFF3Struct, getStruct) {
 	EXPECT_EQ(strct0.getUint("FieldUint32"), 32);
 	EXPECT_EQ(strct1.getUint("FieldUint32"), 33);
 	EXPECT_EQ(strct2.getUint("FieldUint32"), 34);
+
+	EXPECT_EQ(strct0.getStructIndex("FieldStruct"), 1);
+	EXPECT_EQ(strct1.getStructIndex("FieldStruct"), 2);
+	EXPECT_THROW(strct2.getStructIndex("FieldUint32"), Common::Exception);
 }
 
 // --- GFF3, lists ---
 
-GTEST_TEST(GFF3Struct, getList) {
-	static const byte kGFF3Lists[] = {
-		0x47,0x46,0x46,0x20,0x56,0x33,0x2E,0x32,0x38,0x00,0x00,0x00,0x0A,0x00,0x00,0x00,
-		0xB0,0x00,0x00,0x00,0x0E,0x00,0x00,0x00,0x58,0x01,0x00,0x00,0x02,0x00,0x00,0x00,
-		0x78,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x78,0x01,0x00,0x00,0x20,0x00,0x00,0x00,
-		0x98,0x01,0x00,0x00,0x34,0x00,0x00,0x00,0x17,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-		0x02,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x08,0x00,0x00,0x00,0x02,0x00,0x00,0x00,
-		0x19,0x00,0x00,0x00,0x10,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x1A,0x00,0x00,0x00,
-		0x18,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x1B,0x00,0x00,0x00,0x08,0x00,0x00,0x00,
-		0x01,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x09,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
-		0x1D,0x00,0x00,0x00,0x0A,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x1E,0x00,0x00,0x00,
-		0x0B,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x1F,0x00,0x00,0x00,0x0C,0x00,0x00,0x00,
-		0x01,0x00,0x00,0x00,0x20,0x00,0x00,0x00,0x0D,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
-		0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x20,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,
-		0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-		0x21,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x10,0x00,0x00,0x00,
-		0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x22,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,
-		0x01,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-		0x23,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x28,0x00,0x00,0x00,
-		0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x24,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
-		0x00,0x00,0x00,0x00,0x25,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-		0x26,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x27,0x00,0x00,0x00,
-		0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x28,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
-		0x00,0x00,0x00,0x00,0x29,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x55,0x69,0x6E,
-		0x74,0x33,0x32,0x00,0x00,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x4C,0x69,0x73,
-		0x74,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
-		0x02,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x05,0x00,0x00,0x00,
-		0x06,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
-		0x02,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
-		0x05,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x06,0x00,0x00,0x00,0x07,0x00,0x00,0x00,
-		0x02,0x00,0x00,0x00,0x08,0x00,0x00,0x00,0x09,0x00,0x00,0x00
-	};
+static const byte kGFF3Lists[] = {
+	0x47,0x46,0x46,0x20,0x56,0x33,0x2E,0x32,0x38,0x00,0x00,0x00,0x0A,0x00,0x00,0x00,
+	0xB0,0x00,0x00,0x00,0x0E,0x00,0x00,0x00,0x58,0x01,0x00,0x00,0x02,0x00,0x00,0x00,
+	0x78,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x78,0x01,0x00,0x00,0x20,0x00,0x00,0x00,
+	0x98,0x01,0x00,0x00,0x34,0x00,0x00,0x00,0x17,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x02,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x08,0x00,0x00,0x00,0x02,0x00,0x00,0x00,
+	0x19,0x00,0x00,0x00,0x10,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x1A,0x00,0x00,0x00,
+	0x18,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x1B,0x00,0x00,0x00,0x08,0x00,0x00,0x00,
+	0x01,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x09,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+	0x1D,0x00,0x00,0x00,0x0A,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x1E,0x00,0x00,0x00,
+	0x0B,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x1F,0x00,0x00,0x00,0x0C,0x00,0x00,0x00,
+	0x01,0x00,0x00,0x00,0x20,0x00,0x00,0x00,0x0D,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+	0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x20,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,
+	0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x21,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x10,0x00,0x00,0x00,
+	0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x22,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,
+	0x01,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x23,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x28,0x00,0x00,0x00,
+	0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x24,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x25,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x26,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x27,0x00,0x00,0x00,
+	0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x28,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x29,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x55,0x69,0x6E,
+	0x74,0x33,0x32,0x00,0x00,0x00,0x00,0x00,0x46,0x69,0x65,0x6C,0x64,0x4C,0x69,0x73,
+	0x74,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+	0x02,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x05,0x00,0x00,0x00,
+	0x06,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
+	0x02,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x04,0x00,0x00,0x00,
+	0x05,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x06,0x00,0x00,0x00,0x07,0x00,0x00,0x00,
+	0x02,0x00,0x00,0x00,0x08,0x00,0x00,0x00,0x09,0x00,0x00,0x00
+};
 
+GTEST_TEST(GFF3Struct, getList) {
 	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3Lists));
 	const Aurora::GFF3Struct &strct0 = gff3.getTopLevel();
 
@@ -636,6 +692,85 @@ GTEST_TEST(GFF3Struct, getList) {
 	EXPECT_EQ(strct9.getUint("FieldUint32"), 41);
 }
 
+GTEST_TEST(GFF3Struct, getListLazy) {
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3Lists), 0xFFFFFFFF, false, true);
+	const Aurora::GFF3Struct &strct0 = gff3.getTopLevel();
+
+	EXPECT_EQ(&gff3.getTopLevel(), &strct0);
+
+	EXPECT_EQ(strct0.getFieldCount(), 2);
+	EXPECT_EQ(strct0.getID(), 23);
+	EXPECT_EQ(strct0.getUint("FieldUint32"), 32);
+
+	const Aurora::GFF3List &list0 = strct0.getList("FieldList");
+	EXPECT_EQ(&strct0.getList("FieldList"), &list0);
+
+	ASSERT_EQ(list0.size(), 3);
+	ASSERT_NE(list0[2], static_cast<const Aurora::GFF3Struct *>(0));
+
+	const Aurora::GFF3Struct &strct3 = *list0[2];
+	EXPECT_EQ(strct3.getFieldCount(), 2);
+	EXPECT_EQ(strct3.getID(), 26);
+	EXPECT_EQ(strct3.getUint("FieldUint32"), 35);
+
+	const Aurora::GFF3List &list3 = strct3.getList("FieldList");
+
+	ASSERT_EQ(list3.size(), 2);
+	ASSERT_NE(list3[1], static_cast<const Aurora::GFF3Struct *>(0));
+
+	const Aurora::GFF3Struct &strct9 = *list3[1];
+	EXPECT_EQ(strct9.getFieldCount(), 1);
+	EXPECT_EQ(strct9.getID(), 32);
+	EXPECT_EQ(strct9.getUint("FieldUint32"), 41);
+}
+
+GTEST_TEST(GFF3File, readStruct) {
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3Lists), 0xFFFFFFFF, false, true);
+
+	EXPECT_THROW(gff3.readStruct(10), Common::Exception);
+
+	Common::ScopedPtr<Aurora::GFF3Struct> strct0(gff3.readStruct(0));
+	ASSERT_TRUE(strct0);
+
+	EXPECT_EQ(strct0->getID(), 23);
+	EXPECT_EQ(strct0->getUint("FieldUint32"), 32);
+
+	EXPECT_THROW(strct0->getStructIndex("FieldList"), Common::Exception);
+
+	std::vector<uint32> list0;
+	EXPECT_THROW(strct0->getListIndices("FieldUint32", list0), Common::Exception);
+	EXPECT_THROW(strct0->getListIndices("Nope"       , list0), Common::Exception);
+
+	strct0->getListIndices("FieldList", list0);
+
+	ASSERT_EQ(list0.size(), 3);
+	EXPECT_EQ(list0[0], 1);
+	EXPECT_EQ(list0[1], 2);
+	EXPECT_EQ(list0[2], 3);
+
+	Common::ScopedPtr<Aurora::GFF3Struct> strct3(gff3.readStruct(list0[2]));
+	ASSERT_TRUE(strct3);
+
+	EXPECT_EQ(strct3->getID(), 26);
+	EXPECT_EQ(strct3->getUint("FieldUint32"), 35);
+
+	std::vector<uint32> list3;
+	strct3->getListIndices("FieldList", list3);
+
+	ASSERT_EQ(list3.size(), 2);
+	EXPECT_EQ(list3[0], 8);
+	EXPECT_EQ(list3[1], 9);
+
+	Common::ScopedPtr<Aurora::GFF3Struct> strct9(gff3.readStruct(list3[1]));
+	ASSERT_TRUE(strct9);
+
+	EXPECT_EQ(strct9->getID(), 32);
+	EXPECT_EQ(strct9->getUint("FieldUint32"), 41);
+
+	// Structs read on their own are not the ones kept within the GFF3
+	EXPECT_NE(&gff3.getTopLevel(), strct0.get());
+}
+
 // --- GFF3, V3.3 ---
 
 GTEST_TEST(GFF3File, GFF3V33) {
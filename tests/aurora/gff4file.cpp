@@ -41,6 +41,7 @@
 #include "src/common/error.h"
 #include "src/common/encoding.h"
 #include "src/common/memreadstream.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/gff4file.h"
 
@@ -238,6 +239,22 @@ GTEST_TEST(GFF4StructSingle, getUint) {
 	EXPECT_THROW(strct.getUint(1024), Common::Exception);
 }
 
+GTEST_TEST(GFF4StructSingle, getUintParallel) {
+	static const size_t kCount = 1000;
+
+	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4SingleValues));
+	const Aurora::GFF4Struct &strct = gff4.getTopLevel();
+
+	std::vector<uint64> values(kCount);
+
+	Common::parallelFor(4, kCount, [&](size_t i) {
+		values[i] = strct.getUint(256 + (i % 4) * 2);
+	});
+
+	for (size_t i = 0; i < kCount; i++)
+		EXPECT_EQ(values[i], 23 + (i % 4)) << "At index " << i;
+}
+
 GTEST_TEST(GFF4StructSingle, getSint) {
 	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4SingleValues));
 	const Aurora::GFF4Struct &strct = gff4.getTopLevel();
@@ -0,0 +1,227 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our GFF path query class.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/gff3file.h"
+#include "src/aurora/gff3writer.h"
+#include "src/aurora/gff4file.h"
+#include "src/aurora/gffquery.h"
+
+static Aurora::GFF3File *createGFF3() {
+	Aurora::GFF3Writer writer(MKTAG('U', 'T', 'C', ' '));
+
+	Aurora::GFF3WriterStructPtr top = writer.getTopLevel();
+	top->addExoString("Tag", "creature");
+	top->addUint16("Appearance_Type", 23);
+	top->addExoString("Description", "A \"creature\".\r\nIt's\tC:\\creature.");
+
+	Aurora::GFF3WriterListPtr items = top->addList("ItemList");
+	items->addStruct()->addExoString("Tag", "sword");
+	items->addStruct()->addExoString("Tag", "shield");
+	items->addStruct()->addSint32("Stack", -5);
+
+	Aurora::GFF3WriterListPtr creatures = top->addList("Creature List");
+	for (int i = 0; i < 4; i++)
+		creatures->addStruct()->addUint16("Appearance_Type", 100 + i);
+
+	top->addStruct("Stats")->addByte("Str", 18);
+
+	Common::MemoryWriteStreamDynamic data(true);
+	writer.write(data);
+
+	data.setDisposable(false);
+
+	return new Aurora::GFF3File(new Common::MemoryReadStream(data.getData(), data.size(), true));
+}
+
+GTEST_TEST(GFFQuery, parse) {
+	EXPECT_STREQ(Aurora::GFFQuery("ItemList[*].Tag").getQuery().c_str(), "ItemList[*].Tag");
+
+	EXPECT_NO_THROW(Aurora::GFFQuery("Tag"));
+	EXPECT_NO_THROW(Aurora::GFFQuery("/Creature List[3]/Appearance_Type"));
+	EXPECT_NO_THROW(Aurora::GFFQuery("*[*].*"));
+
+	EXPECT_THROW(Aurora::GFFQuery(""), Common::Exception);
+	EXPECT_THROW(Aurora::GFFQuery("/"), Common::Exception);
+	EXPECT_THROW(Aurora::GFFQuery("ItemList."), Common::Exception);
+	EXPECT_THROW(Aurora::GFFQuery("ItemList//Tag"), Common::Exception);
+	EXPECT_THROW(Aurora::GFFQuery("ItemList[0"), Common::Exception);
+	EXPECT_THROW(Aurora::GFFQuery("ItemList[x]"), Common::Exception);
+	EXPECT_THROW(Aurora::GFFQuery("ItemList[0]Tag"), Common::Exception);
+	EXPECT_THROW(Aurora::GFFQuery("ItemList]"), Common::Exception);
+}
+
+GTEST_TEST(GFFQuery, evaluateGFF3Field) {
+	Common::ScopedPtr<Aurora::GFF3File> gff3(createGFF3());
+
+	Aurora::GFFQuery::Results results;
+	Aurora::GFFQuery("Appearance_Type").evaluate(gff3->getTopLevel(), results);
+
+	ASSERT_EQ(results.size(), 1);
+	EXPECT_STREQ(results[0].path.c_str(), "/Appearance_Type");
+	EXPECT_STREQ(results[0].type.c_str(), "uint16");
+	EXPECT_STREQ(results[0].value.c_str(), "23");
+}
+
+GTEST_TEST(GFFQuery, evaluateGFF3List) {
+	Common::ScopedPtr<Aurora::GFF3File> gff3(createGFF3());
+
+	Aurora::GFFQuery::Results results;
+	Aurora::GFFQuery("ItemList[*].Tag").evaluate(gff3->getTopLevel(), results);
+
+	ASSERT_EQ(results.size(), 2);
+	EXPECT_STREQ(results[0].path.c_str(), "/ItemList[0]/Tag");
+	EXPECT_STREQ(results[0].type.c_str(), "exostring");
+	EXPECT_STREQ(results[0].value.c_str(), "sword");
+	EXPECT_STREQ(results[1].path.c_str(), "/ItemList[1]/Tag");
+	EXPECT_STREQ(results[1].value.c_str(), "shield");
+
+	results.clear();
+	Aurora::GFFQuery("/Creature List[3]/Appearance_Type").evaluate(gff3->getTopLevel(), results);
+
+	ASSERT_EQ(results.size(), 1);
+	EXPECT_STREQ(results[0].path.c_str(), "/Creature List[3]/Appearance_Type");
+	EXPECT_STREQ(results[0].value.c_str(), "103");
+
+	results.clear();
+	Aurora::GFFQuery("Creature List[4]/Appearance_Type").evaluate(gff3->getTopLevel(), results);
+	EXPECT_TRUE(results.empty());
+
+	results.clear();
+	Aurora::GFFQuery("ItemList").evaluate(gff3->getTopLevel(), results);
+
+	ASSERT_EQ(results.size(), 1);
+	EXPECT_STREQ(results[0].type.c_str(), "list");
+	EXPECT_STREQ(results[0].value.c_str(), "3");
+}
+
+GTEST_TEST(GFFQuery, evaluateGFF3Struct) {
+	Common::ScopedPtr<Aurora::GFF3File> gff3(createGFF3());
+
+	Aurora::GFFQuery::Results results;
+	Aurora::GFFQuery("Stats.Str").evaluate(gff3->getTopLevel(), results);
+
+	ASSERT_EQ(results.size(), 1);
+	EXPECT_STREQ(results[0].path.c_str(), "/Stats/Str");
+	EXPECT_STREQ(results[0].type.c_str(), "byte");
+	EXPECT_STREQ(results[0].value.c_str(), "18");
+
+	results.clear();
+	Aurora::GFFQuery("Stats[0].Str").evaluate(gff3->getTopLevel(), results);
+	EXPECT_TRUE(results.empty());
+
+	results.clear();
+	Aurora::GFFQuery("Tag.Str").evaluate(gff3->getTopLevel(), results);
+	EXPECT_TRUE(results.empty());
+}
+
+GTEST_TEST(GFFQuery, evaluateGFF3Wildcard) {
+	Common::ScopedPtr<Aurora::GFF3File> gff3(createGFF3());
+
+	Aurora::GFFQuery::Results results;
+	Aurora::GFFQuery("ItemList[*]/*").evaluate(gff3->getTopLevel(), results);
+
+	ASSERT_EQ(results.size(), 3);
+	EXPECT_STREQ(results[0].path.c_str(), "/ItemList[0]/Tag");
+	EXPECT_STREQ(results[1].path.c_str(), "/ItemList[1]/Tag");
+	EXPECT_STREQ(results[2].path.c_str(), "/ItemList[2]/Stack");
+	EXPECT_STREQ(results[2].type.c_str(), "sint32");
+	EXPECT_STREQ(results[2].value.c_str(), "-5");
+}
+
+GTEST_TEST(GFFQuery, escape) {
+	EXPECT_STREQ(Aurora::GFFQuery::escape("Nothing to escape").c_str(), "Nothing to escape");
+	EXPECT_STREQ(Aurora::GFFQuery::escape("One\ttwo\r\nthree\\four\n").c_str(), "One\\ttwo\\r\\nthree\\\\four\\n");
+	EXPECT_STREQ(Aurora::GFFQuery::escape("").c_str(), "");
+}
+
+GTEST_TEST(GFFQuery, evaluateGFF3MultiLine) {
+	Common::ScopedPtr<Aurora::GFF3File> gff3(createGFF3());
+
+	Aurora::GFFQuery::Results results;
+	Aurora::GFFQuery("Description").evaluate(gff3->getTopLevel(), results);
+
+	// The result holds the raw value, which is only escaped for printing
+	ASSERT_EQ(results.size(), 1);
+	EXPECT_STREQ(results[0].value.c_str(), "A \"creature\".\r\nIt's\tC:\\creature.");
+	EXPECT_STREQ(Aurora::GFFQuery::escape(results[0].value).c_str(), "A \"creature\".\\r\\nIt's\\tC:\\\\creature.");
+}
+
+// --- GFF4, lists (the same data as in the GFF4File tests) ---
+static const byte kGFF4Lists[] = {
+	0x47,0x46,0x46,0x20,0x56,0x34,0x2E,0x30,0x50,0x43,0x20,0x20,0x54,0x45,0x53,0x54,
+	0x56,0x31,0x2E,0x30,0x03,0x00,0x00,0x00,0x88,0x00,0x00,0x00,0x53,0x43,0x54,0x31,
+	0x02,0x00,0x00,0x00,0x4C,0x00,0x00,0x00,0x2A,0x00,0x00,0x00,0x53,0x43,0x54,0x32,
+	0x02,0x00,0x00,0x00,0x64,0x00,0x00,0x00,0x0B,0x00,0x00,0x00,0x53,0x43,0x54,0x33,
+	0x01,0x00,0x00,0x00,0x7C,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x00,0x01,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x01,0x00,0x00,0x01,0x00,0x00,0xC0,
+	0x01,0x00,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x01,0x02,0x00,0x00,0x02,0x00,0x00,0xC0,0x01,0x00,0x00,0x00,0x00,0x03,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x17,0x05,0x00,0x00,0x00,0x03,0x00,0x00,
+	0x00,0x18,0x0E,0x00,0x00,0x00,0x02,0x00,0x00,0x00,0x19,0x1A,0x1B,0x19,0x00,0x00,
+	0x00,0x02,0x00,0x00,0x00,0x1C,0x1D,0x1E,0x24,0x00,0x00,0x00,0x02,0x00,0x00,0x00,
+	0x1F,0x20
+};
+
+GTEST_TEST(GFFQuery, evaluateGFF4) {
+	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4Lists));
+
+	Aurora::GFFQuery::Results results;
+	Aurora::GFFQuery("257[*]/513[*]/768").evaluate(gff4.getTopLevel(), results);
+
+	static const char * const kValues[] = { "25", "26", "28", "29", "31", "32" };
+
+	ASSERT_EQ(results.size(), ARRAYSIZE(kValues));
+	for (size_t i = 0; i < ARRAYSIZE(kValues); i++)
+		EXPECT_STREQ(results[i].value.c_str(), kValues[i]) << "At index " << i;
+
+	EXPECT_STREQ(results[0].path.c_str(), "/257[0]/513[0]/768");
+	EXPECT_STREQ(results[5].path.c_str(), "/257[2]/513[1]/768");
+
+	results.clear();
+	Aurora::GFFQuery("/257[1].512").evaluate(gff4.getTopLevel(), results);
+
+	ASSERT_EQ(results.size(), 1);
+	EXPECT_STREQ(results[0].value.c_str(), "27");
+
+	results.clear();
+	Aurora::GFFQuery("257").evaluate(gff4.getTopLevel(), results);
+
+	ASSERT_EQ(results.size(), 1);
+	EXPECT_STREQ(results[0].type.c_str(), "struct_list");
+	EXPECT_STREQ(results[0].value.c_str(), "3");
+
+	results.clear();
+	Aurora::GFFQuery("Tag").evaluate(gff4.getTopLevel(), results);
+	EXPECT_TRUE(results.empty());
+}
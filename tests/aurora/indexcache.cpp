@@ -0,0 +1,201 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our index cache and the archives read through it.
+ */
+
+#include <cstring>
+#include <ctime>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/platform.h"
+#include "src/common/filepath.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/writefile.h"
+#include "src/common/encoding.h"
+
+#include "src/aurora/indexcache.h"
+#include "src/aurora/cachedarchive.h"
+#include "src/aurora/rimwriter.h"
+#include "src/aurora/erfwriter.h"
+#include "src/aurora/erffile.h"
+
+static boost::filesystem::path kDirectory;
+
+static Common::UString getPath(const char *file) {
+	return (kDirectory / file).generic_string();
+}
+
+static Common::UString readResource(const Aurora::Archive &archive, uint32 index) {
+	Common::ScopedPtr<Common::SeekableReadStream> stream(archive.getResource(index));
+
+	return Common::readString(*stream, Common::kEncodingASCII);
+}
+
+/** Write a RIM with two resources, with a modification time of whole seconds. */
+static void writeRIM(const char *file, const char *a, const char *b, std::time_t time) {
+	{
+		Common::WriteFile rim(getPath(file));
+		Aurora::RIMWriter rimWriter(2, rim);
+
+		Common::MemoryReadStream aStream(a), bStream(b);
+		rimWriter.add("a", Aurora::kFileTypeTXT, aStream);
+		rimWriter.add("b", Aurora::kFileTypeTXT, bStream);
+	}
+
+	boost::filesystem::last_write_time(kDirectory / file, time);
+}
+
+class IndexCache : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kDirectory = tmpPath / uniquePath;
+
+		boost::filesystem::create_directories(kDirectory);
+	}
+
+	static void TearDownTestCase() {
+		if (!kDirectory.empty())
+			boost::filesystem::remove_all(kDirectory);
+	}
+};
+
+GTEST_TEST_F(IndexCache, openArchive) {
+	writeRIM("cached.rim", "rim a", "rim b", 1000000000);
+
+	{
+		Aurora::IndexCache indexCache;
+
+		Common::ScopedPtr<Aurora::Archive> rim(indexCache.openArchive(getPath("cached.rim"), Aurora::kFileTypeRIM));
+		ASSERT_EQ(rim->getResources().size(), 2);
+
+		EXPECT_TRUE(indexCache.isModified());
+		indexCache.save(getPath("cached.cache"));
+		EXPECT_FALSE(indexCache.isModified());
+	}
+
+	// Break the RIM header, without changing the size or modification time
+	{
+		std::fstream rim(getPath("cached.rim").c_str(), std::ios::in | std::ios::out | std::ios::binary);
+		rim.write("XXXX", 4);
+	}
+
+	boost::filesystem::last_write_time(kDirectory / "cached.rim", 1000000000);
+
+	Aurora::IndexCache indexCache;
+	indexCache.load(getPath("cached.cache"));
+
+	// The RIM isn't parsed, so it's listed and read just fine
+	Common::ScopedPtr<Aurora::Archive> rim(indexCache.openArchive(getPath("cached.rim"), Aurora::kFileTypeRIM));
+	EXPECT_FALSE(indexCache.isModified());
+
+	const Aurora::Archive::ResourceList &resources = rim->getResources();
+	ASSERT_EQ(resources.size(), 2);
+
+	EXPECT_STREQ(resources[0].name.c_str(), "a");
+	EXPECT_EQ(resources[0].type, Aurora::kFileTypeTXT);
+	EXPECT_STREQ(resources[1].name.c_str(), "b");
+	EXPECT_EQ(resources[1].type, Aurora::kFileTypeTXT);
+
+	EXPECT_EQ(rim->getResourceSize(1), 5);
+
+	EXPECT_STREQ(readResource(*rim, 0).c_str(), "rim a");
+	EXPECT_STREQ(readResource(*rim, 1).c_str(), "rim b");
+}
+
+GTEST_TEST_F(IndexCache, openArchiveStale) {
+	writeRIM("stale.rim", "old a", "old b", 1000000000);
+
+	{
+		Aurora::IndexCache indexCache;
+
+		Common::ScopedPtr<Aurora::Archive> rim(indexCache.openArchive(getPath("stale.rim"), Aurora::kFileTypeRIM));
+		indexCache.save(getPath("stale.cache"));
+	}
+
+	// Same size, but a different modification time
+	writeRIM("stale.rim", "new a", "new b", 1000000001);
+
+	Aurora::IndexCache indexCache;
+	indexCache.load(getPath("stale.cache"));
+
+	EXPECT_EQ(indexCache.find(Common::FilePath::canonicalize(getPath("stale.rim"))),
+	          static_cast<const Aurora::IndexCache::Entry *>(0));
+
+	Common::ScopedPtr<Aurora::Archive> rim(indexCache.openArchive(getPath("stale.rim"), Aurora::kFileTypeRIM));
+	EXPECT_TRUE(indexCache.isModified());
+
+	EXPECT_STREQ(readResource(*rim, 0).c_str(), "new a");
+	EXPECT_STREQ(readResource(*rim, 1).c_str(), "new b");
+}
+
+GTEST_TEST_F(IndexCache, readResourceCompressed) {
+	static const char *kData = "Nothing beside remains. Round the decay "
+	                           "Of that colossal Wreck, boundless and bare "
+	                           "The lone and level sands stretch far away.";
+
+	static const Aurora::ERFWriter::Compression kCompressions[] = {
+		Aurora::ERFWriter::kCompressionBiowareZlib, Aurora::ERFWriter::kCompressionHeaderlessZlib
+	};
+
+	static const Aurora::Archive::Packing kPackings[] = {
+		Aurora::Archive::kPackingZlibBioWare, Aurora::Archive::kPackingZlibHeaderless
+	};
+
+	for (size_t i = 0; i < ARRAYSIZE(kCompressions); i++) {
+		Common::MemoryWriteStreamDynamic writeStream(true);
+
+		{
+			Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), 1, writeStream,
+			                            Aurora::ERFWriter::kERFVersion22, kCompressions[i]);
+
+			Common::MemoryReadStream data(kData);
+			erfWriter.add("ozymandias", Aurora::kFileTypeTXT, data);
+		}
+
+		const size_t size = writeStream.size();
+		Common::MemoryReadStream erfStream(writeStream.getData(), size, false);
+
+		Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), size));
+
+		Aurora::Archive::Location location;
+		ASSERT_TRUE(erf.getResourceLocation(0, location));
+
+		EXPECT_EQ(location.packing, kPackings[i]);
+		EXPECT_EQ(location.size, std::strlen(kData));
+
+		Common::ScopedPtr<Common::SeekableReadStream> resource(Aurora::Archive::readResource(erfStream, location));
+		EXPECT_STREQ(Common::readString(*resource, Common::kEncodingASCII).c_str(), kData);
+	}
+}
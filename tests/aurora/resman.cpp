@@ -0,0 +1,338 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our resource manager.
+ */
+
+#include <list>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/platform.h"
+#include "src/common/memreadstream.h"
+#include "src/common/writefile.h"
+#include "src/common/encoding.h"
+
+#include "src/aurora/resman.h"
+#include "src/aurora/keywriter.h"
+#include "src/aurora/bifwriter.h"
+#include "src/aurora/bzfwriter.h"
+#include "src/aurora/rimwriter.h"
+
+boost::filesystem::path kDirectory;
+
+static Common::UString getPath(const char *file) {
+	return (kDirectory / file).generic_string();
+}
+
+static void writeFile(const char *file, const char *data) {
+	Common::WriteFile writeFile(getPath(file));
+
+	writeFile.writeString(data);
+}
+
+static Common::UString readResource(const Aurora::ResourceManager &resMan,
+                                    const Common::UString &name, Aurora::FileType type) {
+
+	Common::ScopedPtr<Common::SeekableReadStream> stream(resMan.getResource(name, type));
+	if (!stream)
+		return "";
+
+	return Common::readString(*stream, Common::kEncodingASCII);
+}
+
+class ResourceManager : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kDirectory = tmpPath / uniquePath;
+
+		boost::filesystem::create_directories(kDirectory / "data");
+		boost::filesystem::create_directories(kDirectory / "override");
+
+		// A KEY indexing one BIF, with "a.txt" and "b.txt"
+		{
+			Common::WriteFile bif(getPath("data/Stuff.bif"));
+			Aurora::BIFWriter bifWriter(2, bif);
+
+			Common::MemoryReadStream a("bif a"), b("bif b");
+			bifWriter.add(a, Aurora::kFileTypeTXT);
+			bifWriter.add(b, Aurora::kFileTypeTXT);
+
+			std::list<Common::UString> files;
+			files.push_back("a.txt");
+			files.push_back("b.txt");
+
+			Aurora::KEYWriter keyWriter;
+			keyWriter.addBIF("data\\stuff.bif", files, bifWriter.size());
+
+			Common::WriteFile key(getPath("chitin.key"));
+			keyWriter.write(key);
+		}
+
+		// A RIM overriding "a.txt" and adding "c.txt"
+		{
+			Common::WriteFile rim(getPath("module.rim"));
+			Aurora::RIMWriter rimWriter(2, rim);
+
+			Common::MemoryReadStream a("rim a"), c("rim c");
+			rimWriter.add("A", Aurora::kFileTypeTXT, a);
+			rimWriter.add("c", Aurora::kFileTypeTXT, c);
+		}
+
+		// An override directory overriding "c.txt" and adding "d.2da"
+		writeFile("override/c.txt", "override c");
+		writeFile("override/d.2da", "override d");
+	}
+
+	static void TearDownTestCase() {
+		if (!kDirectory.empty())
+			boost::filesystem::remove_all(kDirectory);
+	}
+};
+
+GTEST_TEST_F(ResourceManager, addKEY) {
+	Aurora::ResourceManager resMan;
+
+	resMan.addKEY(getPath("chitin.key"), kDirectory.generic_string(), 0);
+
+	EXPECT_EQ(resMan.getResourceCount(), 2);
+
+	EXPECT_STREQ(readResource(resMan, "a", Aurora::kFileTypeTXT).c_str(), "bif a");
+	EXPECT_STREQ(readResource(resMan, "b", Aurora::kFileTypeTXT).c_str(), "bif b");
+
+	EXPECT_FALSE(resMan.hasResource("a", Aurora::kFileTypeBMP));
+	EXPECT_EQ(resMan.getResource("c", Aurora::kFileTypeTXT), static_cast<Common::SeekableReadStream *>(0));
+}
+
+GTEST_TEST_F(ResourceManager, addKEYDataFiles) {
+	boost::filesystem::create_directories(kDirectory / "multi" / "Data");
+
+	// Three BIFs in the same directory: one under a different case, one only as a BZF, one missing
+	std::list<Common::UString> files1, files2, files3, files4;
+	files1.push_back("e.txt");
+	files2.push_back("f.txt");
+	files3.push_back("g.txt");
+	files4.push_back("h.txt");
+
+	Aurora::KEYWriter keyWriter;
+
+	{
+		Common::WriteFile bif(getPath("multi/Data/one.bif"));
+		Aurora::BIFWriter bifWriter(1, bif);
+
+		Common::MemoryReadStream e("bif e");
+		bifWriter.add(e, Aurora::kFileTypeTXT);
+
+		keyWriter.addBIF("data\\one.bif", files1, bifWriter.size());
+	}
+
+	{
+		Common::WriteFile bif(getPath("multi/Data/TWO.BIF"));
+		Aurora::BIFWriter bifWriter(1, bif);
+
+		Common::MemoryReadStream f("bif f");
+		bifWriter.add(f, Aurora::kFileTypeTXT);
+
+		keyWriter.addBIF("data\\two.bif", files2, bifWriter.size());
+	}
+
+	{
+		Common::WriteFile bzf(getPath("multi/Data/three.bzf"));
+		Aurora::BZFWriter bzfWriter(1, bzf);
+
+		Common::MemoryReadStream g("bzf g");
+		bzfWriter.add(g, Aurora::kFileTypeTXT);
+
+		keyWriter.addBIF("data\\three.bif", files3, bzfWriter.size());
+	}
+
+	keyWriter.addBIF("data\\missing.bif", files4, 0);
+
+	{
+		Common::WriteFile key(getPath("multi/multi.key"));
+		keyWriter.write(key);
+	}
+
+	Aurora::ResourceManager resMan;
+
+	resMan.addKEY(getPath("multi/multi.key"), getPath("multi"), 0);
+
+	EXPECT_EQ(resMan.getResourceCount(), 3);
+
+	EXPECT_STREQ(readResource(resMan, "e", Aurora::kFileTypeTXT).c_str(), "bif e");
+	EXPECT_STREQ(readResource(resMan, "f", Aurora::kFileTypeTXT).c_str(), "bif f");
+	EXPECT_STREQ(readResource(resMan, "g", Aurora::kFileTypeTXT).c_str(), "bzf g");
+
+	EXPECT_FALSE(resMan.hasResource("h", Aurora::kFileTypeTXT));
+}
+
+GTEST_TEST_F(ResourceManager, addArchive) {
+	Aurora::ResourceManager resMan;
+
+	resMan.addArchive(getPath("module.rim"), 0);
+
+	EXPECT_EQ(resMan.getResourceCount(), 2);
+
+	EXPECT_TRUE(resMan.hasResource("a", Aurora::kFileTypeTXT));
+	EXPECT_TRUE(resMan.hasResource("C", Aurora::kFileTypeTXT));
+
+	EXPECT_STREQ(readResource(resMan, "a", Aurora::kFileTypeTXT).c_str(), "rim a");
+	EXPECT_STREQ(readResource(resMan, "c", Aurora::kFileTypeTXT).c_str(), "rim c");
+}
+
+GTEST_TEST_F(ResourceManager, addDirectory) {
+	Aurora::ResourceManager resMan;
+
+	resMan.addDirectory(getPath("override"), 0);
+
+	EXPECT_EQ(resMan.getResourceCount(), 2);
+
+	EXPECT_STREQ(readResource(resMan, "c", Aurora::kFileTypeTXT).c_str(), "override c");
+	EXPECT_STREQ(readResource(resMan, "d", Aurora::kFileType2DA).c_str(), "override d");
+}
+
+GTEST_TEST_F(ResourceManager, priority) {
+	Aurora::ResourceManager resMan;
+
+	resMan.addDirectory(getPath("override"), 2);
+	resMan.addArchive(getPath("module.rim"), 1);
+	resMan.addKEY(getPath("chitin.key"), kDirectory.generic_string(), 0);
+
+	EXPECT_EQ(resMan.getResourceCount(), 4);
+
+	EXPECT_STREQ(readResource(resMan, "a", Aurora::kFileTypeTXT).c_str(), "rim a");
+	EXPECT_STREQ(readResource(resMan, "b", Aurora::kFileTypeTXT).c_str(), "bif b");
+	EXPECT_STREQ(readResource(resMan, "c", Aurora::kFileTypeTXT).c_str(), "override c");
+	EXPECT_STREQ(readResource(resMan, "d", Aurora::kFileType2DA).c_str(), "override d");
+}
+
+GTEST_TEST_F(ResourceManager, priorityEqual) {
+	Aurora::ResourceManager resMan;
+
+	resMan.addArchive(getPath("module.rim"), 0);
+	resMan.addKEY(getPath("chitin.key"), kDirectory.generic_string(), 0);
+
+	EXPECT_STREQ(readResource(resMan, "a", Aurora::kFileTypeTXT).c_str(), "bif a");
+}
+
+GTEST_TEST_F(ResourceManager, getResources) {
+	Aurora::ResourceManager resMan;
+
+	resMan.addDirectory(getPath("override"), 0);
+
+	std::vector<const Aurora::ResourceManager::Resource *> resources;
+	resMan.getResources(Aurora::kFileType2DA, resources);
+
+	ASSERT_EQ(resources.size(), 1);
+
+	EXPECT_STREQ(resources[0]->name.c_str(), "d");
+	EXPECT_EQ(resources[0]->type, Aurora::kFileType2DA);
+}
+
+GTEST_TEST_F(ResourceManager, clear) {
+	Aurora::ResourceManager resMan;
+
+	resMan.addArchive(getPath("module.rim"), 0);
+	resMan.clear();
+
+	EXPECT_EQ(resMan.getResourceCount(), 0);
+	EXPECT_FALSE(resMan.hasResource("a", Aurora::kFileTypeTXT));
+}
+
+GTEST_TEST_F(ResourceManager, indexCache) {
+	{
+		Aurora::ResourceManager resMan;
+
+		resMan.addArchive(getPath("module.rim"), 1);
+		resMan.addKEY(getPath("chitin.key"), kDirectory.generic_string(), 0);
+
+		resMan.saveIndexCache(getPath("index.cache"));
+	}
+
+	Aurora::ResourceManager resMan;
+	resMan.loadIndexCache(getPath("index.cache"));
+
+	resMan.addArchive(getPath("module.rim"), 1);
+	resMan.addKEY(getPath("chitin.key"), kDirectory.generic_string(), 0);
+
+	EXPECT_EQ(resMan.getResourceCount(), 3);
+
+	EXPECT_STREQ(readResource(resMan, "a", Aurora::kFileTypeTXT).c_str(), "rim a");
+	EXPECT_STREQ(readResource(resMan, "b", Aurora::kFileTypeTXT).c_str(), "bif b");
+	EXPECT_STREQ(readResource(resMan, "c", Aurora::kFileTypeTXT).c_str(), "rim c");
+}
+
+GTEST_TEST_F(ResourceManager, indexCacheStale) {
+	{
+		Common::WriteFile rim(getPath("stale.rim"));
+		Aurora::RIMWriter rimWriter(1, rim);
+
+		Common::MemoryReadStream a("old a");
+		rimWriter.add("a", Aurora::kFileTypeTXT, a);
+	}
+
+	{
+		Aurora::ResourceManager resMan;
+
+		resMan.addArchive(getPath("stale.rim"), 0);
+		resMan.saveIndexCache(getPath("stale.cache"));
+	}
+
+	{
+		Common::WriteFile rim(getPath("stale.rim"));
+		Aurora::RIMWriter rimWriter(2, rim);
+
+		Common::MemoryReadStream a("new a"), b("new b");
+		rimWriter.add("a", Aurora::kFileTypeTXT, a);
+		rimWriter.add("b", Aurora::kFileTypeTXT, b);
+	}
+
+	Aurora::ResourceManager resMan;
+	resMan.loadIndexCache(getPath("stale.cache"));
+
+	resMan.addArchive(getPath("stale.rim"), 0);
+
+	EXPECT_EQ(resMan.getResourceCount(), 2);
+
+	EXPECT_STREQ(readResource(resMan, "a", Aurora::kFileTypeTXT).c_str(), "new a");
+	EXPECT_STREQ(readResource(resMan, "b", Aurora::kFileTypeTXT).c_str(), "new b");
+}
+
+GTEST_TEST_F(ResourceManager, indexCacheBroken) {
+	writeFile("broken.cache", "Not a cache");
+
+	Aurora::ResourceManager resMan;
+	resMan.loadIndexCache(getPath("broken.cache"));
+
+	resMan.addArchive(getPath("module.rim"), 0);
+
+	EXPECT_STREQ(readResource(resMan, "a", Aurora::kFileTypeTXT).c_str(), "rim a");
+}
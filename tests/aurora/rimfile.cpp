@@ -156,3 +156,22 @@ GTEST_TEST(RIMFile, getResource) {
 
 	delete file;
 }
+
+GTEST_TEST(RIMFile, getResourceNoCopy) {
+	Common::MemoryReadStream *stream = new Common::MemoryReadStream(kRIMFile);
+	const Aurora::RIMFile rim(stream);
+
+	Common::SeekableReadStream *file = rim.getResource(0, true);
+	ASSERT_NE(file, static_cast<Common::SeekableReadStream *>(0));
+
+	ASSERT_EQ(file->size(), strlen(kFileData));
+
+	// The resource directly aliases the memory of the archive
+	ASSERT_NE(file->getData(), static_cast<const byte *>(0));
+	EXPECT_EQ(file->getData(), kRIMFile + ARRAYSIZE(kRIMFile) - strlen(kFileData));
+
+	for (size_t i = 0; i < strlen(kFileData); i++)
+		EXPECT_EQ(file->readByte(), kFileData[i]) << "At index " << i;
+
+	delete file;
+}
@@ -101,6 +101,11 @@ tests_aurora_test_gff4file_SOURCES  = tests/aurora/gff4file.cpp
 tests_aurora_test_gff4file_LDADD    = $(aurora_LIBS)
 tests_aurora_test_gff4file_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                     += tests/aurora/test_gffquery
+tests_aurora_test_gffquery_SOURCES  = tests/aurora/gffquery.cpp
+tests_aurora_test_gffquery_LDADD    = $(aurora_LIBS)
+tests_aurora_test_gffquery_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                    += tests/aurora/test_2dafile
 tests_aurora_test_2dafile_SOURCES  = tests/aurora/2dafile.cpp
 tests_aurora_test_2dafile_LDADD    = $(aurora_LIBS)
@@ -150,3 +155,13 @@ check_PROGRAMS                      += tests/aurora/test_rimwriter
 tests_aurora_test_rimwriter_SOURCES  = tests/aurora/rimwriter.cpp
 tests_aurora_test_rimwriter_LDADD    = $(aurora_LIBS)
 tests_aurora_test_rimwriter_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                   += tests/aurora/test_resman
+tests_aurora_test_resman_SOURCES  = tests/aurora/resman.cpp
+tests_aurora_test_resman_LDADD    = $(aurora_LIBS)
+tests_aurora_test_resman_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                       += tests/aurora/test_indexcache
+tests_aurora_test_indexcache_SOURCES  = tests/aurora/indexcache.cpp
+tests_aurora_test_indexcache_LDADD    = $(aurora_LIBS)
+tests_aurora_test_indexcache_CXXFLAGS = $(test_CXXFLAGS)
@@ -22,8 +22,15 @@
  *  Unit tests for our Nintendo DS compression.
  */
 
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+
 #include "gtest/gtest.h"
 
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/error.h"
 #include "src/common/memreadstream.h"
 #include "src/common/memwritestream.h"
 
@@ -234,16 +241,187 @@ GTEST_TEST(Small0x10, decompressIntoReadStreamTakeOverSeek) {
 	delete uncompressed;
 }
 
+GTEST_TEST(Small0x10, decompressStreamPosition) {
+	// Trailing data after the compressed data must not be touched
+	byte data[sizeof(kDataCompressed10) + 4];
+	std::memcpy(data, kDataCompressed10, sizeof(kDataCompressed10));
+	std::memset(data + sizeof(kDataCompressed10), 0xAA, 4);
+
+	Common::MemoryReadStream compressed(data, sizeof(data));
+
+	Common::SeekableReadStream *uncompressed = Aurora::Small::decompress(compressed);
+	ASSERT_EQ(uncompressed->size(), strlen(kDataUncompressed));
+
+	EXPECT_EQ(compressed.pos(), sizeof(kDataCompressed10));
+
+	compareData(*uncompressed, kDataUncompressed);
+	delete uncompressed;
+}
+
+GTEST_TEST(Small0x10, decompressOverlapping) {
+	// A literal 'a', then a copy of 18 bytes from 1 byte back, then a literal 'b'
+	static const byte kDataOverlapping[] = { 0x10, 0x14, 0x00, 0x00, 0x40, 0x61, 0xF0, 0x00, 0x62 };
+
+	Common::MemoryReadStream compressed(kDataOverlapping);
+
+	Common::SeekableReadStream *uncompressed = Aurora::Small::decompress(compressed);
+	ASSERT_EQ(uncompressed->size(), 20);
+
+	for (size_t i = 0; i < 19; i++)
+		EXPECT_EQ(uncompressed->readByte(), 'a') << "At index " << i;
+	EXPECT_EQ(uncompressed->readByte(), 'b');
+
+	delete uncompressed;
+}
+
+GTEST_TEST(Small0x10, decompressFailCopyPastStart) {
+	// A copy from 2 bytes back, with only 1 byte decompressed so far
+	static const byte kDataInvalid[] = { 0x10, 0x04, 0x00, 0x00, 0x40, 0x61, 0x00, 0x01 };
+
+	Common::MemoryReadStream compressed(kDataInvalid);
+	Common::MemoryWriteStreamDynamic uncompressed(true);
+
+	EXPECT_THROW(Aurora::Small::decompress(compressed, uncompressed), Common::Exception);
+}
+
+GTEST_TEST(Small0x10, decompressFailInputCut) {
+	Common::MemoryReadStream compressed(kDataCompressed10, sizeof(kDataCompressed10) / 2);
+	Common::MemoryWriteStreamDynamic uncompressed(true);
+
+	EXPECT_THROW(Aurora::Small::decompress(compressed, uncompressed), Common::Exception);
+}
+
 // --- Compress 0x10 ---
 
+/** Size of the LZSS 0x10 data written by a compressor that, for every position,
+ *  greedily takes the longest occurrence found by scanning the whole window. */
+static size_t getGreedyScanSize(const byte *data, size_t size) {
+	size_t compressedSize = 0;
+
+	for (size_t pos = 0, blocks = 0; pos < size; blocks++) {
+		if ((blocks % 8) == 0)
+			compressedSize++;
+
+		const size_t maxLength = MIN<size_t>(size - pos, 0x12);
+
+		size_t bestLength = 0;
+		for (size_t displacement = 2; displacement <= MIN<size_t>(pos, 0x1000); displacement++) {
+			size_t length = 0;
+			while ((length < maxLength) && (data[pos - displacement + length] == data[pos + length]))
+				length++;
+
+			bestLength = MAX(bestLength, length);
+		}
+
+		if (bestLength >= 3) {
+			pos += bestLength;
+			compressedSize += 2;
+		} else {
+			pos += 1;
+			compressedSize += 1;
+		}
+	}
+
+	return 4 + compressedSize;
+}
+
+/** Generate some text-like data with lots of repetitions near and far. */
+static void generateText(byte *data, size_t size) {
+	static const char *kWords[] = {
+		"Ozymandias ", "king ", "of ", "kings ", "look ", "on ", "my ", "works ", "ye ", "Mighty ",
+		"and ", "despair! ", "Nothing ", "beside ", "remains. ", "\n"
+	};
+
+	uint32 seed = 0xDEADBEEF;
+	for (size_t pos = 0; pos < size; ) {
+		seed = seed * 1103515245 + 12345;
+
+		const char *word = kWords[(seed >> 16) % ARRAYSIZE(kWords)];
+		for (; *word && (pos < size); word++)
+			data[pos++] = ((seed >> 8) & 0x1F) ? *word : (*word ^ 0x20);
+	}
+}
+
 GTEST_TEST(Small0x10, compress) {
 	Common::MemoryWriteStreamDynamic compressed(true);
 	Common::MemoryReadStream uncompressed(kDataUncompressed);
 
 	Aurora::Small::compress10(uncompressed, compressed);
-	ASSERT_EQ(compressed.size(), sizeof(kDataCompressed10));
 
-	compareData(compressed.getData(), kDataCompressed10, sizeof(kDataCompressed10));
+	// At least as good as the old, exhaustive, compressor that created this data
+	ASSERT_GT(compressed.size(), 4);
+	EXPECT_LE(compressed.size(), sizeof(kDataCompressed10));
+
+	compareData(compressed.getData(), kDataCompressed10, 4);
+}
+
+GTEST_TEST(Small0x10, compressEfforts) {
+	static const size_t kSize = 64 * 1024;
+
+	Common::ScopedArray<byte> data(new byte[kSize]);
+	generateText(data.get(), kSize);
+
+	const size_t greedySize = getGreedyScanSize(data.get(), kSize);
+
+	size_t lastSize = SIZE_MAX;
+	for (int effort = Aurora::Small::kEffortMin; effort <= Aurora::Small::kEffortMax; effort++) {
+		Common::MemoryWriteStreamDynamic compressedWrite(true);
+		Common::MemoryReadStream uncompressedRead(data.get(), kSize);
+
+		Aurora::Small::compress10(uncompressedRead, compressedWrite, effort);
+
+		// More effort never hurts much
+		EXPECT_LE(compressedWrite.size(), lastSize + lastSize / 100) << "With effort " << effort;
+		lastSize = compressedWrite.size();
+
+		Common::MemoryReadStream compressedRead(compressedWrite.getData(), compressedWrite.size());
+		Common::ScopedPtr<Common::SeekableReadStream> uncompressed(Aurora::Small::decompress(compressedRead));
+
+		ASSERT_EQ(uncompressed->size(), kSize) << "With effort " << effort;
+		for (size_t i = 0; i < kSize; i++)
+			ASSERT_EQ(uncompressed->readByte(), data[i]) << "With effort " << effort << ", at index " << i;
+	}
+
+	/* The highest effort is at least as good as scanning the whole window for every byte.
+	 * Give or take one byte, since the flag bytes for the last blocks are rounded up. */
+	EXPECT_LE(lastSize, greedySize + 1);
+}
+
+/** Compare the speed and size of all efforts against scanning the whole window for every byte.
+ *
+ *  Disabled by default. Run with --gtest_also_run_disabled_tests to see the timings.
+ */
+GTEST_TEST(Small0x10, DISABLED_benchmark) {
+	static const size_t kSize = 1024 * 1024;
+
+	Common::ScopedArray<byte> data(new byte[kSize]);
+	generateText(data.get(), kSize);
+
+	typedef std::chrono::steady_clock Clock;
+
+	Clock::time_point start = Clock::now();
+	const size_t scanSize = getGreedyScanSize(data.get(), kSize);
+	std::chrono::duration<double, std::milli> scanTime = Clock::now() - start;
+
+	std::printf("Window scan: %10u bytes, %10.1f ms\n", (uint)scanSize, scanTime.count());
+
+	for (int effort = Aurora::Small::kEffortMin; effort <= Aurora::Small::kEffortMax; effort++) {
+		Common::MemoryWriteStreamDynamic compressed(true);
+		Common::MemoryReadStream uncompressed(data.get(), kSize);
+
+		start = Clock::now();
+		Aurora::Small::compress10(uncompressed, compressed, effort);
+		std::chrono::duration<double, std::milli> time = Clock::now() - start;
+
+		std::printf("Effort %d:    %10u bytes, %10.1f ms\n", effort, (uint)compressed.size(), time.count());
+	}
+}
+
+GTEST_TEST(Small0x10, compressInvalidEffort) {
+	Common::MemoryWriteStreamDynamic compressed(true);
+	Common::MemoryReadStream uncompressed(kDataUncompressed);
+
+	EXPECT_THROW(Aurora::Small::compress10(uncompressed, compressed, Aurora::Small::kEffortMax + 1), Common::Exception);
 }
 
 GTEST_TEST(Small0x10, compressRoundTrip) {
@@ -22,6 +22,7 @@
  *  Unit tests for our Blowfish implementation.
  */
 
+#include <cstring>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -81,3 +82,26 @@ GTEST_TEST(Blowfish, misalign) {
 
 	EXPECT_THROW(Common::decryptBlowfishEBC(cipherText, key), Common::Exception);
 }
+
+GTEST_TEST(Blowfish, decryptInPlace) {
+	byte data[ARRAYSIZE(kCypherText)];
+	std::memcpy(data, kCypherText, ARRAYSIZE(kCypherText));
+
+	std::vector<byte> key;
+	createKey(key);
+
+	Common::decryptBlowfishEBC(data, ARRAYSIZE(data), key);
+
+	for (size_t i = 0; i < ARRAYSIZE(kClearText); i++)
+		EXPECT_EQ(data[i], kClearText[i]) << "At index " << i;
+}
+
+GTEST_TEST(Blowfish, decryptInPlaceMisalign) {
+	byte data[ARRAYSIZE(kCypherText)];
+	std::memcpy(data, kCypherText, ARRAYSIZE(kCypherText));
+
+	std::vector<byte> key;
+	createKey(key);
+
+	EXPECT_THROW(Common::decryptBlowfishEBC(data, 7, key), Common::Exception);
+}
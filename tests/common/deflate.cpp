@@ -22,8 +22,12 @@
  *  Unit tests for our DEFLATE decompressor (which uses zlib).
  */
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
 #include "src/common/deflate.h"
 #include "src/common/memreadstream.h"
 #include "src/common/error.h"
@@ -266,3 +270,84 @@ GTEST_TEST(DEFLATE, decompressChunked) {
 
 	delete[] output;
 }
+
+GTEST_TEST(DEFLATE, inflateStreamRead) {
+	static const size_t kSizeCompressed   = sizeof(kDataCompressed);
+	static const size_t kSizeDecompressed = strlen(kDataUncompressed);
+
+	Common::InflateReadStream stream(new Common::MemoryReadStream(kDataCompressed, kSizeCompressed), true,
+	                                 kSizeDecompressed, Common::kWindowBitsMaxRaw);
+
+	ASSERT_EQ(stream.size(), kSizeDecompressed);
+
+	byte output[7];
+	for (size_t i = 0; i < kSizeDecompressed; ) {
+		const size_t n = stream.read(output, sizeof(output));
+
+		ASSERT_EQ(n, MIN(sizeof(output), kSizeDecompressed - i));
+		for (size_t j = 0; j < n; j++, i++)
+			EXPECT_EQ(output[j], (byte) kDataUncompressed[i]) << "At index " << i;
+	}
+
+	EXPECT_FALSE(stream.eos());
+	EXPECT_EQ(stream.read(output, 1), 0);
+	EXPECT_TRUE(stream.eos());
+}
+
+GTEST_TEST(DEFLATE, inflateStreamSeek) {
+	static const size_t kSizeCompressed   = sizeof(kDataCompressed);
+	static const size_t kSizeDecompressed = strlen(kDataUncompressed);
+
+	// Checkpoint every 64 bytes, to restart from after seeking backwards
+	Common::InflateReadStream stream(new Common::MemoryReadStream(kDataCompressed, kSizeCompressed), true,
+	                                 kSizeDecompressed, Common::kWindowBitsMaxRaw, false, 64);
+
+	static const size_t kPositions[] = { 500, 10, 300, 299, 64, 63, 128, 0, kSizeDecompressed - 1 };
+
+	for (size_t i = 0; i < ARRAYSIZE(kPositions); i++) {
+		stream.seek(kPositions[i]);
+		EXPECT_EQ(stream.pos(), kPositions[i]);
+
+		EXPECT_EQ(stream.readByte(), (byte) kDataUncompressed[kPositions[i]]) << "At index " << kPositions[i];
+	}
+
+	EXPECT_THROW(stream.seek(kSizeDecompressed + 1), Common::Exception);
+}
+
+GTEST_TEST(DEFLATE, inflateStreamConcatenated) {
+	static const size_t kSizeDecompressed = strlen(kDataUncompressed);
+	static const size_t kSizeHalf = kSizeDecompressed / 2;
+
+	const byte *data = reinterpret_cast<const byte *>(kDataUncompressed);
+
+	size_t size1 = 0, size2 = 0;
+	Common::ScopedArray<byte> compressed1(Common::compressDeflate(data, kSizeHalf, size1, Common::kWindowBitsMax));
+	Common::ScopedArray<byte> compressed2(Common::compressDeflate(data + kSizeHalf, kSizeDecompressed - kSizeHalf,
+	                                                              size2, Common::kWindowBitsMax));
+
+	byte *concatenated = new byte[size1 + size2];
+	std::memcpy(concatenated, compressed1.get(), size1);
+	std::memcpy(concatenated + size1, compressed2.get(), size2);
+
+	Common::InflateReadStream stream(new Common::MemoryReadStream(concatenated, size1 + size2, true), true,
+	                                 kSizeDecompressed, Common::kWindowBitsMax, true);
+
+	for (size_t i = 0; i < kSizeDecompressed; i++)
+		EXPECT_EQ(stream.readByte(), (byte) kDataUncompressed[i]) << "At index " << i;
+
+	// Without concatenation, the end of the first stream is the end of everything
+	Common::InflateReadStream single(new Common::MemoryReadStream(concatenated, size1 + size2), true,
+	                                 kSizeDecompressed, Common::kWindowBitsMax);
+
+	EXPECT_THROW(single.seek(kSizeDecompressed), Common::Exception);
+}
+
+GTEST_TEST(DEFLATE, inflateStreamFailInputCut) {
+	static const size_t kSizeCompressed   = sizeof(kDataCompressed) / 2;
+	static const size_t kSizeDecompressed = strlen(kDataUncompressed);
+
+	Common::InflateReadStream stream(new Common::MemoryReadStream(kDataCompressed, kSizeCompressed), true,
+	                                 kSizeDecompressed, Common::kWindowBitsMaxRaw);
+
+	EXPECT_THROW(stream.seek(0, Common::SeekableReadStream::kOriginEnd), Common::Exception);
+}
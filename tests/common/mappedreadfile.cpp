@@ -0,0 +1,160 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our memory-mapped file read stream.
+ */
+
+#include <string>
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/platform.h"
+#include "src/common/mappedreadfile.h"
+
+boost::filesystem::path kFilePath;
+
+static const byte kData[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+
+class MappedReadFile : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kFilePath = tmpPath / uniquePath;
+
+		boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+
+		testFile.write(reinterpret_cast<const char *>(kData), ARRAYSIZE(kData));
+		testFile.flush();
+		testFile.close();
+	}
+
+	static void TearDownTestCase() {
+		if (!kFilePath.empty())
+			boost::filesystem::remove(kFilePath);
+	}
+};
+
+GTEST_TEST_F(MappedReadFile, read) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	Common::MappedReadFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	EXPECT_EQ(file.size(), ARRAYSIZE(kData));
+
+	byte readData[ARRAYSIZE(kData)];
+	const size_t readCount = file.read(readData, sizeof(readData));
+	EXPECT_EQ(readCount, ARRAYSIZE(readData));
+
+	EXPECT_FALSE(file.eos());
+	EXPECT_EQ(file.read(readData, 1), 0);
+	EXPECT_TRUE(file.eos());
+
+	for (size_t i = 0; i < ARRAYSIZE(kData); i++)
+		EXPECT_EQ(readData[i], kData[i]) << "At index " << i;
+
+	file.close();
+	ASSERT_FALSE(file.isOpen());
+}
+
+GTEST_TEST_F(MappedReadFile, seek) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	Common::MappedReadFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	EXPECT_EQ(file.seek(3), 0);
+	EXPECT_EQ(file.pos(), 3);
+	EXPECT_EQ(file.readByte(), kData[3]);
+
+	EXPECT_EQ(file.seek(-2, Common::SeekableReadStream::kOriginEnd), 4);
+	EXPECT_EQ(file.readByte(), kData[3]);
+
+	EXPECT_EQ(file.seek(-3, Common::SeekableReadStream::kOriginCurrent), 4);
+	EXPECT_EQ(file.readByte(), kData[1]);
+
+	EXPECT_THROW(file.seek(6), Common::Exception);
+}
+
+GTEST_TEST_F(MappedReadFile, readAt) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	Common::MappedReadFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	EXPECT_EQ(file.readByte(), kData[0]);
+
+	byte readData[3];
+	EXPECT_EQ(file.readAt(2, readData, 3), 3);
+	EXPECT_EQ(readData[0], kData[2]);
+	EXPECT_EQ(readData[1], kData[3]);
+	EXPECT_EQ(readData[2], kData[4]);
+
+	EXPECT_EQ(file.readAt(4, readData, 3), 1);
+	EXPECT_EQ(file.readAt(6, readData, 3), 0);
+
+	EXPECT_EQ(file.pos(), 1);
+}
+
+GTEST_TEST_F(MappedReadFile, getData) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	Common::MappedReadFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	const byte *data = file.getData();
+	ASSERT_NE(data, static_cast<const byte *>(0));
+
+	for (size_t i = 0; i < ARRAYSIZE(kData); i++)
+		EXPECT_EQ(data[i], kData[i]) << "At index " << i;
+}
+
+GTEST_TEST_F(MappedReadFile, openFail) {
+	Common::MappedReadFile file;
+
+	EXPECT_FALSE(file.open((kFilePath / "nonexistent").generic_string()));
+	EXPECT_FALSE(file.isOpen());
+}
+
+GTEST_TEST_F(MappedReadFile, mapOrReadFile) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	Common::ScopedPtr<Common::SeekableReadStream> file(Common::mapOrReadFile(kFilePath.generic_string()));
+	ASSERT_TRUE(file);
+
+	EXPECT_EQ(file->size(), ARRAYSIZE(kData));
+
+	for (size_t i = 0; i < ARRAYSIZE(kData); i++)
+		EXPECT_EQ(file->readByte(), kData[i]) << "At index " << i;
+
+	EXPECT_THROW(Common::mapOrReadFile((kFilePath / "nonexistent").generic_string()), Common::Exception);
+}
@@ -26,6 +26,7 @@
 
 #include "src/common/util.h"
 #include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/readstream.h"
 #include "src/common/memreadstream.h"
 
@@ -105,6 +106,44 @@ GTEST_TEST(MemoryReadStream, readStream) {
 	EXPECT_THROW(stream.readStream(ARRAYSIZE(data) + 1), Common::Exception);
 }
 
+GTEST_TEST(MemoryReadStream, readAt) {
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x9A };
+	Common::MemoryReadStream stream(data);
+
+	stream.seek(1);
+
+	byte readData[3];
+	EXPECT_EQ(stream.readAt(2, readData, 3), 3);
+	EXPECT_EQ(readData[0], 0x56);
+	EXPECT_EQ(readData[1], 0x78);
+	EXPECT_EQ(readData[2], 0x9A);
+
+	EXPECT_EQ(stream.readAt(4, readData, 3), 1);
+	EXPECT_EQ(readData[0], 0x9A);
+
+	EXPECT_EQ(stream.readAt(6, readData, 3), 0);
+
+	// The stream position is left untouched
+	EXPECT_EQ(stream.pos(), 1);
+	EXPECT_FALSE(stream.eos());
+}
+
+GTEST_TEST(MemoryReadStream, readStreamAt) {
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x9A };
+	Common::MemoryReadStream stream(data);
+
+	Common::ScopedPtr<Common::MemoryReadStream> subStream(stream.readStreamAt(1, 2));
+	ASSERT_NE(subStream.get(), static_cast<Common::MemoryReadStream *>(0));
+
+	EXPECT_EQ(subStream->size(), 2);
+	EXPECT_EQ(subStream->readByte(), 0x34);
+	EXPECT_EQ(subStream->readByte(), 0x56);
+
+	EXPECT_EQ(stream.pos(), 0);
+
+	EXPECT_THROW(stream.readStreamAt(4, 2), Common::Exception);
+}
+
 GTEST_TEST(MemoryReadStream, readChar) {
 	static const byte data[3] = { 0x12, 0x34, 0x56 };
 	Common::MemoryReadStream stream(data);
@@ -315,6 +354,52 @@ GTEST_TEST(SeekableSubReadStream, fromMem) {
 	EXPECT_FALSE(subStream.eos());
 }
 
+GTEST_TEST(SeekableSubReadStream, readAt) {
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x9A };
+	Common::MemoryReadStream stream(data);
+
+	Common::SeekableSubReadStream subStream(&stream, 1, 4);
+
+	byte readData[3];
+	EXPECT_EQ(subStream.readAt(1, readData, 3), 2);
+	EXPECT_EQ(readData[0], 0x56);
+	EXPECT_EQ(readData[1], 0x78);
+
+	EXPECT_EQ(subStream.pos(), 0);
+	EXPECT_EQ(stream.pos(), 1);
+}
+
+GTEST_TEST(SeekableSubReadStream, getData) {
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x9A };
+	Common::MemoryReadStream stream(data);
+
+	Common::SeekableSubReadStream subStream(&stream, 1, 4);
+	EXPECT_EQ(subStream.getData(), data + 1);
+}
+
+GTEST_TEST(SeekableReadStream, getSubStream) {
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x9A };
+	Common::MemoryReadStream stream(data);
+
+	Common::ScopedPtr<Common::SeekableReadStream> subStream(stream.getSubStream(1, 4));
+	ASSERT_NE(subStream.get(), static_cast<Common::SeekableReadStream *>(0));
+
+	// The substream aliases the memory and doesn't touch the parent stream's position
+	EXPECT_EQ(subStream->getData(), data + 1);
+	EXPECT_EQ(subStream->size(), 3);
+	EXPECT_EQ(stream.pos(), 0);
+
+	EXPECT_EQ(subStream->readByte(), 0x34);
+	EXPECT_EQ(subStream->readByte(), 0x56);
+	EXPECT_EQ(subStream->readByte(), 0x78);
+	EXPECT_THROW(subStream->readByte(), Common::Exception);
+
+	EXPECT_EQ(stream.pos(), 0);
+
+	EXPECT_THROW(stream.getSubStream(4, 6), Common::Exception);
+	EXPECT_THROW(stream.getSubStream(3, 2), Common::Exception);
+}
+
 GTEST_TEST(SeekableSubReadStreamEndian, streamEndianLE) {
 	static const byte data[4] = { 0x78, 0x56, 0x34, 0x12 };
 	Common::MemoryReadStream stream(data);
@@ -0,0 +1,113 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our parallel job helpers.
+ */
+
+#include <vector>
+#include <functional>
+
+#include "gtest/gtest.h"
+
+#include "src/common/error.h"
+#include "src/common/parallel.h"
+
+GTEST_TEST(Parallel, getThreadCount) {
+	EXPECT_GE(Common::getHardwareThreadCount(), 1);
+
+	EXPECT_EQ(Common::getThreadCount(3), 3);
+	EXPECT_EQ(Common::getThreadCount(0), Common::getHardwareThreadCount());
+}
+
+GTEST_TEST(Parallel, parallelFor) {
+	static const size_t kCount = 1000;
+
+	for (size_t threads = 1; threads <= 4; threads++) {
+		std::vector<size_t> values(kCount, 0);
+
+		Common::parallelFor(threads, kCount, [&](size_t i) { values[i] = i * 2; });
+
+		for (size_t i = 0; i < kCount; i++)
+			EXPECT_EQ(values[i], i * 2) << "At index " << i << " with " << threads << " threads";
+	}
+}
+
+GTEST_TEST(Parallel, parallelForException) {
+	for (size_t threads = 1; threads <= 4; threads++) {
+		EXPECT_THROW(Common::parallelFor(threads, 100, [](size_t i) {
+			if (i == 50)
+				throw Common::Exception("Failed on %u", (uint) i);
+		}), Common::Exception);
+	}
+}
+
+GTEST_TEST(Parallel, parallelOrdered) {
+	static const size_t kCount = 1000;
+
+	for (size_t threads = 1; threads <= 4; threads++) {
+		std::vector<size_t> order;
+		order.reserve(kCount);
+
+		std::function<size_t *(size_t)> produce = [](size_t i) {
+			if ((i % 10) == 3)
+				throw Common::Exception("Failed on %u", (uint) i);
+
+			return new size_t(i * 3);
+		};
+
+		std::function<void(size_t, Common::ParallelResult<size_t> &)> consume =
+			[&](size_t i, Common::ParallelResult<size_t> &result) {
+
+			order.push_back(i);
+
+			if ((i % 10) == 3) {
+				EXPECT_THROW(result.release(), Common::Exception) << "At index " << i;
+				return;
+			}
+
+			Common::ScopedPtr<size_t> value(result.release());
+			ASSERT_NE(value.get(), static_cast<size_t *>(0));
+
+			EXPECT_EQ(*value, i * 3) << "At index " << i << " with " << threads << " threads";
+		};
+
+		Common::parallelOrdered(threads, kCount, produce, consume);
+
+		ASSERT_EQ(order.size(), kCount);
+		for (size_t i = 0; i < kCount; i++)
+			EXPECT_EQ(order[i], i) << "With " << threads << " threads";
+	}
+}
+
+GTEST_TEST(Parallel, parallelOrderedConsumeException) {
+	std::function<size_t *(size_t)> produce = [](size_t i) {
+		return new size_t(i);
+	};
+
+	std::function<void(size_t, Common::ParallelResult<size_t> &)> consume =
+		[](size_t i, Common::ParallelResult<size_t> &UNUSED(result)) {
+
+		if (i == 20)
+			throw Common::Exception("Failed on %u", (uint) i);
+	};
+
+	EXPECT_THROW(Common::parallelOrdered(4, 100, produce, consume), Common::Exception);
+}
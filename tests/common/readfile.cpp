@@ -87,3 +87,85 @@ GTEST_TEST_F(ReadFile, write) {
 	for (size_t i = 0; i < ARRAYSIZE(data); i++)
 		EXPECT_EQ(readData[i], data[i]) << "At index " << i;
 }
+
+GTEST_TEST_F(ReadFile, readAt) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+
+	boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+
+	testFile.write(reinterpret_cast<const char *>(data), ARRAYSIZE(data));
+	testFile.flush();
+	ASSERT_FALSE(testFile.fail());
+
+	testFile.close();
+
+	Common::ReadFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	EXPECT_EQ(file.readByte(), data[0]);
+
+	byte readData[3];
+	EXPECT_EQ(file.readAt(2, readData, 3), 3);
+	EXPECT_EQ(readData[0], data[2]);
+	EXPECT_EQ(readData[1], data[3]);
+	EXPECT_EQ(readData[2], data[4]);
+
+	EXPECT_EQ(file.readAt(4, readData, 3), 1);
+	EXPECT_EQ(readData[0], data[4]);
+
+	EXPECT_EQ(file.readAt(6, readData, 3), 0);
+
+	// The file position is left untouched
+	EXPECT_EQ(file.pos(), 1);
+	EXPECT_EQ(file.readByte(), data[1]);
+}
+
+GTEST_TEST_F(ReadFile, positionalSubStream) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+
+	boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+
+	testFile.write(reinterpret_cast<const char *>(data), ARRAYSIZE(data));
+	testFile.flush();
+	ASSERT_FALSE(testFile.fail());
+
+	testFile.close();
+
+	Common::ReadFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	EXPECT_EQ(file.readByte(), data[0]);
+
+	Common::PositionalSubReadStream subStream1(&file, 1, 4);
+	Common::PositionalSubReadStream subStream2(&file, 3, 5);
+
+	EXPECT_EQ(subStream1.size(), 3);
+	EXPECT_EQ(subStream2.size(), 2);
+
+	// The substreams don't step on each other's toes
+	EXPECT_EQ(subStream1.readByte(), data[1]);
+	EXPECT_EQ(subStream2.readByte(), data[3]);
+	EXPECT_EQ(subStream1.readByte(), data[2]);
+	EXPECT_EQ(subStream2.readByte(), data[4]);
+	EXPECT_EQ(subStream1.readByte(), data[3]);
+
+	byte readData[2];
+	EXPECT_EQ(subStream1.read(readData, 2), 0);
+	EXPECT_TRUE(subStream1.eos());
+
+	EXPECT_EQ(subStream1.seek(1), 3);
+	EXPECT_FALSE(subStream1.eos());
+	EXPECT_EQ(subStream1.readByte(), data[2]);
+
+	EXPECT_THROW(subStream2.seek(3), Common::Exception);
+
+	// And the file position is left untouched
+	EXPECT_EQ(file.pos(), 1);
+	EXPECT_EQ(file.readByte(), data[1]);
+
+	EXPECT_EQ(subStream1.canReadAtConcurrently(), file.canReadAtConcurrently());
+}
@@ -85,6 +85,11 @@ tests_common_test_readfile_SOURCES  = tests/common/readfile.cpp
 tests_common_test_readfile_LDADD    = $(common_LIBS)
 tests_common_test_readfile_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                           += tests/common/test_mappedreadfile
+tests_common_test_mappedreadfile_SOURCES  = tests/common/mappedreadfile.cpp
+tests_common_test_mappedreadfile_LDADD    = $(common_LIBS)
+tests_common_test_mappedreadfile_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                      += tests/common/test_writefile
 tests_common_test_writefile_SOURCES  = tests/common/writefile.cpp
 tests_common_test_writefile_LDADD    = $(common_LIBS)
@@ -196,3 +201,8 @@ check_PROGRAMS                  += tests/common/test_maths
 tests_common_test_maths_SOURCES  = tests/common/maths.cpp
 tests_common_test_maths_LDADD    = $(common_LIBS)
 tests_common_test_maths_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                     += tests/common/test_parallel
+tests_common_test_parallel_SOURCES  = tests/common/parallel.cpp
+tests_common_test_parallel_LDADD    = $(common_LIBS)
+tests_common_test_parallel_CXXFLAGS = $(test_CXXFLAGS)
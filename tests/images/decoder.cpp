@@ -0,0 +1,100 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the generic image decoder interface.
+ */
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/images/dds.h"
+#include "src/images/s3tc.h"
+
+/** Create a BioWare DDS with DXT5 data and a full mip map chain. */
+static void createDDS(std::vector<byte> &dds, uint32 width, uint32 height) {
+	Common::MemoryWriteStreamDynamic stream(true);
+
+	stream.writeUint32LE(width);
+	stream.writeUint32LE(height);
+	stream.writeUint32LE(4);
+	stream.writeUint32LE(width * height);
+	stream.writeUint32LE(0);
+
+	uint32 seed = 1;
+	for (uint32 w = width, h = height; (w >= 1) && (h >= 1); w >>= 1, h >>= 1) {
+		const uint32 size = MAX<uint32>(w, 4) * MAX<uint32>(h, 4);
+
+		for (uint32 i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			stream.writeByte(seed >> 16);
+		}
+	}
+
+	dds.assign(stream.getData(), stream.getData() + stream.size());
+}
+
+GTEST_TEST(Decoder, decompressParallel) {
+	std::vector<byte> data;
+	createDDS(data, 512, 256);
+
+	Common::MemoryReadStream stream1(&data[0], data.size());
+	Images::DDS serial(stream1);
+
+	Images::Decoder::setThreadCount(4);
+
+	Common::MemoryReadStream stream2(&data[0], data.size());
+	Images::DDS parallel(stream2);
+
+	Images::Decoder::setThreadCount(1);
+
+	ASSERT_EQ(serial.getMipMapCount(), 9);
+	ASSERT_EQ(parallel.getMipMapCount(), serial.getMipMapCount());
+
+	EXPECT_EQ(parallel.getFormat(), Images::kPixelFormatR8G8B8A8);
+
+	for (size_t i = 0; i < serial.getMipMapCount(); i++) {
+		const Images::Decoder::MipMap &mipMap1 = serial.getMipMap(i);
+		const Images::Decoder::MipMap &mipMap2 = parallel.getMipMap(i);
+
+		ASSERT_EQ(mipMap1.width , mipMap2.width ) << "At mip map " << i;
+		ASSERT_EQ(mipMap1.height, mipMap2.height) << "At mip map " << i;
+		ASSERT_EQ(mipMap1.size  , mipMap2.size  ) << "At mip map " << i;
+
+		// Only compare the actual pixels, not the padding of tiny mip maps
+		const size_t size = mipMap1.width * mipMap1.height * 4;
+
+		EXPECT_EQ(std::memcmp(mipMap1.data.get(), mipMap2.data.get(), size), 0) << "At mip map " << i;
+	}
+
+	// Compare the top mip map against the stream-based reference decoder
+	std::vector<byte> reference(512 * 256 * 4);
+
+	Common::MemoryReadStream compressed(&data[20], 512 * 256);
+	Images::decompressDXT5(&reference[0], compressed, 512, 256, 512 * 4);
+
+	EXPECT_EQ(std::memcmp(&reference[0], parallel.getMipMap(0).data.get(), reference.size()), 0);
+}
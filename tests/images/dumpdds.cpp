@@ -0,0 +1,113 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our DDS image dumper.
+ */
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/images/dds.h"
+#include "src/images/dumpdds.h"
+
+/** Create a BioWare DDS with DXT1 data and a full mip map chain. */
+static void createBioWareDDS(std::vector<byte> &dds, uint32 width, uint32 height) {
+	Common::MemoryWriteStreamDynamic stream(true);
+
+	stream.writeUint32LE(width);
+	stream.writeUint32LE(height);
+	stream.writeUint32LE(3);
+	stream.writeUint32LE(width * height / 2);
+	stream.writeUint32LE(0);
+
+	uint32 seed = 1;
+	for (uint32 w = width, h = height; (w >= 1) && (h >= 1); w >>= 1, h >>= 1) {
+		const uint32 size = MAX<uint32>(w, 4) * MAX<uint32>(h, 4) / 2;
+
+		for (uint32 i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			stream.writeByte(seed >> 16);
+		}
+	}
+
+	dds.assign(stream.getData(), stream.getData() + stream.size());
+}
+
+GTEST_TEST(DumpDDS, compressed) {
+	std::vector<byte> data;
+	createBioWareDDS(data, 64, 32);
+
+	Common::MemoryReadStream bioWareStream(&data[0], data.size());
+	Images::DDS bioWare(bioWareStream, true);
+
+	ASSERT_EQ(bioWare.getFormat(), Images::kPixelFormatDXT1);
+	ASSERT_EQ(bioWare.getMipMapCount(), 6);
+
+	Common::MemoryWriteStreamDynamic written(true);
+	Images::dumpDDS(written, bioWare);
+
+	// Header and the unchanged DXT1 blocks of all mip maps
+	EXPECT_EQ(written.size(), 128 + data.size() - 20);
+	EXPECT_EQ(std::memcmp(written.getData() + 128, &data[20], data.size() - 20), 0);
+
+	Common::MemoryReadStream standardStream(written.getData(), written.size());
+	Images::DDS standard(standardStream, true);
+
+	ASSERT_EQ(standard.getFormat(), Images::kPixelFormatDXT1);
+	ASSERT_EQ(standard.getMipMapCount(), bioWare.getMipMapCount());
+
+	for (size_t i = 0; i < standard.getMipMapCount(); i++) {
+		const Images::Decoder::MipMap &mipMap1 = bioWare.getMipMap(i);
+		const Images::Decoder::MipMap &mipMap2 = standard.getMipMap(i);
+
+		ASSERT_EQ(mipMap1.width , mipMap2.width ) << "At mip map " << i;
+		ASSERT_EQ(mipMap1.height, mipMap2.height) << "At mip map " << i;
+		ASSERT_EQ(mipMap1.size  , mipMap2.size  ) << "At mip map " << i;
+
+		EXPECT_EQ(std::memcmp(mipMap1.data.get(), mipMap2.data.get(), mipMap1.size), 0) << "At mip map " << i;
+	}
+}
+
+GTEST_TEST(DumpDDS, uncompressed) {
+	std::vector<byte> data;
+	createBioWareDDS(data, 16, 8);
+
+	Common::MemoryReadStream bioWareStream(&data[0], data.size());
+	Images::DDS bioWare(bioWareStream);
+
+	ASSERT_EQ(bioWare.getFormat(), Images::kPixelFormatR8G8B8A8);
+
+	Common::MemoryWriteStreamDynamic written(true);
+	Images::dumpDDS(written, bioWare);
+
+	EXPECT_EQ(written.size(), 128 + (16 * 8 + 8 * 4 + 4 * 2 + 2 * 1) * 4);
+	EXPECT_EQ(std::memcmp(written.getData() + 128, bioWare.getMipMap(0).data.get(), 16 * 8 * 4), 0);
+
+	// RGBA pixel format
+	EXPECT_EQ(READ_LE_UINT32(written.getData() + 80), 0x41);
+	EXPECT_EQ(READ_LE_UINT32(written.getData() + 88), 32);
+}
@@ -0,0 +1,254 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our TGA image dumper.
+ */
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/memwritestream.h"
+
+#include "src/images/decoder.h"
+#include "src/images/dumptga.h"
+
+/** An image of one mip map per layer, holding the given pixel data. */
+class TestImage : public Images::Decoder {
+public:
+	TestImage(Images::PixelFormat format, int width, int height, uint32 bpp,
+	          const byte *data, size_t layerCount = 1) {
+
+		_format     = format;
+		_layerCount = layerCount;
+
+		const uint32 size = width * height * bpp;
+
+		for (size_t i = 0; i < layerCount; i++, data += size) {
+			_mipMaps.push_back(new MipMap);
+
+			MipMap &mipMap = *_mipMaps.back();
+
+			mipMap.width  = width;
+			mipMap.height = height;
+			mipMap.size   = size;
+
+			mipMap.data.reset(new byte[size]);
+			std::memcpy(mipMap.data.get(), data, size);
+		}
+	}
+};
+
+/** Check the TGA header and the BGRA pixels of a dumped image. */
+static void compareTGA(Common::MemoryWriteStreamDynamic &tga, int width, int height,
+                       const byte *pixels, size_t size) {
+
+	static const byte kHeader[] = {
+		0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+
+	ASSERT_EQ(tga.size(), 18 + size);
+
+	EXPECT_EQ(std::memcmp(tga.getData(), kHeader, sizeof(kHeader)), 0);
+
+	EXPECT_EQ(READ_LE_UINT16(tga.getData() + 12), width);
+	EXPECT_EQ(READ_LE_UINT16(tga.getData() + 14), height);
+
+	EXPECT_EQ(tga.getData()[16], 32);
+	EXPECT_EQ(tga.getData()[17], 0);
+
+	for (size_t i = 0; i < size; i++)
+		EXPECT_EQ(tga.getData()[18 + i], pixels[i]) << "At index " << i;
+}
+
+GTEST_TEST(DumpTGA, R8G8B8) {
+	static const byte kPixels[] = {
+		0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C
+	};
+	static const byte kTGA[] = {
+		0x03, 0x02, 0x01, 0xFF, 0x06, 0x05, 0x04, 0xFF, 0x09, 0x08, 0x07, 0xFF, 0x0C, 0x0B, 0x0A, 0xFF
+	};
+
+	const TestImage image(Images::kPixelFormatR8G8B8, 2, 2, 3, kPixels);
+
+	Common::MemoryWriteStreamDynamic tga(true);
+	Images::dumpTGA(tga, image);
+
+	compareTGA(tga, 2, 2, kTGA, sizeof(kTGA));
+}
+
+GTEST_TEST(DumpTGA, B8G8R8) {
+	static const byte kPixels[] = {
+		0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C
+	};
+	static const byte kTGA[] = {
+		0x01, 0x02, 0x03, 0xFF, 0x04, 0x05, 0x06, 0xFF, 0x07, 0x08, 0x09, 0xFF, 0x0A, 0x0B, 0x0C, 0xFF
+	};
+
+	const TestImage image(Images::kPixelFormatB8G8R8, 2, 2, 3, kPixels);
+
+	Common::MemoryWriteStreamDynamic tga(true);
+	Images::dumpTGA(tga, image);
+
+	compareTGA(tga, 2, 2, kTGA, sizeof(kTGA));
+}
+
+GTEST_TEST(DumpTGA, R8G8B8A8) {
+	static const byte kPixels[] = {
+		0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10
+	};
+	static const byte kTGA[] = {
+		0x03, 0x02, 0x01, 0x04, 0x07, 0x06, 0x05, 0x08, 0x0B, 0x0A, 0x09, 0x0C, 0x0F, 0x0E, 0x0D, 0x10
+	};
+
+	const TestImage image(Images::kPixelFormatR8G8B8A8, 2, 2, 4, kPixels);
+
+	Common::MemoryWriteStreamDynamic tga(true);
+	Images::dumpTGA(tga, image);
+
+	compareTGA(tga, 2, 2, kTGA, sizeof(kTGA));
+}
+
+GTEST_TEST(DumpTGA, B8G8R8A8) {
+	static const byte kPixels[] = {
+		0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10
+	};
+
+	const TestImage image(Images::kPixelFormatB8G8R8A8, 2, 2, 4, kPixels);
+
+	Common::MemoryWriteStreamDynamic tga(true);
+	Images::dumpTGA(tga, image);
+
+	compareTGA(tga, 2, 2, kPixels, sizeof(kPixels));
+}
+
+GTEST_TEST(DumpTGA, R5G6B5) {
+	static const byte kPixels[] = {
+		0x1F, 0x00, 0xE0, 0x07, 0x00, 0xF8, 0x34, 0x12
+	};
+	static const byte kTGA[] = {
+		0x1F, 0x00, 0x00, 0xFF, 0x00, 0x3F, 0x00, 0xFF, 0x00, 0x00, 0x1F, 0xFF, 0x14, 0x11, 0x02, 0xFF
+	};
+
+	const TestImage image(Images::kPixelFormatR5G6B5, 2, 2, 2, kPixels);
+
+	Common::MemoryWriteStreamDynamic tga(true);
+	Images::dumpTGA(tga, image);
+
+	compareTGA(tga, 2, 2, kTGA, sizeof(kTGA));
+}
+
+GTEST_TEST(DumpTGA, A1R5G5B5) {
+	static const byte kPixels[] = {
+		0x1F, 0x00, 0xE0, 0x83, 0x00, 0x7C, 0xFF, 0xFF
+	};
+	static const byte kTGA[] = {
+		0x1F, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x00, 0xFF, 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x1F, 0x1F, 0xFF
+	};
+
+	const TestImage image(Images::kPixelFormatA1R5G5B5, 2, 2, 2, kPixels);
+
+	Common::MemoryWriteStreamDynamic tga(true);
+	Images::dumpTGA(tga, image);
+
+	compareTGA(tga, 2, 2, kTGA, sizeof(kTGA));
+}
+
+GTEST_TEST(DumpTGA, Depth16) {
+	static const byte kPixels[] = {
+		0x00, 0x00, 0x80, 0x00, 0xFE, 0x7F, 0xFF, 0x7F
+	};
+	static const byte kTGA[] = {
+		0x00, 0x00, 0x00, 0xFF, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00
+	};
+
+	const TestImage image(Images::kPixelFormatDepth16, 2, 2, 2, kPixels);
+
+	Common::MemoryWriteStreamDynamic tga(true);
+	Images::dumpTGA(tga, image);
+
+	compareTGA(tga, 2, 2, kTGA, sizeof(kTGA));
+}
+
+GTEST_TEST(DumpTGA, flipped) {
+	static const byte kPixels[] = {
+		0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C
+	};
+	static const byte kTGA[] = {
+		0x09, 0x08, 0x07, 0xFF, 0x0C, 0x0B, 0x0A, 0xFF, 0x03, 0x02, 0x01, 0xFF, 0x06, 0x05, 0x04, 0xFF
+	};
+
+	TestImage image(Images::kPixelFormatR8G8B8, 2, 2, 3, kPixels);
+	image.flipVertically();
+
+	Common::MemoryWriteStreamDynamic tga(true);
+	Images::dumpTGA(tga, image);
+
+	compareTGA(tga, 2, 2, kTGA, sizeof(kTGA));
+}
+
+GTEST_TEST(DumpTGA, layers) {
+	// Two layers of 2x1 pixels, stacked on top of each other
+	static const byte kPixels[] = {
+		0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C
+	};
+	static const byte kTGA[] = {
+		0x03, 0x02, 0x01, 0xFF, 0x06, 0x05, 0x04, 0xFF, 0x09, 0x08, 0x07, 0xFF, 0x0C, 0x0B, 0x0A, 0xFF
+	};
+
+	const TestImage image(Images::kPixelFormatR8G8B8, 2, 1, 3, kPixels, 2);
+
+	Common::MemoryWriteStreamDynamic tga(true);
+	Images::dumpTGA(tga, image);
+
+	compareTGA(tga, 2, 2, kTGA, sizeof(kTGA));
+}
+
+GTEST_TEST(DumpTGA, large) {
+	// Big enough to be converted in several chunks of rows
+	static const int kWidth = 1024, kHeight = 100;
+
+	Common::ScopedArray<byte> pixels(new byte[kWidth * kHeight * 3]);
+	Common::ScopedArray<byte> expected(new byte[kWidth * kHeight * 4]);
+
+	uint32 seed = 1;
+	for (int i = 0; i < kWidth * kHeight; i++) {
+		for (int j = 0; j < 3; j++) {
+			seed = seed * 1103515245 + 12345;
+			pixels[i * 3 + j] = seed >> 16;
+		}
+
+		expected[i * 4 + 0] = pixels[i * 3 + 2];
+		expected[i * 4 + 1] = pixels[i * 3 + 1];
+		expected[i * 4 + 2] = pixels[i * 3 + 0];
+		expected[i * 4 + 3] = 0xFF;
+	}
+
+	const TestImage image(Images::kPixelFormatR8G8B8, kWidth, kHeight, 3, pixels.get());
+
+	Common::MemoryWriteStreamDynamic tga(true);
+	Images::dumpTGA(tga, image);
+
+	ASSERT_EQ(tga.size(), 18 + kWidth * kHeight * 4);
+	EXPECT_EQ(std::memcmp(tga.getData() + 18, expected.get(), kWidth * kHeight * 4), 0);
+}
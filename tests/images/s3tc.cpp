@@ -0,0 +1,114 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our S3TC DXTn decompression methods.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+
+#include "src/images/s3tc.h"
+
+typedef void (*DecompressStream)(byte *, Common::SeekableReadStream &, uint32, uint32, uint32);
+typedef void (*DecompressBuffer)(byte *, const byte *, size_t, uint32, uint32, uint32);
+
+static std::vector<byte> createData(size_t size, uint32 seed) {
+	std::vector<byte> data(size);
+
+	// Simple LCG, to have reproducible pseudo-random block data
+	for (size_t i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = seed >> 16;
+	}
+
+	return data;
+}
+
+static void compareDecoders(DecompressStream reference, DecompressBuffer fast, size_t blockSize,
+                            uint32 width, uint32 height) {
+
+	const size_t blocks = ((width + 3) / 4) * ((height + 3) / 4);
+	const std::vector<byte> data = createData(blocks * blockSize, width * 0x10000 + height);
+
+	const size_t size = std::max<size_t>(width * height * 4, 64);
+	std::vector<byte> expected(size, 0xAA), actual(size, 0xAA);
+
+	Common::MemoryReadStream stream(&data[0], data.size());
+	reference(&expected[0], stream, width, height, width * 4);
+
+	fast(&actual[0], &data[0], data.size(), width, height, width * 4);
+
+	for (size_t i = 0; i < size; i++)
+		EXPECT_EQ(actual[i], expected[i]) << "At " << width << "x" << height << ", index " << i;
+}
+
+static const uint32 kSizes[][2] = {
+	{ 1, 1 }, { 2, 2 }, { 4, 4 }, { 8, 4 }, { 4, 8 }, { 16, 16 }, { 64, 32 }
+};
+
+GTEST_TEST(S3TC, decompressDXT1) {
+	for (size_t i = 0; i < ARRAYSIZE(kSizes); i++)
+		compareDecoders(Images::decompressDXT1, Images::decompressDXT1, 8, kSizes[i][0], kSizes[i][1]);
+}
+
+GTEST_TEST(S3TC, decompressDXT3) {
+	for (size_t i = 0; i < ARRAYSIZE(kSizes); i++)
+		compareDecoders(Images::decompressDXT3, Images::decompressDXT3, 16, kSizes[i][0], kSizes[i][1]);
+}
+
+GTEST_TEST(S3TC, decompressDXT5) {
+	for (size_t i = 0; i < ARRAYSIZE(kSizes); i++)
+		compareDecoders(Images::decompressDXT5, Images::decompressDXT5, 16, kSizes[i][0], kSizes[i][1]);
+}
+
+GTEST_TEST(S3TC, decompressDXT1Colors) {
+	// Opaque red and blue, with the pixels walking through all 4 palette entries
+	static const byte kBlock[] = { 0x00, 0xF8, 0x1F, 0x00, 0x1B, 0x1B, 0x1B, 0x1B };
+
+	byte image[4 * 4 * 4];
+	Images::decompressDXT1(image, kBlock, sizeof(kBlock), 4, 4, 4 * 4);
+
+	static const byte kPixels[4][4] = {
+		{ 0xF8, 0x00, 0x00, 0xFF }, { 0x00, 0x00, 0xF8, 0xFF },
+		{ 0xA5, 0x00, 0x52, 0xFF }, { 0x52, 0x00, 0xA5, 0xFF }
+	};
+
+	// Pixel indices 3, 2, 1, 0 in every row
+	for (size_t y = 0; y < 4; y++) {
+		for (size_t x = 0; x < 4; x++) {
+			for (size_t c = 0; c < 4; c++)
+				EXPECT_EQ(image[(y * 4 + x) * 4 + c], kPixels[3 - x][c]) << y << ", " << x << ", " << c;
+		}
+	}
+}
+
+GTEST_TEST(S3TC, decompressShort) {
+	const std::vector<byte> data = createData(63, 1);
+
+	byte image[8 * 8 * 4];
+	EXPECT_THROW(Images::decompressDXT1(image, &data[0], 31, 8, 8, 8 * 4), Common::Exception);
+	EXPECT_THROW(Images::decompressDXT3(image, &data[0], 63, 8, 8, 8 * 4), Common::Exception);
+	EXPECT_THROW(Images::decompressDXT5(image, &data[0], 63, 8, 8, 8 * 4), Common::Exception);
+}
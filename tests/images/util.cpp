@@ -23,6 +23,7 @@
  */
 
 #include <cstring>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -479,3 +480,27 @@ GTEST_TEST(ImagesUtil, deSwizzleOffset) {
 	for (size_t i = 0; i < (kWidth * kHeight); i++)
 		EXPECT_EQ(buffer[i], kSwizzled[i]) << "At index " << i;
 }
+
+GTEST_TEST(ImagesUtil, deSwizzle) {
+	static const uint32 kSizes[][3] = {
+		{ 4, 4, 4 }, { 16, 16, 4 }, { 32, 8, 4 }, { 8, 32, 3 }, { 64, 1, 4 }, { 1, 64, 4 }, { 16, 24, 3 }, { 8, 48, 4 }
+	};
+
+	for (size_t s = 0; s < ARRAYSIZE(kSizes); s++) {
+		const uint32 width = kSizes[s][0], height = kSizes[s][1], bpp = kSizes[s][2];
+		const size_t size = width * height * bpp;
+
+		std::vector<byte> src(size), expected(size), actual(size);
+		for (size_t i = 0; i < size; i++)
+			src[i] = (i * 7) ^ (i >> 8);
+
+		for (uint32 y = 0, i = 0; y < height; y++)
+			for (uint32 x = 0; x < width; x++, i++)
+				std::memcpy(&expected[i * bpp], &src[Images::deSwizzleOffset(x, y, width, height) * bpp], bpp);
+
+		Images::deSwizzle(&actual[0], &src[0], width, height, bpp);
+
+		for (size_t i = 0; i < size; i++)
+			ASSERT_EQ(actual[i], expected[i]) << "At " << width << "x" << height << "x" << bpp << ", index " << i;
+	}
+}
@@ -0,0 +1,157 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our XML writer.
+ */
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "src/common/memwritestream.h"
+
+#include "src/xml/xmlwriter.h"
+
+static const char *kHeader = "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n";
+
+static Common::UString getWritten(Common::MemoryWriteStreamDynamic &stream) {
+	return Common::UString(reinterpret_cast<const char *>(stream.getData()), stream.size());
+}
+
+GTEST_TEST(XMLWriter, header) {
+	Common::MemoryWriteStreamDynamic stream(true);
+	XML::XMLWriter xml(stream);
+
+	EXPECT_STREQ(getWritten(stream).c_str(), kHeader);
+}
+
+GTEST_TEST(XMLWriter, tags) {
+	Common::MemoryWriteStreamDynamic stream(true);
+	XML::XMLWriter xml(stream);
+
+	xml.openTag("foo");
+	xml.breakLine();
+
+	xml.openTag("bar");
+	xml.addProperty("prop1", "foo");
+	xml.addProperty("prop2", "bar");
+	xml.closeTag();
+	xml.breakLine();
+
+	xml.openTag("node");
+	xml.setContents("blubb");
+	xml.closeTag();
+	xml.breakLine();
+
+	xml.openTag("outer");
+	xml.breakLine();
+	xml.openTag("inner");
+	xml.closeTag();
+	xml.breakLine();
+	xml.closeTag();
+	xml.breakLine();
+
+	xml.closeTag();
+	xml.flush();
+
+	const Common::UString expected = Common::UString(kHeader) +
+		"<foo>\n"
+		"  <bar prop1=\"foo\" prop2=\"bar\"/>\n"
+		"  <node>blubb</node>\n"
+		"  <outer>\n"
+		"    <inner/>\n"
+		"  </outer>\n"
+		"</foo>";
+
+	EXPECT_STREQ(getWritten(stream).c_str(), expected.c_str());
+}
+
+GTEST_TEST(XMLWriter, escape) {
+	Common::MemoryWriteStreamDynamic stream(true);
+	XML::XMLWriter xml(stream);
+
+	xml.openTag("foo");
+	xml.addProperty("prop", "\"a\" & 'b'");
+	xml.setContents("<foo>\r\nbar</foo>");
+	xml.closeTag();
+	xml.flush();
+
+	const Common::UString expected = Common::UString(kHeader) +
+		"<foo prop=\"&quot;a&quot; &amp; &apos;b&apos;\">&lt;foo&gt;&#13;\nbar&lt;/foo&gt;</foo>";
+
+	EXPECT_STREQ(getWritten(stream).c_str(), expected.c_str());
+}
+
+GTEST_TEST(XMLWriter, flushClosesTags) {
+	Common::MemoryWriteStreamDynamic stream(true);
+	XML::XMLWriter xml(stream);
+
+	xml.openTag("foo");
+	xml.openTag("bar");
+	xml.flush();
+
+	const Common::UString expected = Common::UString(kHeader) + "<foo><bar/></foo>";
+
+	EXPECT_STREQ(getWritten(stream).c_str(), expected.c_str());
+}
+
+GTEST_TEST(XMLWriter, binaryInline) {
+	Common::MemoryWriteStreamDynamic stream(true);
+	XML::XMLWriter xml(stream);
+
+	static const byte kData[] = { 'f', 'o', 'o', 'b', 'a' };
+
+	xml.openTag("data");
+	xml.setContents(kData, sizeof(kData));
+	xml.closeTag();
+	xml.flush();
+
+	const Common::UString expected = Common::UString(kHeader) + "<data>Zm9vYmE=</data>";
+
+	EXPECT_STREQ(getWritten(stream).c_str(), expected.c_str());
+}
+
+GTEST_TEST(XMLWriter, binaryLines) {
+	Common::MemoryWriteStreamDynamic stream(true);
+	XML::XMLWriter xml(stream);
+
+	byte data[49];
+	std::memset(data, 0, sizeof(data));
+
+	xml.openTag("foo");
+	xml.breakLine();
+	xml.openTag("data");
+	xml.setContents(data, sizeof(data));
+	xml.closeTag();
+	xml.breakLine();
+	xml.closeTag();
+	xml.flush();
+
+	const Common::UString expected = Common::UString(kHeader) +
+		"<foo>\n"
+		"  <data>\n"
+		"    AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA\n"
+		"    AA==\n"
+		"  </data>\n"
+		"</foo>";
+
+	EXPECT_STREQ(getWritten(stream).c_str(), expected.c_str());
+}